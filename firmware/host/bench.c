@@ -0,0 +1,331 @@
+// Host micro-benchmarks for the firmware hot paths.
+//
+// Usage: espclaude_bench [status.json] [iterations]
+//
+// Each case reports wall time per call and, for UI cases, the number of
+// widget invalidations per call (what would trigger redraws on the device).
+// The status is decoded both as JSON and as CBOR (from the .cbor file next to
+// the .json one, see ccu_stub.py --dump-cbor) to compare size and decode time.
+// The history store section encodes a synthetic week of 20 s samples and
+// reports its size per sample and decode rate, then reads the same week
+// back through the hourly rollup as the Trend tab's 7 day zoom does.
+// Run under `perf record` or `valgrind --tool=callgrind` for call-level detail.
+
+#include "bench_hooks.h"
+#include "http_client.h"
+#include "history_rollup.h"
+#include "history_store.h"
+#include "screen_dashboard.h"
+#include "status_binding.h"
+#include "ui.h"
+#include "bsp/esp-bsp.h"
+#include "esp_log.h"
+#include "lvgl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef HOST_DATA_DIR
+#define HOST_DATA_DIR "."
+#endif
+
+typedef void (*bench_fn_t)(void *ctx);
+
+typedef struct {
+    const char *body;
+    size_t      len;
+    bool        cbor;
+} body_ctx_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void run_case(const char *name, bench_fn_t fn, void *ctx, int iterations)
+{
+    // Warm up caches and any first-call allocations
+    for (int i = 0; i < iterations / 10 + 1; i++) {
+        fn(ctx);
+    }
+
+    uint32_t inval_before = lv_host_invalidation_count();
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; i++) {
+        fn(ctx);
+    }
+    uint64_t elapsed = now_ns() - start;
+    uint32_t inval = lv_host_invalidation_count() - inval_before;
+
+    printf("%-28s %10.1f ns/op  %8.2f invalidations/op\n", name,
+           (double)elapsed / iterations, (double)inval / iterations);
+}
+
+static char *read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc(size + 1);
+    if (buf && fread(buf, 1, size, f) == (size_t)size) {
+        buf[size] = '\0';
+        *len = (size_t)size;
+    } else {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    return buf;
+}
+
+// Size of the JSON as a server would send it: whitespace outside strings removed
+static size_t compact_json_len(const char *json, size_t len)
+{
+    size_t n = 0;
+    bool in_string = false;
+    for (size_t i = 0; i < len; i++) {
+        char c = json[i];
+        if (in_string) {
+            if (c == '\\') {
+                n++;
+                i++;
+            } else if (c == '"') {
+                in_string = false;
+            }
+        } else if (c == '"') {
+            in_string = true;
+        } else if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            continue;
+        }
+        n++;
+    }
+    return n;
+}
+
+static void case_parse(void *ctx)
+{
+    body_ctx_t *b = ctx;
+    bench_parse_status(b->body, b->len, b->cbor);
+}
+
+static void case_short_model_name(void *ctx)
+{
+    (void)ctx;
+    static const char *models[] = {
+        "claude-opus-4-6", "claude-sonnet-4-5-20250929", "claude-haiku-4-5-20251001", "gpt-x",
+    };
+    char buf[8];
+    for (size_t i = 0; i < sizeof(models) / sizeof(models[0]); i++) {
+        bench_short_model_name(models[i], buf, sizeof(buf));
+    }
+}
+
+static void case_dashboard_update(void *ctx)
+{
+    (void)ctx;
+    static status_data_t status;
+    static uint32_t generation;
+    http_client_read_status(&status, &generation);
+    screen_dashboard_update(&status, STATUS_FIELD_ALL);
+}
+
+static void case_status_diff(void *ctx)
+{
+    (void)ctx;
+    static status_data_t a, b;
+    static uint32_t ga, gb;
+    http_client_read_status(&a, &ga);
+    http_client_read_status(&b, &gb);
+    volatile uint32_t changed = status_diff(&a, &b);
+    (void)changed;
+}
+
+static void case_ui_update(void *ctx)
+{
+    (void)ctx;
+    ui_update();
+}
+
+// Deterministic xorshift so runs are comparable
+static uint32_t s_rng = 2463534242u;
+
+static float rng_unit(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return (s_rng & 0xffffff) / (float)0x1000000;
+}
+
+static void count_cb(void *ctx, const history_sample_t *s)
+{
+    (void)s;
+    (*(size_t *)ctx)++;
+}
+
+static void rollup_cb(void *ctx, const history_sample_t *s)
+{
+    history_rollup_add(ctx, s);
+}
+
+// A week of 20 s polls: session usage ramps and resets every 5 h, weekly
+// usage creeps up, burn rate wanders
+static void bench_history_store(void)
+{
+    const uint32_t start = 1760000000u, spacing = 20, count = 7 * 24 * 3600 / 20;
+    history_store_t st;
+    if (history_store_init(&st, 512) != ESP_OK) {
+        printf("history store: no memory\n");
+        return;
+    }
+
+    float session = 0, weekly = 10, burn = 1.5f, cost = 0;
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t t = start + i * spacing;
+        if ((t - start) % (5 * 3600) < spacing) {
+            session = 0;
+            cost = 0;
+        }
+        burn += (rng_unit() - 0.5f) * 0.1f;
+        if (burn < 0) burn = 0;
+        session += rng_unit() * 0.05f;
+        weekly += rng_unit() * 0.002f;
+        cost += burn * spacing / 3600.0f;
+        history_sample_t s = {
+            .time = t + (rng_unit() < 0.05f ? 1 : 0),
+            .session = session,
+            .weekly_all = weekly,
+            .weekly_sonnet = weekly * 0.6f,
+            .burn_cost_per_hour = burn,
+            .session_cost_usd = cost,
+        };
+        history_store_append(&st, &s);
+    }
+    uint64_t append_ns = now_ns() - t0;
+
+    history_store_stats_t stats;
+    history_store_get_stats(&st, &stats);
+    printf("history store: %u samples in %u blocks, %.2f bytes/sample (raw %zu), %.1f ns/append\n",
+           (unsigned)stats.samples, (unsigned)stats.blocks, (double)stats.bytes / stats.samples,
+           sizeof(history_sample_t), (double)append_ns / count);
+
+    const uint32_t end = start + count * spacing;
+    size_t n = 0;
+    t0 = now_ns();
+    history_store_query(&st, 0, UINT32_MAX, count_cb, &n);
+    uint64_t full_ns = now_ns() - t0;
+    printf("  full decode                %10.1f ns/sample (%zu samples, %.0f k samples/s)\n",
+           (double)full_ns / n, n, n * 1e6 / full_ns);
+
+    n = 0;
+    t0 = now_ns();
+    history_store_query(&st, end - 3600, end, count_cb, &n);
+    printf("  last hour query            %10.1f us (%zu samples)\n", (now_ns() - t0) / 1000.0, n);
+
+    float max = 0;
+    t0 = now_ns();
+    history_store_max(&st, start + 1800, end - 1800, HISTORY_COL_SESSION, &max);
+    printf("  max session over the week  %10.1f us (%.2f%%)\n", (now_ns() - t0) / 1000.0, max);
+
+    // Same week through the rollups: 168 hourly buckets instead of every sample
+    static const uint32_t capacity[HISTORY_RESOLUTIONS] = {1440, 336, 120};
+    history_rollup_t r;
+    if (history_rollup_init(&r, capacity) != ESP_OK) {
+        history_store_free(&st);
+        return;
+    }
+    n = 0;
+    t0 = now_ns();
+    history_store_query(&st, 0, UINT32_MAX, count_cb, &n);
+    uint64_t scan_ns = now_ns() - t0;
+    t0 = now_ns();
+    history_store_query(&st, 0, UINT32_MAX, rollup_cb, &r);
+    uint64_t fold_ns = now_ns() - t0 - scan_ns;
+    printf("  rollup add (3 tiers)       %10.1f ns/sample\n", (double)fold_ns / n);
+
+    static history_bucket_t week[7 * 24];
+    t0 = now_ns();
+    const int reads = 1000;
+    for (int i = 0; i < reads; i++) {
+        history_rollup_read(&r, HISTORY_RES_HOUR, end - 7 * 24 * 3600, week, 7 * 24);
+    }
+    uint64_t read_ns = (now_ns() - t0) / reads;
+    float week_max = 0;
+    for (size_t i = 0; i < 7 * 24; i++) {
+        if (week[i].count && week[i].session.max > week_max) {
+            week_max = week[i].session.max;
+        }
+    }
+    printf("  7d chart: hourly rollup    %10.1f us (168 buckets, max %.2f%%) vs %.1f us scanning samples\n",
+           read_ns / 1000.0, week_max, scan_ns / 1000.0);
+
+    history_rollup_free(&r);
+    history_store_free(&st);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : HOST_DATA_DIR "/status_sample.json";
+    int iterations = argc > 2 ? atoi(argv[2]) : 100000;
+    if (iterations <= 0) {
+        iterations = 1;
+    }
+
+    body_ctx_t body = {0};
+    char *json = read_file(path, &body.len);
+    if (!json) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    body.body = json;
+
+    // status_sample.json -> status_sample.cbor
+    char cbor_path[512];
+    snprintf(cbor_path, sizeof(cbor_path), "%s", path);
+    char *ext = strrchr(cbor_path, '.');
+    if (ext && strcmp(ext, ".json") == 0 && (size_t)(ext - cbor_path) + 6 <= sizeof(cbor_path)) {
+        strcpy(ext, ".cbor");
+    }
+    body_ctx_t cbor = {.cbor = true};
+    char *cbor_data = strcmp(cbor_path, path) != 0 ? read_file(cbor_path, &cbor.len) : NULL;
+    cbor.body = cbor_data;
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    bsp_display_start();
+    bsp_display_lock(0);
+    ui_init();
+
+    // Prime the shared status so UI cases run against real data
+    bench_parse_status(body.body, body.len, false);
+
+    printf("payload: %s (%zu bytes, %zu compact), %d iterations\n", path, body.len,
+           compact_json_len(body.body, body.len), iterations);
+    if (cbor_data) {
+        printf("payload: %s (%zu bytes, %.0f%% of compact JSON)\n", cbor_path, cbor.len,
+               100.0 * cbor.len / compact_json_len(body.body, body.len));
+    }
+    run_case("parse + store status", case_parse, &body, iterations);
+    if (cbor_data) {
+        run_case("parse + store status (CBOR)", case_parse, &cbor, iterations);
+    }
+    run_case("short_model_name x4", case_short_model_name, NULL, iterations);
+    run_case("status_diff", case_status_diff, NULL, iterations);
+    run_case("screen_dashboard_update (all)", case_dashboard_update, NULL, iterations);
+    run_case("ui_update (no new data)", case_ui_update, NULL, iterations);
+    bench_history_store();
+
+    bsp_display_unlock();
+    free(json);
+    free(cbor_data);
+    return 0;
+}
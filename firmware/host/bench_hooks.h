@@ -0,0 +1,15 @@
+#pragma once
+
+// Entry points into file-static firmware functions, exposed only to the
+// host benchmark by compiling the firmware sources into wrapper units.
+
+#include <stddef.h>
+
+#include <stdbool.h>
+
+// Streams a complete response body (JSON, or CBOR if cbor is set) through the
+// status parser and stores it.
+void bench_parse_status(const char *body, size_t len, bool cbor);
+
+// Wraps short_model_name() from ui/screen_dashboard.c.
+void bench_short_model_name(const char *model, char *buf, size_t buf_len);
@@ -0,0 +1,24 @@
+// Compiles http_client.c into the benchmark so its static helpers are reachable.
+
+#include "http_client.c"
+#include "bench_hooks.h"
+
+// Mirrors the fetch path: body arrives in HTTP client buffer-sized chunks
+void bench_parse_status(const char *body, size_t len, bool cbor)
+{
+    endpoint_t *ep = &s_endpoints[0];
+    if (!s_publish_mutex) {
+        endpoints_init();
+    }
+    status_parser_init(&ep->parser, &ep->parsed);
+    if (cbor) {
+        status_parser_use_cbor(&ep->parser);
+    }
+    for (size_t off = 0; off < len; off += 512) {
+        size_t n = len - off < 512 ? len - off : 512;
+        status_parser_feed(&ep->parser, body + off, n);
+    }
+    if (status_parser_finish(&ep->parser)) {
+        store_status(ep, &ep->parsed);
+    }
+}
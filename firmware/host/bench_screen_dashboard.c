@@ -0,0 +1,9 @@
+// Compiles ui/screen_dashboard.c into the benchmark so short_model_name() is reachable.
+
+#include "ui/screen_dashboard.c"
+#include "bench_hooks.h"
+
+void bench_short_model_name(const char *model, char *buf, size_t buf_len)
+{
+    short_model_name(model, buf, buf_len);
+}
@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""Local stand-in for the CCU API, for exercising the host build.
+
+Serves data/status_sample.json as GET /api/status (HTTP/1.1 keep-alive, with
+ETag / If-None-Match, CBOR when the client accepts application/cbor, gzip when
+it accepts that) and pushes
+it as Server-Sent Events on GET /api/events. Every --interval seconds the
+session utilisation ticks up a little, so both endpoints see new data;
+data_age_seconds and server_time say how long ago that was, as CCU's do.
+
+    python3 firmware/host/ccu_stub.py --port 19840 --interval 5
+    python3 firmware/host/ccu_stub.py --drop-after 3    # break streams to test fallback
+    python3 firmware/host/ccu_stub.py --dump-cbor firmware/host/data/status_sample.cbor
+"""
+
+import argparse
+import copy
+import gzip
+import hashlib
+import json
+import os
+import struct
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+SAMPLE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "data", "status_sample.json")
+
+
+def cbor_head(major, arg):
+    if arg < 24:
+        return bytes([major << 5 | arg])
+    for info, fmt in ((24, ">B"), (25, ">H"), (26, ">I"), (27, ">Q")):
+        if arg < 1 << (8 * struct.calcsize(fmt)):
+            return bytes([major << 5 | info]) + struct.pack(fmt, arg)
+    raise ValueError("integer too large for CBOR")
+
+
+def cbor_encode(value):
+    """Minimal CBOR (RFC 8949) encoder for JSON-shaped data. Floats use the
+    shortest of half/single/double that holds them exactly."""
+    if value is None:
+        return b"\xf6"
+    if value is True:
+        return b"\xf5"
+    if value is False:
+        return b"\xf4"
+    if isinstance(value, int):
+        return cbor_head(0, value) if value >= 0 else cbor_head(1, -1 - value)
+    if isinstance(value, float):
+        for info, fmt in ((25, ">e"), (26, ">f")):
+            try:
+                packed = struct.pack(fmt, value)
+            except OverflowError:
+                continue
+            if struct.unpack(fmt, packed)[0] == value:
+                return bytes([0xE0 | info]) + packed
+        return b"\xfb" + struct.pack(">d", value)
+    if isinstance(value, str):
+        data = value.encode()
+        return cbor_head(3, len(data)) + data
+    if isinstance(value, list):
+        return cbor_head(4, len(value)) + b"".join(cbor_encode(v) for v in value)
+    if isinstance(value, dict):
+        return cbor_head(5, len(value)) + b"".join(
+            cbor_encode(k) + cbor_encode(v) for k, v in value.items())
+    raise TypeError("cannot encode %r" % type(value))
+
+
+class Status:
+    """The current status document, bumped on a timer."""
+
+    def __init__(self, interval):
+        with open(SAMPLE) as f:
+            self._base = json.load(f)
+        self._interval = interval
+        self._start = time.monotonic()
+
+    def version(self):
+        return int((time.monotonic() - self._start) // self._interval)
+
+    def document(self, version, live=True):
+        doc = copy.deepcopy(self._base)
+        session = doc.get("session", {})
+        if "utilisation_pct" in session:
+            session["utilisation_pct"] = round(session["utilisation_pct"] + 0.5 * version, 1)
+        if live:
+            refreshed = self._start + version * self._interval
+            doc["data_age_seconds"] = max(0, int(time.monotonic() - refreshed))
+            doc["server_time"] = time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime())
+        return doc
+
+    def body(self, version, cbor=False, live=True):
+        doc = self.document(version, live)
+        return cbor_encode(doc) if cbor else json.dumps(doc, separators=(",", ":")).encode()
+
+    def etag(self, version, cbor, gzipped):
+        # Of the data, not the body: the age fields change on every request
+        digest = hashlib.sha1(self.body(version, cbor, live=False)).hexdigest()[:16]
+        return '"%s%s"' % (digest, "-gz" if gzipped else "")
+
+    def wait_change(self, version, timeout):
+        deadline = time.monotonic() + timeout
+        while self.version() == version and time.monotonic() < deadline:
+            time.sleep(0.05)
+        return self.version()
+
+
+def make_handler(status, args):
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, fmt, *a):
+            if not args.quiet:
+                super().log_message(fmt, *a)
+
+        def do_GET(self):
+            path = self.path.split("?")[0]
+            if path == "/api/status":
+                self.send_status()
+            elif path == "/api/events":
+                self.send_events()
+            else:
+                self.send_error(404)
+
+        def send_status(self):
+            cbor = not args.no_cbor and "application/cbor" in self.headers.get("Accept", "")
+            version = status.version()
+            body = status.body(version, cbor)
+            gzipped = not args.no_gzip and "gzip" in self.headers.get("Accept-Encoding", "")
+            if gzipped:
+                body = gzip.compress(body, mtime=0)
+            etag = status.etag(version, cbor, gzipped)
+            if self.headers.get("If-None-Match") == etag:
+                self.send_response(304)
+                self.send_header("ETag", etag)
+                self.end_headers()
+                return
+            self.send_response(200)
+            self.send_header("Content-Type", "application/cbor" if cbor else "application/json")
+            self.send_header("Vary", "Accept, Accept-Encoding")
+            if gzipped:
+                self.send_header("Content-Encoding", "gzip")
+            self.send_header("Content-Length", str(len(body)))
+            self.send_header("ETag", etag)
+            self.end_headers()
+            self.wfile.write(body)
+
+        def send_events(self):
+            self.send_response(200)
+            self.send_header("Content-Type", "text/event-stream")
+            self.send_header("Cache-Control", "no-cache")
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            sent = 0
+            version = status.version()
+            try:
+                while True:
+                    body = status.body(version)
+                    self.write_chunk(b"event: status\ndata: " + body + b"\n\n")
+                    sent += 1
+                    if args.drop_after and sent >= args.drop_after:
+                        break
+                    # Keep-alive comments while nothing changes
+                    while True:
+                        new = status.wait_change(version, args.keepalive)
+                        if new != version:
+                            version = new
+                            break
+                        self.write_chunk(b": keep-alive\n\n")
+                self.write_chunk(b"")
+            except (BrokenPipeError, ConnectionResetError):
+                pass
+            self.close_connection = True
+
+        def write_chunk(self, data):
+            self.wfile.write(b"%x\r\n%s\r\n" % (len(data), data))
+            self.wfile.flush()
+
+    return Handler
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--port", type=int, default=19840)
+    ap.add_argument("--bind", default="127.0.0.1")
+    ap.add_argument("--interval", type=float, default=5, help="seconds between status changes")
+    ap.add_argument("--keepalive", type=float, default=15, help="seconds between SSE keep-alive comments")
+    ap.add_argument("--drop-after", type=int, default=0, help="close each event stream after N events")
+    ap.add_argument("--no-cbor", action="store_true", help="always answer in JSON")
+    ap.add_argument("--no-gzip", action="store_true", help="never compress responses")
+    ap.add_argument("--dump-cbor", metavar="PATH", help="write the sample as CBOR and exit")
+    ap.add_argument("--quiet", action="store_true")
+    args = ap.parse_args()
+
+    if args.dump_cbor:
+        with open(SAMPLE) as f, open(args.dump_cbor, "wb") as out:
+            out.write(cbor_encode(json.load(f)))
+        return
+
+    server = ThreadingHTTPServer((args.bind, args.port), make_handler(Status(args.interval), args))
+    server.daemon_threads = True
+    print("CCU stub on http://%s:%d" % (args.bind, args.port), flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
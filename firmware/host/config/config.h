@@ -0,0 +1,5 @@
+#pragma once
+
+// Fallback used by the host build when firmware/main/config.h has not been
+// created yet. The firmware's own config.h, when present, takes precedence.
+#include "../../main/config.h.example"
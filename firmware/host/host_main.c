@@ -0,0 +1,98 @@
+// Host entry point: runs the firmware's HTTP engine and UI timer headlessly,
+// mirroring app_main() minus NVS, SNTP and the real display. Set
+// ESPCLAUDE_FLASH to a file to keep the history partition across runs, and
+// ESPCLAUDE_NVS to keep the cached status.
+//
+// Usage: espclaude_host [seconds]   (0 or omitted = run until interrupted)
+
+#include "config.h"
+#include "boot_timeline.h"
+#include "http_client.h"
+#include "history.h"
+#include "status_cache.h"
+#include "status_server.h"
+#include "wifi.h"
+#include "ui.h"
+#include "bsp/esp-bsp.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *TAG = "espclaude_host";
+
+static lv_timer_t *s_ui_timer;
+
+// As on the device: no display lock until the display is started
+static atomic_bool s_display_started;
+
+static void ui_update_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    ui_update();
+}
+
+static void status_arrived(void)
+{
+    if (!atomic_load(&s_display_started)) {
+        return;
+    }
+    bsp_display_lock(0);
+    if (s_ui_timer) {
+        lv_timer_ready(s_ui_timer);
+    }
+    bsp_display_unlock();
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t run_ms = argc > 1 ? (uint32_t)atoi(argv[1]) * 1000u : 0;
+
+    history_init();
+    status_data_t cached;
+    if (status_cache_load(&cached) == ESP_OK) {
+        http_client_restore_status(&cached);
+    }
+
+    wifi_init_sta();
+    http_client_on_status(status_arrived);
+    http_client_start();
+    status_server_start();
+
+    bsp_display_start();
+    atomic_store(&s_display_started, true);
+    bsp_display_backlight_on();
+    boot_timeline_mark(BOOT_DISPLAY_UP);
+
+    bsp_display_lock(0);
+    ui_init();
+    s_ui_timer = lv_timer_create(ui_update_timer_cb, UI_COUNTDOWN_MS, NULL);
+    // A status may have landed while the UI was being built
+    lv_timer_ready(s_ui_timer);
+    bsp_display_unlock();
+
+    ESP_LOGI(TAG, "polling %s on %u server(s)", API_STATUS_PATH,
+             (unsigned)http_client_endpoint_count());
+
+    uint32_t start = lv_tick_get();
+    while (run_ms == 0 || lv_tick_elaps(start) < run_ms) {
+        bsp_display_lock(0);
+        uint32_t next = lv_timer_handler();
+        bsp_display_unlock();
+        vTaskDelay(pdMS_TO_TICKS(next));
+    }
+
+    status_data_t status = {0};
+    uint32_t generation = 0;
+    http_client_read_status(&status, &generation);
+    history_store_stats_t history;
+    history_get_store_stats(&history);
+    ESP_LOGI(TAG, "done: valid=%d session=%.0f%% generation=%u history=%u invalidations=%u",
+             status.valid, status.session.utilisation, (unsigned)generation,
+             (unsigned)history.samples, (unsigned)lv_host_invalidation_count());
+    return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// Host shim for the ESP32-S3 Box 3 BSP display helpers.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+lv_display_t *bsp_display_start(void);
+esp_err_t bsp_display_backlight_on(void);
+esp_err_t bsp_display_backlight_off(void);
+
+// Recursive lock guarding LVGL calls. timeout_ms = 0 waits forever.
+bool bsp_display_lock(uint32_t timeout_ms);
+void bsp_display_unlock(void);
+
+esp_err_t bsp_display_enter_sleep(void);
+esp_err_t bsp_display_exit_sleep(void);
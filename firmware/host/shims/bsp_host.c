@@ -0,0 +1,57 @@
+// Host implementation of the BSP display shim: no panel, just the LVGL lock.
+
+#include "bsp/esp-bsp.h"
+#include "esp_log.h"
+
+#include <pthread.h>
+
+static const char *TAG = "bsp_shim";
+
+static pthread_mutex_t s_lvgl_mutex;
+static bool s_started = false;
+
+lv_display_t *bsp_display_start(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_lvgl_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    s_started = true;
+
+    lv_init();
+    return NULL;
+}
+
+esp_err_t bsp_display_backlight_on(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_backlight_off(void)
+{
+    return ESP_OK;
+}
+
+bool bsp_display_lock(uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    return s_started && pthread_mutex_lock(&s_lvgl_mutex) == 0;
+}
+
+void bsp_display_unlock(void)
+{
+    pthread_mutex_unlock(&s_lvgl_mutex);
+}
+
+esp_err_t bsp_display_enter_sleep(void)
+{
+    ESP_LOGI(TAG, "display sleep");
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_exit_sleep(void)
+{
+    ESP_LOGI(TAG, "display wake");
+    return ESP_OK;
+}
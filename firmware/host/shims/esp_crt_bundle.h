@@ -0,0 +1,8 @@
+#pragma once
+
+// Host shim for ESP-IDF esp_crt_bundle.h. Attaching the bundle makes the
+// HTTP client shim verify servers against the system CA store.
+
+#include "esp_err.h"
+
+esp_err_t esp_crt_bundle_attach(void *conf);
@@ -0,0 +1,18 @@
+#pragma once
+
+// Host shim for ESP-IDF esp_heap_caps.h: capabilities are accepted and ignored.
+
+#include <stddef.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+void *heap_caps_malloc(size_t size, unsigned int caps);
+void *heap_caps_calloc(size_t n, size_t size, unsigned int caps);
+void  heap_caps_free(void *ptr);
+
+// Free heap figures, all capabilities alike (see esp_system.h)
+size_t heap_caps_get_free_size(unsigned int caps);
+size_t heap_caps_get_largest_free_block(unsigned int caps);
@@ -0,0 +1,144 @@
+// Host implementations of esp_err / esp_log / esp_timer / esp_random / heap_caps / esp_system.
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_http_client.h"
+#include "esp_random.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static esp_log_level_t s_log_level = ESP_LOG_INFO;
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                        return "ESP_OK";
+    case ESP_FAIL:                      return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:                return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:           return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:         return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:          return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:             return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:         return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:               return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE:      return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC:           return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_INVALID_VERSION:       return "ESP_ERR_INVALID_VERSION";
+    case ESP_ERR_HTTP_MAX_REDIRECT:     return "ESP_ERR_HTTP_MAX_REDIRECT";
+    case ESP_ERR_HTTP_CONNECT:          return "ESP_ERR_HTTP_CONNECT";
+    case ESP_ERR_HTTP_WRITE_DATA:       return "ESP_ERR_HTTP_WRITE_DATA";
+    case ESP_ERR_HTTP_FETCH_HEADER:     return "ESP_ERR_HTTP_FETCH_HEADER";
+    case ESP_ERR_HTTP_INVALID_TRANSPORT: return "ESP_ERR_HTTP_INVALID_TRANSPORT";
+    case ESP_ERR_HTTP_CONNECTING:       return "ESP_ERR_HTTP_CONNECTING";
+    case ESP_ERR_HTTP_EAGAIN:           return "ESP_ERR_HTTP_EAGAIN";
+    case ESP_ERR_HTTP_CONNECTION_CLOSED: return "ESP_ERR_HTTP_CONNECTION_CLOSED";
+    default:                            return "UNKNOWN ERROR";
+    }
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    if (strcmp(tag, "*") == 0) {
+        s_log_level = level;
+    }
+}
+
+int64_t esp_timer_get_time(void)
+{
+    static int64_t s_boot_us = 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (s_boot_us == 0) {
+        s_boot_us = now;
+    }
+    return now - s_boot_us;
+}
+
+uint32_t esp_random(void)
+{
+    uint32_t r;
+    if (getentropy(&r, sizeof(r)) != 0) {
+        r = (uint32_t)random();
+    }
+    return r;
+}
+
+void *heap_caps_malloc(size_t size, unsigned int caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, unsigned int caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+// Free bytes the allocator holds; the process can always grow past them
+static uint32_t heap_free(void)
+{
+    struct mallinfo2 mi = mallinfo2();
+    return (uint32_t)mi.fordblks;
+}
+
+size_t heap_caps_get_free_size(unsigned int caps)
+{
+    (void)caps;
+    return heap_free();
+}
+
+size_t heap_caps_get_largest_free_block(unsigned int caps)
+{
+    (void)caps;
+    return heap_free();
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return heap_free();
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    static uint32_t s_min = UINT32_MAX;
+    uint32_t now = heap_free();
+    if (now < s_min) {
+        s_min = now;
+    }
+    return s_min;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return xTaskGetTickCount();
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    (void)tag;
+    if (level > s_log_level) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+}
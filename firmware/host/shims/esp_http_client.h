@@ -0,0 +1,113 @@
+#pragma once
+
+// Host shim for ESP-IDF esp_http_client.h over POSIX sockets.
+// Implements the HTTP/1.1 subset the firmware uses: GET/POST, custom headers,
+// Content-Length and chunked bodies, and connection reuse across perform()
+// calls on the same handle (as the real client does when the server keeps
+// the connection alive). https:// is handled by OpenSSL, including TLS
+// session resumption when save_client_session is set.
+//
+// With is_async set, perform(), open() and fetch_headers() never block for
+// longer than timeout_ms waiting on the network: they return
+// ESP_ERR_HTTP_EAGAIN (-ESP_ERR_HTTP_EAGAIN for fetch_headers) and pick up
+// where they left off on the next call, connect and TLS handshake included.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#define ESP_ERR_HTTP_BASE               0x7000
+#define ESP_ERR_HTTP_MAX_REDIRECT       (ESP_ERR_HTTP_BASE + 1)
+#define ESP_ERR_HTTP_CONNECT            (ESP_ERR_HTTP_BASE + 2)
+#define ESP_ERR_HTTP_WRITE_DATA         (ESP_ERR_HTTP_BASE + 3)
+#define ESP_ERR_HTTP_FETCH_HEADER       (ESP_ERR_HTTP_BASE + 4)
+#define ESP_ERR_HTTP_INVALID_TRANSPORT  (ESP_ERR_HTTP_BASE + 5)
+#define ESP_ERR_HTTP_CONNECTING         (ESP_ERR_HTTP_BASE + 6)
+#define ESP_ERR_HTTP_EAGAIN             (ESP_ERR_HTTP_BASE + 7)
+#define ESP_ERR_HTTP_CONNECTION_CLOSED  (ESP_ERR_HTTP_BASE + 8)
+
+typedef struct esp_http_client *esp_http_client_handle_t;
+
+typedef enum {
+    HTTP_EVENT_ERROR = 0,
+    HTTP_EVENT_ON_CONNECTED,
+    HTTP_EVENT_HEADERS_SENT,
+    HTTP_EVENT_HEADER_SENT = HTTP_EVENT_HEADERS_SENT,
+    HTTP_EVENT_ON_HEADER,
+    HTTP_EVENT_ON_DATA,
+    HTTP_EVENT_ON_FINISH,
+    HTTP_EVENT_DISCONNECTED,
+    HTTP_EVENT_REDIRECT,
+} esp_http_client_event_id_t;
+
+typedef struct esp_http_client_event {
+    esp_http_client_event_id_t event_id;
+    esp_http_client_handle_t   client;
+    void                      *data;
+    int                        data_len;
+    void                      *user_data;
+    char                      *header_key;
+    char                      *header_value;
+} esp_http_client_event_t;
+
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t *evt);
+
+typedef enum {
+    HTTP_METHOD_GET = 0,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_PUT,
+    HTTP_METHOD_PATCH,
+    HTTP_METHOD_DELETE,
+    HTTP_METHOD_HEAD,
+} esp_http_client_method_t;
+
+typedef struct {
+    const char              *url;
+    const char              *host;
+    int                      port;
+    const char              *path;
+    const char              *cert_pem;
+    esp_err_t              (*crt_bundle_attach)(void *conf);
+    const char              *common_name;
+    bool                     skip_cert_common_name_check;
+    esp_http_client_method_t method;
+    int                      timeout_ms;
+    bool                     disable_auto_redirect;
+    http_event_handle_cb     event_handler;
+    int                      buffer_size;
+    int                      buffer_size_tx;
+    void                    *user_data;
+    bool                     is_async;
+    bool                     keep_alive_enable;
+    int                      keep_alive_idle;
+    int                      keep_alive_interval;
+    int                      keep_alive_count;
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    bool                     save_client_session;
+#endif
+} esp_http_client_config_t;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url);
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method);
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value);
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char *key);
+esp_err_t esp_http_client_set_timeout_ms(esp_http_client_handle_t client, int timeout_ms);
+
+// Request: connect (or reuse), send, read the whole response, delivering
+// headers and body chunks through the event handler. Blocking unless is_async.
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client);
+
+// Streaming API: open + fetch_headers + read, for long-lived responses.
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len);
+int64_t   esp_http_client_fetch_headers(esp_http_client_handle_t client);
+int       esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len);
+esp_err_t esp_http_client_close(esp_http_client_handle_t client);
+
+int     esp_http_client_get_status_code(esp_http_client_handle_t client);
+int64_t esp_http_client_get_content_length(esp_http_client_handle_t client);
+bool    esp_http_client_is_chunked_response(esp_http_client_handle_t client);
+bool    esp_http_client_is_complete_data_received(esp_http_client_handle_t client);
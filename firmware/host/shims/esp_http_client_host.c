@@ -0,0 +1,1026 @@
+// POSIX-socket implementation of the esp_http_client shim, with OpenSSL for https.
+
+#include "esp_http_client.h"
+#include "esp_crt_bundle.h"
+#include "esp_log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+
+static const char *TAG = "http_client_shim";
+
+#define MAX_HEADERS      16
+#define DEFAULT_BUF_SIZE 512
+#define RX_CAP           2048
+
+typedef struct {
+    char *key;
+    char *value;
+} header_t;
+
+// Where an is_async request is between calls
+typedef enum {
+    ASYNC_IDLE,
+    ASYNC_CONNECTING,
+    ASYNC_TLS,
+    ASYNC_SEND,
+    ASYNC_HEADERS,
+    ASYNC_BODY,
+} async_state_t;
+
+struct esp_http_client {
+    http_event_handle_cb     event_handler;
+    void                    *user_data;
+    int                      timeout_ms;
+    int                      buffer_size;
+    esp_http_client_method_t method;
+    bool                     is_async;
+    async_state_t            async_state;
+
+    char scheme[8];
+    char host[128];
+    int  port;
+    char path[256];
+
+    header_t headers[MAX_HEADERS];
+    int      header_count;
+
+    int sock;
+
+    // TLS (https only). The session outlives the connection so the next
+    // handshake can resume it, like esp-tls with save_client_session.
+    SSL_CTX     *ssl_ctx;
+    SSL         *ssl;
+    SSL_SESSION *session;
+    bool         save_session;
+    uint32_t     tls_start;
+    char        *cert_pem;
+    bool         use_crt_bundle;
+    char         common_name[128];
+    bool         skip_cn_check;
+
+    // Response state
+    int     status_code;
+    int64_t content_length;
+    bool    chunked;
+    bool    keep_alive;
+    bool    body_done;
+    int64_t body_remaining;
+    int64_t chunk_remaining;
+    bool    chunk_need_crlf;
+    bool    chunk_trailers;
+    bool    status_parsed;
+
+    char rx[RX_CAP];
+    int  rx_len;
+    int  rx_pos;
+
+    // The line being read; survives an EAGAIN partway through it
+    char line[1024];
+    int  line_len;
+};
+
+static void dispatch(esp_http_client_handle_t client, esp_http_client_event_id_t id,
+                     void *data, int len, char *key, char *value)
+{
+    if (!client->event_handler) {
+        return;
+    }
+    esp_http_client_event_t evt = {
+        .event_id = id,
+        .client = client,
+        .data = data,
+        .data_len = len,
+        .user_data = client->user_data,
+        .header_key = key,
+        .header_value = value,
+    };
+    client->event_handler(&evt);
+}
+
+// Only its address matters: the shim checks for it in crt_bundle_attach.
+esp_err_t esp_crt_bundle_attach(void *conf)
+{
+    (void)conf;
+    return ESP_OK;
+}
+
+static esp_err_t parse_url(esp_http_client_handle_t client, const char *url)
+{
+    const char *sep = strstr(url, "://");
+    if (!sep || (size_t)(sep - url) >= sizeof(client->scheme)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(client->scheme, url, sep - url);
+    client->scheme[sep - url] = '\0';
+
+    const char *host = sep + 3;
+    const char *path = strchr(host, '/');
+    if (!path) {
+        path = host + strlen(host);
+    }
+    const char *colon = memchr(host, ':', path - host);
+    const char *host_end = colon ? colon : path;
+    if ((size_t)(host_end - host) >= sizeof(client->host)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(client->host, host, host_end - host);
+    client->host[host_end - host] = '\0';
+
+    if (colon) {
+        client->port = atoi(colon + 1);
+    } else {
+        client->port = strcmp(client->scheme, "https") == 0 ? 443 : 80;
+    }
+    snprintf(client->path, sizeof(client->path), "%s", *path ? path : "/");
+    return ESP_OK;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+    esp_http_client_handle_t client = calloc(1, sizeof(*client));
+    if (!client) {
+        return NULL;
+    }
+    client->event_handler = config->event_handler;
+    client->user_data = config->user_data;
+    client->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : 5000;
+    client->buffer_size = config->buffer_size > 0 ? config->buffer_size : DEFAULT_BUF_SIZE;
+    client->method = config->method;
+    client->is_async = config->is_async;
+    client->sock = -1;
+    client->content_length = -1;
+    client->use_crt_bundle = config->crt_bundle_attach == esp_crt_bundle_attach;
+    client->cert_pem = config->cert_pem ? strdup(config->cert_pem) : NULL;
+    client->skip_cn_check = config->skip_cert_common_name_check;
+    if (config->common_name) {
+        snprintf(client->common_name, sizeof(client->common_name), "%s", config->common_name);
+    }
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    client->save_session = config->save_client_session;
+#endif
+    // A peer closing mid-write must surface as an error, not kill the process
+    signal(SIGPIPE, SIG_IGN);
+
+    if (config->url) {
+        if (parse_url(client, config->url) != ESP_OK) {
+            free(client->cert_pem);
+            free(client);
+            return NULL;
+        }
+    } else {
+        snprintf(client->scheme, sizeof(client->scheme), "http");
+        snprintf(client->host, sizeof(client->host), "%s", config->host ? config->host : "");
+        client->port = config->port ? config->port : 80;
+        snprintf(client->path, sizeof(client->path), "%s", config->path ? config->path : "/");
+    }
+    return client;
+}
+
+static void close_socket(esp_http_client_handle_t client)
+{
+    if (client->ssl) {
+        // Quiet close: no close_notify round trip, and the session stays
+        // resumable (OpenSSL invalidates sessions of unclean shutdowns).
+        SSL_set_shutdown(client->ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        SSL_free(client->ssl);
+        client->ssl = NULL;
+    }
+    client->async_state = ASYNC_IDLE;
+    if (client->sock >= 0) {
+        close(client->sock);
+        client->sock = -1;
+        client->rx_len = client->rx_pos = 0;
+        dispatch(client, HTTP_EVENT_DISCONNECTED, NULL, 0, NULL, NULL);
+    }
+}
+
+// Async mode: wait up to timeout_ms for the socket to become ready, as
+// esp-transport's select does before reporting EAGAIN
+static void wait_ready(esp_http_client_handle_t client, short events)
+{
+    struct pollfd pfd = {.fd = client->sock, .events = events};
+    poll(&pfd, 1, client->timeout_ms);
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+    close_socket(client);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    if (!client) {
+        return ESP_FAIL;
+    }
+    close_socket(client);
+    for (int i = 0; i < client->header_count; i++) {
+        free(client->headers[i].key);
+        free(client->headers[i].value);
+    }
+    if (client->session) {
+        SSL_SESSION_free(client->session);
+    }
+    if (client->ssl_ctx) {
+        SSL_CTX_free(client->ssl_ctx);
+    }
+    free(client->cert_pem);
+    free(client);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url)
+{
+    char old_host[sizeof(client->host)];
+    int old_port = client->port;
+    snprintf(old_host, sizeof(old_host), "%s", client->host);
+
+    esp_err_t err = parse_url(client, url);
+    if (err == ESP_OK && (old_port != client->port || strcmp(old_host, client->host) != 0)) {
+        close_socket(client);
+    }
+    return err;
+}
+
+esp_err_t esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method)
+{
+    client->method = method;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_timeout_ms(esp_http_client_handle_t client, int timeout_ms)
+{
+    client->timeout_ms = timeout_ms;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_delete_header(esp_http_client_handle_t client, const char *key)
+{
+    for (int i = 0; i < client->header_count; i++) {
+        if (strcasecmp(client->headers[i].key, key) == 0) {
+            free(client->headers[i].key);
+            free(client->headers[i].value);
+            client->headers[i] = client->headers[--client->header_count];
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value)
+{
+    esp_http_client_delete_header(client, key);
+    if (client->header_count >= MAX_HEADERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    client->headers[client->header_count].key = strdup(key);
+    client->headers[client->header_count].value = strdup(value);
+    client->header_count++;
+    return ESP_OK;
+}
+
+// OpenSSL hands every new session (including TLS 1.3 tickets that arrive
+// after the handshake) here; keep the latest for the next connection.
+static int tls_new_session(SSL *ssl, SSL_SESSION *session)
+{
+    esp_http_client_handle_t client = SSL_get_app_data(ssl);
+    if (!client->save_session) {
+        return 0;
+    }
+    if (client->session) {
+        SSL_SESSION_free(client->session);
+    }
+    client->session = session;
+    return 1;
+}
+
+static esp_err_t tls_init_ctx(esp_http_client_handle_t client)
+{
+    if (!client->cert_pem && !client->use_crt_bundle) {
+        ESP_LOGE(TAG, "no server verification option set (cert_pem or crt_bundle_attach)");
+        return ESP_ERR_HTTP_CONNECT;
+    }
+
+    SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+    if (!ctx) {
+        return ESP_ERR_NO_MEM;
+    }
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, NULL);
+    SSL_CTX_set_options(ctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, tls_new_session);
+
+    bool ok = true;
+    if (client->cert_pem) {
+        BIO *bio = BIO_new_mem_buf(client->cert_pem, -1);
+        X509_STORE *store = SSL_CTX_get_cert_store(ctx);
+        X509 *cert;
+        int count = 0;
+        while (bio && (cert = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL) {
+            ok &= X509_STORE_add_cert(store, cert) == 1;
+            X509_free(cert);
+            count++;
+        }
+        BIO_free(bio);
+        ERR_clear_error();
+        ok &= count > 0;
+    } else {
+        ok = SSL_CTX_set_default_verify_paths(ctx) == 1;
+    }
+    if (!ok) {
+        ESP_LOGE(TAG, "failed to load server CA certificate");
+        SSL_CTX_free(ctx);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    client->ssl_ctx = ctx;
+    return ESP_OK;
+}
+
+static esp_err_t tls_begin(esp_http_client_handle_t client)
+{
+    if (!client->ssl_ctx) {
+        esp_err_t err = tls_init_ctx(client);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    // Like esp-tls: common_name, when set, replaces the URL host for both
+    // SNI and certificate verification (the URL may hold a bare address).
+    const char *name = client->common_name[0] ? client->common_name : client->host;
+    client->ssl = SSL_new(client->ssl_ctx);
+    if (!client->ssl) {
+        return ESP_ERR_NO_MEM;
+    }
+    SSL_set_app_data(client->ssl, client);
+    SSL_set_fd(client->ssl, client->sock);
+    SSL_set_tlsext_host_name(client->ssl, name);
+    if (!client->skip_cn_check) {
+        SSL_set1_host(client->ssl, name);
+    }
+    if (client->save_session && client->session) {
+        SSL_set_session(client->ssl, client->session);
+    }
+    client->tls_start = esp_log_timestamp();
+    return ESP_OK;
+}
+
+// Runs the handshake as far as it can; ESP_ERR_HTTP_EAGAIN if it is waiting
+// on the server (non-blocking sockets only)
+static esp_err_t tls_step(esp_http_client_handle_t client)
+{
+    const char *name = client->common_name[0] ? client->common_name : client->host;
+    int rc = SSL_connect(client->ssl);
+    if (rc != 1) {
+        int e_ssl = SSL_get_error(client->ssl, rc);
+        if (client->is_async && (e_ssl == SSL_ERROR_WANT_READ || e_ssl == SSL_ERROR_WANT_WRITE)) {
+            wait_ready(client, e_ssl == SSL_ERROR_WANT_READ ? POLLIN : POLLOUT);
+            return ESP_ERR_HTTP_EAGAIN;
+        }
+        unsigned long e = ERR_get_error();
+        ESP_LOGE(TAG, "TLS handshake with %s failed: %s", name,
+                 e ? ERR_error_string(e, NULL) : "connection closed");
+        ERR_clear_error();
+        SSL_free(client->ssl);
+        client->ssl = NULL;
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    ESP_LOGI(TAG, "TLS handshake with %s: %s, %s (%u ms)", name, SSL_get_version(client->ssl),
+             SSL_session_reused(client->ssl) ? "resumed" : "full",
+             (unsigned)(esp_log_timestamp() - client->tls_start));
+    return ESP_OK;
+}
+
+static esp_err_t tls_handshake(esp_http_client_handle_t client)
+{
+    esp_err_t err = tls_begin(client);
+    if (err == ESP_OK) {
+        err = tls_step(client);
+    }
+    return err;
+}
+
+static bool is_https(esp_http_client_handle_t client)
+{
+    return strcmp(client->scheme, "https") == 0;
+}
+
+// Async mode: start a non-blocking connect to the first address and leave it
+// in flight (ASYNC_CONNECTING)
+static esp_err_t connect_begin(esp_http_client_handle_t client)
+{
+    if (!is_https(client) && strcmp(client->scheme, "http") != 0) {
+        ESP_LOGE(TAG, "unsupported scheme: %s", client->scheme);
+        return ESP_ERR_HTTP_INVALID_TRANSPORT;
+    }
+
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%d", client->port);
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(client->host, port_str, &hints, &res) != 0 || !res) {
+        ESP_LOGE(TAG, "DNS lookup failed for %s", client->host);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    int sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (sock >= 0) {
+        fcntl(sock, F_SETFL, O_NONBLOCK);
+        if (connect(sock, res->ai_addr, res->ai_addrlen) != 0 && errno != EINPROGRESS) {
+            close(sock);
+            sock = -1;
+        }
+    }
+    freeaddrinfo(res);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "connect to %s:%d failed", client->host, client->port);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    client->sock = sock;
+    client->rx_len = client->rx_pos = 0;
+    client->async_state = ASYNC_CONNECTING;
+    return ESP_OK;
+}
+
+static esp_err_t connect_poll(esp_http_client_handle_t client)
+{
+    struct pollfd pfd = {.fd = client->sock, .events = POLLOUT};
+    if (poll(&pfd, 1, client->timeout_ms) != 1) {
+        return ESP_ERR_HTTP_EAGAIN;
+    }
+    int so_err = 0;
+    socklen_t so_len = sizeof(so_err);
+    if (getsockopt(client->sock, SOL_SOCKET, SO_ERROR, &so_err, &so_len) != 0 || so_err != 0) {
+        ESP_LOGE(TAG, "connect to %s:%d failed", client->host, client->port);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t connect_socket(esp_http_client_handle_t client)
+{
+    bool https = strcmp(client->scheme, "https") == 0;
+    if (!https && strcmp(client->scheme, "http") != 0) {
+        ESP_LOGE(TAG, "unsupported scheme: %s", client->scheme);
+        return ESP_ERR_HTTP_INVALID_TRANSPORT;
+    }
+
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%d", client->port);
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(client->host, port_str, &hints, &res) != 0 || !res) {
+        ESP_LOGE(TAG, "DNS lookup failed for %s", client->host);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+
+    int sock = -1;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock < 0) {
+            continue;
+        }
+        // Non-blocking connect so timeout_ms bounds the handshake
+        fcntl(sock, F_SETFL, O_NONBLOCK);
+        int rc = connect(sock, ai->ai_addr, ai->ai_addrlen);
+        if (rc != 0 && errno == EINPROGRESS) {
+            struct pollfd pfd = {.fd = sock, .events = POLLOUT};
+            int so_err = 0;
+            socklen_t so_len = sizeof(so_err);
+            if (poll(&pfd, 1, client->timeout_ms) == 1 &&
+                getsockopt(sock, SOL_SOCKET, SO_ERROR, &so_err, &so_len) == 0 && so_err == 0) {
+                rc = 0;
+            }
+        }
+        if (rc == 0) {
+            fcntl(sock, F_SETFL, 0);
+            break;
+        }
+        close(sock);
+        sock = -1;
+    }
+    freeaddrinfo(res);
+
+    if (sock < 0) {
+        ESP_LOGE(TAG, "connect to %s:%d failed", client->host, client->port);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+
+    struct timeval tv = {
+        .tv_sec = client->timeout_ms / 1000,
+        .tv_usec = (client->timeout_ms % 1000) * 1000,
+    };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    client->sock = sock;
+    client->rx_len = client->rx_pos = 0;
+    if (https) {
+        esp_err_t err = tls_handshake(client);
+        if (err != ESP_OK) {
+            close(client->sock);
+            client->sock = -1;
+            return err;
+        }
+    }
+    dispatch(client, HTTP_EVENT_ON_CONNECTED, NULL, 0, NULL, NULL);
+    return ESP_OK;
+}
+
+static const char *method_name(esp_http_client_method_t method)
+{
+    switch (method) {
+    case HTTP_METHOD_POST:   return "POST";
+    case HTTP_METHOD_PUT:    return "PUT";
+    case HTTP_METHOD_PATCH:  return "PATCH";
+    case HTTP_METHOD_DELETE: return "DELETE";
+    case HTTP_METHOD_HEAD:   return "HEAD";
+    default:                 return "GET";
+    }
+}
+
+static esp_err_t send_request(esp_http_client_handle_t client, int write_len)
+{
+    char req[2048];
+    int n = snprintf(req, sizeof(req), "%s %s HTTP/1.1\r\nUser-Agent: ESP32 HTTP Client/1.0\r\n",
+                     method_name(client->method), client->path);
+    bool has_host = false;
+    for (int i = 0; i < client->header_count; i++) {
+        has_host |= strcasecmp(client->headers[i].key, "Host") == 0;
+    }
+    if (!has_host) {
+        n += snprintf(req + n, sizeof(req) - n, "Host: %s:%d\r\n", client->host, client->port);
+    }
+    for (int i = 0; i < client->header_count && n < (int)sizeof(req); i++) {
+        n += snprintf(req + n, sizeof(req) - n, "%s: %s\r\n",
+                      client->headers[i].key, client->headers[i].value);
+    }
+    if (write_len > 0 && n < (int)sizeof(req)) {
+        n += snprintf(req + n, sizeof(req) - n, "Content-Length: %d\r\n", write_len);
+    }
+    if (n < (int)sizeof(req)) {
+        n += snprintf(req + n, sizeof(req) - n, "\r\n");
+    }
+    if (n >= (int)sizeof(req)) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int sent = 0; sent < n;) {
+        ssize_t w = client->ssl ? SSL_write(client->ssl, req + sent, n - sent)
+                                : send(client->sock, req + sent, n - sent, MSG_NOSIGNAL);
+        if (w <= 0) {
+            bool full = client->ssl ? SSL_get_error(client->ssl, (int)w) == SSL_ERROR_WANT_WRITE
+                                    : errno == EAGAIN || errno == EWOULDBLOCK;
+            if (client->is_async && full) {
+                // The request is small; waiting for room is bounded by the kernel buffer
+                wait_ready(client, POLLOUT);
+                continue;
+            }
+            return ESP_ERR_HTTP_WRITE_DATA;
+        }
+        sent += (int)w;
+    }
+    dispatch(client, HTTP_EVENT_HEADERS_SENT, NULL, 0, NULL, NULL);
+    return ESP_OK;
+}
+
+static int rx_recv(esp_http_client_handle_t client)
+{
+    ssize_t r;
+    if (client->ssl) {
+        r = SSL_read(client->ssl, client->rx, sizeof(client->rx));
+        if (r <= 0) {
+            int e = SSL_get_error(client->ssl, (int)r);
+            ERR_clear_error();
+            if (e == SSL_ERROR_ZERO_RETURN) {
+                return 0;
+            }
+            bool timeout = e == SSL_ERROR_WANT_READ ||
+                           (e == SSL_ERROR_SYSCALL && (errno == EAGAIN || errno == EWOULDBLOCK));
+            return timeout ? -ESP_ERR_HTTP_EAGAIN : -1;
+        }
+    } else {
+        r = recv(client->sock, client->rx, sizeof(client->rx), 0);
+        if (r < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? -ESP_ERR_HTTP_EAGAIN : -1;
+        }
+    }
+    client->rx_len = (int)r;
+    return (int)r;
+}
+
+// Returns bytes available in rx after refilling, 0 on EOF, -1 on error,
+// -ESP_ERR_HTTP_EAGAIN on receive timeout (async: nothing within timeout_ms).
+static int rx_fill(esp_http_client_handle_t client)
+{
+    if (client->rx_pos < client->rx_len) {
+        return client->rx_len - client->rx_pos;
+    }
+    client->rx_pos = client->rx_len = 0;
+    int r = rx_recv(client);
+    if (r == -ESP_ERR_HTTP_EAGAIN && client->is_async) {
+        wait_ready(client, POLLIN);
+        r = rx_recv(client);
+    }
+    return r;
+}
+
+static int rx_read(esp_http_client_handle_t client, char *out, int len)
+{
+    int avail = rx_fill(client);
+    if (avail <= 0) {
+        return avail;
+    }
+    int n = avail < len ? avail : len;
+    memcpy(out, client->rx + client->rx_pos, n);
+    client->rx_pos += n;
+    return n;
+}
+
+// Read one CRLF-terminated line into client->line (terminator stripped),
+// carrying on with a partial one. Returns its length, -1 on error, or (async
+// only) -ESP_ERR_HTTP_EAGAIN if the rest of it hasn't arrived yet.
+static int rx_read_line(esp_http_client_handle_t client)
+{
+    while (1) {
+        int avail = rx_fill(client);
+        if (avail <= 0) {
+            return avail == -ESP_ERR_HTTP_EAGAIN && client->is_async ? -ESP_ERR_HTTP_EAGAIN : -1;
+        }
+        char c = client->rx[client->rx_pos++];
+        int len = client->line_len;
+        if (c == '\n') {
+            if (len > 0 && client->line[len - 1] == '\r') {
+                len--;
+            }
+            client->line[len] = '\0';
+            client->line_len = 0;
+            return len;
+        }
+        if (len < (int)sizeof(client->line) - 1) {
+            client->line[client->line_len++] = c;
+        }
+    }
+}
+
+static void begin_response(esp_http_client_handle_t client)
+{
+    client->status_code = 0;
+    client->content_length = -1;
+    client->chunked = false;
+    client->keep_alive = true;
+    client->body_done = false;
+    client->chunk_remaining = 0;
+    client->chunk_need_crlf = false;
+    client->chunk_trailers = false;
+    client->status_parsed = false;
+    client->line_len = 0;
+}
+
+// Reads the status line and headers after begin_response(). Async: returns
+// ESP_ERR_HTTP_EAGAIN when they stop short, and continues on the next call.
+static esp_err_t read_headers(esp_http_client_handle_t client)
+{
+    char *line = client->line;
+    int len;
+
+    if (!client->status_parsed) {
+        len = rx_read_line(client);
+        if (len == -ESP_ERR_HTTP_EAGAIN) {
+            return ESP_ERR_HTTP_EAGAIN;
+        }
+        if (len < 0) {
+            return ESP_ERR_HTTP_FETCH_HEADER;
+        }
+        int minor = 1;
+        if (sscanf(line, "HTTP/1.%d %d", &minor, &client->status_code) != 2) {
+            return ESP_ERR_HTTP_FETCH_HEADER;
+        }
+        if (minor == 0) {
+            client->keep_alive = false;
+        }
+        client->status_parsed = true;
+    }
+
+    while (1) {
+        len = rx_read_line(client);
+        if (len == -ESP_ERR_HTTP_EAGAIN) {
+            return ESP_ERR_HTTP_EAGAIN;
+        }
+        if (len < 0) {
+            return ESP_ERR_HTTP_FETCH_HEADER;
+        }
+        if (len == 0) {
+            break;
+        }
+        char *colon = strchr(line, ':');
+        if (!colon) {
+            continue;
+        }
+        *colon = '\0';
+        char *value = colon + 1;
+        while (*value == ' ' || *value == '\t') value++;
+
+        if (strcasecmp(line, "Content-Length") == 0) {
+            client->content_length = strtoll(value, NULL, 10);
+        } else if (strcasecmp(line, "Transfer-Encoding") == 0 && strcasestr(value, "chunked")) {
+            client->chunked = true;
+        } else if (strcasecmp(line, "Connection") == 0) {
+            if (strcasecmp(value, "close") == 0) client->keep_alive = false;
+            if (strcasecmp(value, "keep-alive") == 0) client->keep_alive = true;
+        }
+        dispatch(client, HTTP_EVENT_ON_HEADER, NULL, 0, line, value);
+    }
+
+    bool no_body = client->method == HTTP_METHOD_HEAD || client->status_code == 204 ||
+                   client->status_code == 304 || client->status_code / 100 == 1;
+    if (no_body) {
+        client->body_done = true;
+    } else if (client->chunked) {
+        client->content_length = -1;
+    } else if (client->content_length >= 0) {
+        client->body_remaining = client->content_length;
+        client->body_done = client->content_length == 0;
+    } else {
+        // Body delimited by connection close
+        client->keep_alive = false;
+    }
+    return ESP_OK;
+}
+
+// Read decoded body bytes. Returns >0 bytes, 0 at end of body, <0 on error
+// (-ESP_ERR_HTTP_EAGAIN: nothing yet).
+static int body_read(esp_http_client_handle_t client, char *out, int len)
+{
+    if (client->body_done) {
+        return 0;
+    }
+
+    if (client->chunked) {
+        int n;
+        if (client->chunk_remaining == 0 && !client->chunk_trailers) {
+            if (client->chunk_need_crlf) {
+                if ((n = rx_read_line(client)) < 0) return n == -ESP_ERR_HTTP_EAGAIN ? n : -1;
+                client->chunk_need_crlf = false;
+            }
+            if ((n = rx_read_line(client)) < 0) return n == -ESP_ERR_HTTP_EAGAIN ? n : -1;
+            client->chunk_remaining = strtoll(client->line, NULL, 16);
+            client->chunk_trailers = client->chunk_remaining == 0;
+            client->chunk_need_crlf = !client->chunk_trailers;
+        }
+        if (client->chunk_trailers) {
+            // Consume trailers up to the terminating empty line
+            while ((n = rx_read_line(client)) > 0) {
+            }
+            if (n == -ESP_ERR_HTTP_EAGAIN) {
+                return n;
+            }
+            client->chunk_trailers = false;
+            client->body_done = true;
+            return 0;
+        }
+        int want = len < client->chunk_remaining ? len : (int)client->chunk_remaining;
+        int r = rx_read(client, out, want);
+        if (r > 0) client->chunk_remaining -= r;
+        return r == 0 ? -1 : r;
+    }
+
+    if (client->content_length >= 0) {
+        int want = len < client->body_remaining ? len : (int)client->body_remaining;
+        int r = rx_read(client, out, want);
+        if (r > 0) {
+            client->body_remaining -= r;
+            client->body_done = client->body_remaining == 0;
+        }
+        return r == 0 ? -1 : r;
+    }
+
+    int r = rx_read(client, out, len);
+    if (r == 0) {
+        client->body_done = true;
+    }
+    return r;
+}
+
+static esp_err_t start_request(esp_http_client_handle_t client, int write_len)
+{
+    esp_err_t err;
+    if (client->sock < 0 && (err = connect_socket(client)) != ESP_OK) {
+        dispatch(client, HTTP_EVENT_ERROR, NULL, 0, NULL, NULL);
+        return err;
+    }
+    if ((err = send_request(client, write_len)) != ESP_OK) {
+        dispatch(client, HTTP_EVENT_ERROR, NULL, 0, NULL, NULL);
+        close_socket(client);
+        return err;
+    }
+    begin_response(client);
+    return ESP_OK;
+}
+
+// Async counterpart of start_request: connect, handshake and send across as
+// many calls as it takes. ESP_OK once the request is sent (ASYNC_HEADERS).
+static esp_err_t start_request_async(esp_http_client_handle_t client, int write_len)
+{
+    esp_err_t err = ESP_OK;
+    if (client->async_state == ASYNC_IDLE) {
+        if (client->sock >= 0) {
+            client->async_state = ASYNC_SEND;
+        } else if ((err = connect_begin(client)) != ESP_OK) {
+            goto fail;
+        }
+    }
+    if (client->async_state == ASYNC_CONNECTING) {
+        if ((err = connect_poll(client)) != ESP_OK) {
+            goto fail;
+        }
+        if (is_https(client)) {
+            if ((err = tls_begin(client)) != ESP_OK) {
+                goto fail;
+            }
+            client->async_state = ASYNC_TLS;
+        } else {
+            dispatch(client, HTTP_EVENT_ON_CONNECTED, NULL, 0, NULL, NULL);
+            client->async_state = ASYNC_SEND;
+        }
+    }
+    if (client->async_state == ASYNC_TLS) {
+        if ((err = tls_step(client)) != ESP_OK) {
+            goto fail;
+        }
+        dispatch(client, HTTP_EVENT_ON_CONNECTED, NULL, 0, NULL, NULL);
+        client->async_state = ASYNC_SEND;
+    }
+    if (client->async_state == ASYNC_SEND) {
+        if ((err = send_request(client, write_len)) != ESP_OK) {
+            goto fail;
+        }
+        begin_response(client);
+        client->async_state = ASYNC_HEADERS;
+    }
+    return ESP_OK;
+
+fail:
+    if (err != ESP_ERR_HTTP_EAGAIN) {
+        dispatch(client, HTTP_EVENT_ERROR, NULL, 0, NULL, NULL);
+        close_socket(client);
+    }
+    return err;
+}
+
+static esp_err_t perform_async(esp_http_client_handle_t client)
+{
+    esp_err_t err;
+    if (client->async_state < ASYNC_HEADERS &&
+        (err = start_request_async(client, 0)) != ESP_OK) {
+        return err;
+    }
+    if (client->async_state == ASYNC_HEADERS) {
+        if ((err = read_headers(client)) == ESP_ERR_HTTP_EAGAIN) {
+            return err;
+        }
+        if (err != ESP_OK) {
+            dispatch(client, HTTP_EVENT_ERROR, NULL, 0, NULL, NULL);
+            close_socket(client);
+            return err;
+        }
+        client->async_state = ASYNC_BODY;
+    }
+
+    char *buf = malloc(client->buffer_size);
+    if (!buf) {
+        close_socket(client);
+        return ESP_ERR_NO_MEM;
+    }
+    int r;
+    while ((r = body_read(client, buf, client->buffer_size)) > 0) {
+        dispatch(client, HTTP_EVENT_ON_DATA, buf, r, NULL, NULL);
+    }
+    free(buf);
+    if (r == -ESP_ERR_HTTP_EAGAIN) {
+        return ESP_ERR_HTTP_EAGAIN;
+    }
+    if (r < 0) {
+        dispatch(client, HTTP_EVENT_ERROR, NULL, 0, NULL, NULL);
+        close_socket(client);
+        return ESP_FAIL;
+    }
+
+    client->async_state = ASYNC_IDLE;
+    dispatch(client, HTTP_EVENT_ON_FINISH, NULL, 0, NULL, NULL);
+    if (!client->keep_alive) {
+        close_socket(client);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client)
+{
+    if (client->is_async) {
+        return perform_async(client);
+    }
+    esp_err_t err = start_request(client, 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if ((err = read_headers(client)) != ESP_OK) {
+        dispatch(client, HTTP_EVENT_ERROR, NULL, 0, NULL, NULL);
+        close_socket(client);
+        return err;
+    }
+
+    char *buf = malloc(client->buffer_size);
+    if (!buf) {
+        close_socket(client);
+        return ESP_ERR_NO_MEM;
+    }
+    int r;
+    while ((r = body_read(client, buf, client->buffer_size)) > 0) {
+        dispatch(client, HTTP_EVENT_ON_DATA, buf, r, NULL, NULL);
+    }
+    free(buf);
+    if (r < 0) {
+        dispatch(client, HTTP_EVENT_ERROR, NULL, 0, NULL, NULL);
+        close_socket(client);
+        return r == -ESP_ERR_HTTP_EAGAIN ? ESP_ERR_HTTP_EAGAIN : ESP_FAIL;
+    }
+
+    dispatch(client, HTTP_EVENT_ON_FINISH, NULL, 0, NULL, NULL);
+    if (!client->keep_alive) {
+        close_socket(client);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_open(esp_http_client_handle_t client, int write_len)
+{
+    if (client->is_async) {
+        return start_request_async(client, write_len);
+    }
+    return start_request(client, write_len);
+}
+
+int64_t esp_http_client_fetch_headers(esp_http_client_handle_t client)
+{
+    if (client->sock < 0) {
+        return ESP_FAIL;
+    }
+    esp_err_t err = read_headers(client);
+    if (err == ESP_ERR_HTTP_EAGAIN) {
+        return -ESP_ERR_HTTP_EAGAIN;
+    }
+    if (err != ESP_OK) {
+        return ESP_FAIL;
+    }
+    client->async_state = client->is_async ? ASYNC_BODY : ASYNC_IDLE;
+    // As in ESP-IDF: 0 when the length is unknown (chunked or close-delimited)
+    return client->content_length > 0 ? client->content_length : 0;
+}
+
+int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
+{
+    if (client->sock < 0) {
+        return -1;
+    }
+    int r = body_read(client, buffer, len);
+    if (r > 0) {
+        dispatch(client, HTTP_EVENT_ON_DATA, buffer, r, NULL, NULL);
+    } else if (r == 0) {
+        dispatch(client, HTTP_EVENT_ON_FINISH, NULL, 0, NULL, NULL);
+    }
+    return r;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    return client->status_code;
+}
+
+int64_t esp_http_client_get_content_length(esp_http_client_handle_t client)
+{
+    return client->content_length;
+}
+
+bool esp_http_client_is_chunked_response(esp_http_client_handle_t client)
+{
+    return client->chunked;
+}
+
+bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client)
+{
+    return client->body_done;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+// Host shim for ESP-IDF esp_http_server.h over POSIX sockets.
+// Implements what the firmware's status server uses: GET handlers matched on
+// the path, query string and request header lookup, status/type/extra
+// response headers, and whole or chunked responses. Requests are handled one
+// at a time on the server's thread, as on the device; each connection is
+// closed after its response.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "esp_err.h"
+
+#define ESP_ERR_HTTPD_BASE             0xb000
+#define ESP_ERR_HTTPD_HANDLERS_FULL    (ESP_ERR_HTTPD_BASE + 1)
+#define ESP_ERR_HTTPD_HANDLER_EXISTS   (ESP_ERR_HTTPD_BASE + 2)
+#define ESP_ERR_HTTPD_INVALID_REQ      (ESP_ERR_HTTPD_BASE + 3)
+#define ESP_ERR_HTTPD_RESULT_TRUNC     (ESP_ERR_HTTPD_BASE + 4)
+#define ESP_ERR_HTTPD_RESP_HDR         (ESP_ERR_HTTPD_BASE + 5)
+#define ESP_ERR_HTTPD_RESP_SEND        (ESP_ERR_HTTPD_BASE + 6)
+#define ESP_ERR_HTTPD_ALLOC_MEM        (ESP_ERR_HTTPD_BASE + 7)
+#define ESP_ERR_HTTPD_TASK             (ESP_ERR_HTTPD_BASE + 8)
+
+#define HTTPD_MAX_URI_LEN     512
+#define HTTPD_RESP_USE_STRLEN -1
+
+#define HTTPD_200 "200 OK"
+#define HTTPD_204 "204 No Content"
+#define HTTPD_400 "400 Bad Request"
+#define HTTPD_404 "404 Not Found"
+#define HTTPD_500 "500 Internal Server Error"
+
+typedef void *httpd_handle_t;
+
+// Same values as http_parser's enum, which the real header uses
+typedef enum {
+    HTTP_DELETE = 0,
+    HTTP_GET    = 1,
+    HTTP_HEAD   = 2,
+    HTTP_POST   = 3,
+    HTTP_PUT    = 4,
+} httpd_method_t;
+
+typedef enum {
+    HTTPD_400_BAD_REQUEST = 400,
+    HTTPD_401_UNAUTHORIZED = 401,
+    HTTPD_404_NOT_FOUND = 404,
+    HTTPD_405_METHOD_NOT_ALLOWED = 405,
+    HTTPD_500_INTERNAL_SERVER_ERROR = 500,
+} httpd_err_code_t;
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int            method;
+    const char     uri[HTTPD_MAX_URI_LEN + 1];
+    size_t         content_len;
+    void          *aux;
+    void          *user_ctx;
+} httpd_req_t;
+
+typedef struct httpd_uri {
+    const char     *uri;
+    httpd_method_t  method;
+    esp_err_t     (*handler)(httpd_req_t *r);
+    void           *user_ctx;
+} httpd_uri_t;
+
+typedef struct {
+    unsigned  task_priority;
+    size_t    stack_size;
+    int       core_id;
+    uint16_t  server_port;
+    uint16_t  ctrl_port;
+    uint16_t  max_open_sockets;
+    uint16_t  max_uri_handlers;
+    uint16_t  max_resp_headers;
+    uint16_t  backlog_conn;
+    bool      lru_purge_enable;
+    uint16_t  recv_wait_timeout;    // seconds
+    uint16_t  send_wait_timeout;    // seconds
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() {            \
+        .task_priority      = 5,            \
+        .stack_size         = 4096,         \
+        .core_id            = 0x7fffffff,   \
+        .server_port        = 80,           \
+        .ctrl_port          = 32768,        \
+        .max_open_sockets   = 7,            \
+        .max_uri_handlers   = 8,            \
+        .max_resp_headers   = 8,            \
+        .backlog_conn       = 5,            \
+        .lru_purge_enable   = false,        \
+        .recv_wait_timeout  = 5,            \
+        .send_wait_timeout  = 5,            \
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_stop(httpd_handle_t handle);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler);
+
+size_t    httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field);
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size);
+
+// Query string (after '?'); ESP_ERR_NOT_FOUND without one.
+size_t    httpd_req_get_url_query_len(httpd_req_t *r);
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len);
+// Value of key in a query string (not URL-decoded, as in ESP-IDF).
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size);
+
+// The strings passed to these must stay valid until the response is sent.
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+// Chunked body: call with more data any number of times, then NULL/0 to end.
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg);
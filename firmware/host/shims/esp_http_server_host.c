@@ -0,0 +1,443 @@
+// POSIX-socket implementation of the esp_http_server shim.
+
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static const char *TAG = "httpd_shim";
+
+#define REQ_CAP          4096
+#define MAX_REQ_HEADERS  32
+
+typedef struct {
+    int              listen_fd;
+    httpd_config_t   config;
+    httpd_uri_t     *handlers;
+    int              handler_count;
+} server_t;
+
+// Per-request state behind httpd_req_t.aux
+typedef struct {
+    int         fd;
+    char        buf[REQ_CAP];
+    const char *hdr_key[MAX_REQ_HEADERS];
+    const char *hdr_value[MAX_REQ_HEADERS];
+    int         hdr_count;
+
+    const char *status;
+    const char *type;
+    const char *resp_key[16];
+    const char *resp_value[16];
+    int         resp_count;
+    bool        headers_sent;
+    bool        failed;
+} req_state_t;
+
+static bool send_all(req_state_t *st, const char *data, size_t len)
+{
+    while (len > 0 && !st->failed) {
+        ssize_t n = send(st->fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            st->failed = true;
+            break;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return !st->failed;
+}
+
+static void send_headers(req_state_t *st, bool chunked, size_t content_len)
+{
+    char head[1024];
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 %s\r\nContent-Type: %s\r\n",
+                     st->status, st->type);
+    for (int i = 0; i < st->resp_count && n < (int)sizeof(head); i++) {
+        n += snprintf(head + n, sizeof(head) - n, "%s: %s\r\n", st->resp_key[i], st->resp_value[i]);
+    }
+    if (n < (int)sizeof(head)) {
+        if (chunked) {
+            n += snprintf(head + n, sizeof(head) - n, "Transfer-Encoding: chunked\r\n");
+        } else {
+            n += snprintf(head + n, sizeof(head) - n, "Content-Length: %zu\r\n", content_len);
+        }
+    }
+    if (n < (int)sizeof(head)) {
+        n += snprintf(head + n, sizeof(head) - n, "Connection: close\r\n\r\n");
+    }
+    if (n >= (int)sizeof(head)) {
+        ESP_LOGE(TAG, "response headers too long");
+        st->failed = true;
+        return;
+    }
+    st->headers_sent = true;
+    send_all(st, head, n);
+}
+
+// Read up to the blank line; false on a closed, slow or oversized request
+static bool read_request(req_state_t *st, size_t *head_len)
+{
+    size_t len = 0;
+    while (len < sizeof(st->buf) - 1) {
+        ssize_t n = recv(st->fd, st->buf + len, sizeof(st->buf) - 1 - len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        len += (size_t)n;
+        st->buf[len] = '\0';
+        char *end = strstr(st->buf, "\r\n\r\n");
+        if (end) {
+            *head_len = (size_t)(end - st->buf) + 4;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int parse_method(const char *m)
+{
+    if (strcmp(m, "GET") == 0) return HTTP_GET;
+    if (strcmp(m, "HEAD") == 0) return HTTP_HEAD;
+    if (strcmp(m, "POST") == 0) return HTTP_POST;
+    if (strcmp(m, "PUT") == 0) return HTTP_PUT;
+    if (strcmp(m, "DELETE") == 0) return HTTP_DELETE;
+    return -1;
+}
+
+static void handle_connection(server_t *srv, int fd)
+{
+    req_state_t *st = calloc(1, sizeof(*st));
+    httpd_req_t *req = calloc(1, sizeof(*req));
+    if (!st || !req) {
+        free(st);
+        free(req);
+        return;
+    }
+    st->fd = fd;
+    st->status = HTTPD_200;
+    st->type = "text/html";
+    req->handle = srv;
+    req->aux = st;
+
+    size_t head_len;
+    if (!read_request(st, &head_len)) {
+        goto out;
+    }
+
+    // Request line; any body after the headers is ignored
+    st->buf[head_len] = '\0';
+    char *save = NULL;
+    char *line_save = NULL;
+    char *line = strtok_r(st->buf, "\r\n", &save);
+    char *method = line ? strtok_r(line, " ", &line_save) : NULL;
+    char *target = method ? strtok_r(NULL, " ", &line_save) : NULL;
+    if (!target) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, NULL);
+        goto out;
+    }
+    req->method = parse_method(method);
+    snprintf((char *)req->uri, sizeof(req->uri), "%s", target);
+
+    // Header lines, split in place
+    char *hdr;
+    while ((hdr = strtok_r(NULL, "\r\n", &save)) != NULL && st->hdr_count < MAX_REQ_HEADERS) {
+        char *colon = strchr(hdr, ':');
+        if (!colon) {
+            continue;
+        }
+        *colon = '\0';
+        char *value = colon + 1;
+        while (*value == ' ' || *value == '\t') {
+            value++;
+        }
+        st->hdr_key[st->hdr_count] = hdr;
+        st->hdr_value[st->hdr_count] = value;
+        st->hdr_count++;
+    }
+
+    // Match on the path alone
+    size_t path_len = strcspn(req->uri, "?");
+    const httpd_uri_t *match = NULL;
+    bool path_known = false;
+    for (int i = 0; i < srv->handler_count; i++) {
+        const httpd_uri_t *h = &srv->handlers[i];
+        if (strlen(h->uri) == path_len && strncmp(h->uri, req->uri, path_len) == 0) {
+            path_known = true;
+            if ((int)h->method == req->method) {
+                match = h;
+                break;
+            }
+        }
+    }
+    if (!match) {
+        httpd_resp_send_err(req, path_known ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND, NULL);
+        goto out;
+    }
+
+    req->user_ctx = match->user_ctx;
+    if (match->handler(req) != ESP_OK && !st->headers_sent) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+    }
+
+out:
+    close(fd);
+    free(st);
+    free(req);
+}
+
+static void server_task(void *arg)
+{
+    server_t *srv = arg;
+    while (1) {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            ESP_LOGE(TAG, "accept: %s", strerror(errno));
+            break;
+        }
+        struct timeval rcv = { .tv_sec = srv->config.recv_wait_timeout };
+        struct timeval snd = { .tv_sec = srv->config.send_wait_timeout };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &rcv, sizeof(rcv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &snd, sizeof(snd));
+        handle_connection(srv, fd);
+    }
+    vTaskDelete(NULL);
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    if (!handle || !config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    server_t *srv = calloc(1, sizeof(*srv));
+    if (!srv) {
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    srv->config = *config;
+    srv->handlers = calloc(config->max_uri_handlers, sizeof(httpd_uri_t));
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (!srv->handlers || srv->listen_fd < 0) {
+        goto fail;
+    }
+
+    int one = 1;
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(config->server_port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(srv->listen_fd, config->backlog_conn) < 0) {
+        ESP_LOGE(TAG, "port %u: %s", config->server_port, strerror(errno));
+        goto fail;
+    }
+    if (xTaskCreate(server_task, "httpd", config->stack_size, srv,
+                    config->task_priority, NULL) != pdPASS) {
+        goto fail;
+    }
+    *handle = srv;
+    return ESP_OK;
+
+fail:
+    if (srv->listen_fd >= 0) {
+        close(srv->listen_fd);
+    }
+    free(srv->handlers);
+    free(srv);
+    return ESP_ERR_HTTPD_TASK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    server_t *srv = handle;
+    if (!srv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Unblocks accept(); the task exits and leaves the rest to the process
+    shutdown(srv->listen_fd, SHUT_RDWR);
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    server_t *srv = handle;
+    if (!srv || !uri_handler || !uri_handler->uri || !uri_handler->handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < srv->handler_count; i++) {
+        if (strcmp(srv->handlers[i].uri, uri_handler->uri) == 0 &&
+            srv->handlers[i].method == uri_handler->method) {
+            return ESP_ERR_HTTPD_HANDLER_EXISTS;
+        }
+    }
+    if (srv->handler_count >= srv->config.max_uri_handlers) {
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+    srv->handlers[srv->handler_count++] = *uri_handler;
+    return ESP_OK;
+}
+
+static const char *find_hdr(httpd_req_t *r, const char *field)
+{
+    req_state_t *st = r->aux;
+    for (int i = 0; i < st->hdr_count; i++) {
+        if (strcasecmp(st->hdr_key[i], field) == 0) {
+            return st->hdr_value[i];
+        }
+    }
+    return NULL;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field)
+{
+    const char *value = find_hdr(r, field);
+    return value ? strlen(value) : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    const char *value = find_hdr(r, field);
+    if (!value) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (!val || val_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    snprintf(val, val_size, "%s", value);
+    return strlen(value) < val_size ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+size_t httpd_req_get_url_query_len(httpd_req_t *r)
+{
+    const char *query = strchr(r->uri, '?');
+    return query ? strlen(query + 1) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    const char *query = strchr(r->uri, '?');
+    if (!query) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (!buf || buf_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    snprintf(buf, buf_len, "%s", query + 1);
+    return strlen(query + 1) < buf_len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size)
+{
+    if (!qry || !key || !val || val_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t key_len = strlen(key);
+    for (const char *p = qry; *p; ) {
+        size_t len = strcspn(p, "&");
+        if (len > key_len && strncmp(p, key, key_len) == 0 && p[key_len] == '=') {
+            size_t value_len = len - key_len - 1;
+            snprintf(val, val_size, "%.*s", (int)value_len, p + key_len + 1);
+            return value_len < val_size ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+        }
+        p += len;
+        if (*p == '&') {
+            p++;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    ((req_state_t *)r->aux)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    ((req_state_t *)r->aux)->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    req_state_t *st = r->aux;
+    int max = st->resp_count;
+    server_t *srv = r->handle;
+    if (max >= srv->config.max_resp_headers || max >= (int)(sizeof(st->resp_key) / sizeof(st->resp_key[0]))) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+    st->resp_key[max] = field;
+    st->resp_value[max] = value;
+    st->resp_count++;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    req_state_t *st = r->aux;
+    if (st->headers_sent) {
+        return ESP_ERR_HTTPD_INVALID_REQ;
+    }
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? (buf ? strlen(buf) : 0) : (size_t)buf_len;
+    send_headers(st, false, len);
+    if (len > 0 && r->method != HTTP_HEAD) {
+        send_all(st, buf, len);
+    }
+    return st->failed ? ESP_ERR_HTTPD_RESP_SEND : ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    req_state_t *st = r->aux;
+    if (!st->headers_sent) {
+        send_headers(st, true, 0);
+    }
+    size_t len = buf_len == HTTPD_RESP_USE_STRLEN ? (buf ? strlen(buf) : 0) : (size_t)buf_len;
+    if (!buf || len == 0) {
+        send_all(st, "0\r\n\r\n", 5);
+    } else {
+        char size_line[16];
+        int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", len);
+        send_all(st, size_line, n);
+        send_all(st, buf, len);
+        send_all(st, "\r\n", 2);
+    }
+    return st->failed ? ESP_ERR_HTTPD_RESP_SEND : ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    const char *status;
+    const char *text;
+    switch (error) {
+    case HTTPD_400_BAD_REQUEST:           status = HTTPD_400; text = "Bad request"; break;
+    case HTTPD_401_UNAUTHORIZED:          status = "401 Unauthorized"; text = "Unauthorized"; break;
+    case HTTPD_404_NOT_FOUND:             status = HTTPD_404; text = "Nothing matches the given URI"; break;
+    case HTTPD_405_METHOD_NOT_ALLOWED:    status = "405 Method Not Allowed"; text = "Request method for this URI is not handled by server"; break;
+    default:                              status = HTTPD_500; text = "Server error"; break;
+    }
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "text/plain");
+    return httpd_resp_send(req, msg ? msg : text, HTTPD_RESP_USE_STRLEN);
+}
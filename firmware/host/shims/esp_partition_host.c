@@ -0,0 +1,132 @@
+// Host esp_partition: one data partition ("history", matching
+// partitions.csv) in a file, so a restart replays what the last run logged.
+
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#define HOST_PARTITION_SIZE (2 * 1024 * 1024)
+
+static esp_partition_t s_partition = {
+    .type = ESP_PARTITION_TYPE_DATA,
+    .subtype = 0x40,
+    .size = HOST_PARTITION_SIZE,
+    .erase_size = SPI_FLASH_SEC_SIZE,
+    .label = "history",
+};
+static FILE *s_file;
+
+static bool open_backing(void)
+{
+    if (s_file) {
+        return true;
+    }
+    const char *path = getenv("ESPCLAUDE_FLASH");
+    if (!path || !*path) {
+        return false;
+    }
+    s_file = fopen(path, "r+b");
+    if (!s_file) {
+        s_file = fopen(path, "w+b");
+        if (!s_file) {
+            return false;
+        }
+    }
+    // Extend (or create) as erased flash
+    fseek(s_file, 0, SEEK_END);
+    long size = ftell(s_file);
+    static uint8_t erased[SPI_FLASH_SEC_SIZE];
+    memset(erased, 0xff, sizeof(erased));
+    while (size < HOST_PARTITION_SIZE) {
+        fwrite(erased, 1, sizeof(erased), s_file);
+        size += sizeof(erased);
+    }
+    fflush(s_file);
+    return true;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    if (type != ESP_PARTITION_TYPE_DATA && type != ESP_PARTITION_TYPE_ANY) {
+        return NULL;
+    }
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != s_partition.subtype) {
+        return NULL;
+    }
+    if (label && strcmp(label, s_partition.label) != 0) {
+        return NULL;
+    }
+    return open_backing() ? &s_partition : NULL;
+}
+
+static bool in_range(const esp_partition_t *p, size_t offset, size_t size)
+{
+    return p == &s_partition && s_file && offset <= p->size && size <= p->size - offset;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset,
+                             void *dst, size_t size)
+{
+    if (!in_range(partition, src_offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    fseek(s_file, (long)src_offset, SEEK_SET);
+    return fread(dst, 1, size, s_file) == size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset,
+                              const void *src, size_t size)
+{
+    if (!in_range(partition, dst_offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // NOR flash only clears bits
+    uint8_t *buf = malloc(size);
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = esp_partition_read(partition, dst_offset, buf, size);
+    if (err == ESP_OK) {
+        const uint8_t *in = src;
+        for (size_t i = 0; i < size; i++) {
+            buf[i] &= in[i];
+        }
+        fseek(s_file, (long)dst_offset, SEEK_SET);
+        err = fwrite(buf, 1, size, s_file) == size ? ESP_OK : ESP_FAIL;
+        fflush(s_file);
+    }
+    free(buf);
+    return err;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset,
+                                    size_t size)
+{
+    if (!in_range(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    static uint8_t erased[SPI_FLASH_SEC_SIZE];
+    memset(erased, 0xff, sizeof(erased));
+    fseek(s_file, (long)offset, SEEK_SET);
+    for (size_t done = 0; done < size; done += sizeof(erased)) {
+        if (fwrite(erased, 1, sizeof(erased), s_file) != sizeof(erased)) {
+            return ESP_FAIL;
+        }
+    }
+    fflush(s_file);
+    return ESP_OK;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len)
+{
+    return (uint32_t)crc32(crc, buf, len);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Host shim for ESP-IDF esp_random.h.
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
@@ -0,0 +1,7 @@
+#pragma once
+
+// Host shim for ESP-IDF esp_rom_crc.h (zlib's CRC-32).
+
+#include <stdint.h>
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len);
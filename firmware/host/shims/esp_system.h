@@ -0,0 +1,9 @@
+#pragma once
+
+// Host shim for ESP-IDF esp_system.h: heap figures come from the C library's
+// allocator (mallinfo2), so they describe this process, not a device.
+
+#include <stdint.h>
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
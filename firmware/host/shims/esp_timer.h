@@ -0,0 +1,8 @@
+#pragma once
+
+// Host shim for ESP-IDF esp_timer.h (time query only).
+
+#include <stdint.h>
+
+// Microseconds since the first call into the shim.
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,22 @@
+#pragma once
+
+// Host shim for the subset of FreeRTOS used by the firmware, backed by pthreads.
+// Ticks are milliseconds (configTICK_RATE_HZ = 1000).
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define configTICK_RATE_HZ 1000
+#define portMAX_DELAY      ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
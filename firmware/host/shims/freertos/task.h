@@ -0,0 +1,32 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct host_task *TaskHandle_t;
+
+// Spawns a detached pthread. Stack depth and priority are accepted but ignored.
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *handle);
+
+// Only deleting the calling task (NULL) is supported.
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+
+// Milliseconds since the first call into the shim.
+TickType_t xTaskGetTickCount(void);
+
+// Tasks started through the shim, plus the main thread.
+UBaseType_t uxTaskGetNumberOfTasks(void);
+
+// Nothing is measured: the stack depth the task was created with (0 for
+// threads the shim didn't start).
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+// Works from any thread, including ones the shim didn't start.
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+// Direct-to-task notifications, used as a counting semaphore (the Give/Take pair).
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks);
@@ -0,0 +1,212 @@
+// pthread-backed implementation of the FreeRTOS shim.
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct host_semaphore {
+    pthread_mutex_t mutex;
+};
+
+struct host_task {
+    TaskFunction_t fn;
+    void *arg;
+    uint32_t stack_depth;
+
+    // Notification count
+    pthread_mutex_t notify_mutex;
+    pthread_cond_t  notify_cond;
+    uint32_t        notify_count;
+};
+
+static __thread struct host_task *s_current;
+static atomic_uint s_task_count = 1;    // main
+
+static void task_init_notify(struct host_task *task)
+{
+    pthread_mutex_init(&task->notify_mutex, NULL);
+    pthread_cond_init(&task->notify_cond, NULL);
+}
+
+static uint64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    static uint64_t s_boot_ms = 0;
+    uint64_t now = monotonic_ms();
+    if (s_boot_ms == 0) {
+        s_boot_ms = now;
+    }
+    return (TickType_t)(now - s_boot_ms);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec = ticks / 1000u,
+        .tv_nsec = (long)(ticks % 1000u) * 1000000L,
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+static void *task_trampoline(void *p)
+{
+    struct host_task *task = p;
+    s_current = task;
+    task->fn(task->arg);
+    // FreeRTOS tasks never return; if one does, just let the thread exit.
+    atomic_fetch_sub(&s_task_count, 1);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *handle)
+{
+    (void)name;
+    (void)priority;
+
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (!task) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->stack_depth = stack_depth;
+    task_init_notify(task);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_trampoline, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    atomic_fetch_add(&s_task_count, 1);
+    if (handle) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    return atomic_load(&s_task_count);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    if (!task) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+    return task ? task->stack_depth : 0;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (!s_current) {
+        // main() or a thread started outside the shim; never freed
+        s_current = calloc(1, sizeof(*s_current));
+        if (s_current) {
+            task_init_notify(s_current);
+        }
+    }
+    return s_current;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->notify_mutex);
+    task->notify_count++;
+    pthread_cond_signal(&task->notify_cond);
+    pthread_mutex_unlock(&task->notify_mutex);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks)
+{
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ticks / 1000u;
+    deadline.tv_nsec += (long)(ticks % 1000u) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&task->notify_mutex);
+    while (task->notify_count == 0 && ticks != 0) {
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&task->notify_cond, &task->notify_mutex);
+        } else if (pthread_cond_timedwait(&task->notify_cond, &task->notify_mutex,
+                                          &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    uint32_t count = task->notify_count;
+    if (count > 0) {
+        task->notify_count = clear_count_on_exit ? 0 : count - 1;
+    }
+    pthread_mutex_unlock(&task->notify_mutex);
+    return count;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL) {
+        atomic_fetch_sub(&s_task_count, 1);
+        pthread_exit(NULL);
+    }
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    struct host_semaphore *sem = calloc(1, sizeof(*sem));
+    if (sem) {
+        pthread_mutex_init(&sem->mutex, NULL);
+    }
+    return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY) {
+        return pthread_mutex_lock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+    if (ticks == 0) {
+        return pthread_mutex_trylock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ticks / 1000u;
+    deadline.tv_nsec += (long)(ticks % 1000u) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return pthread_mutex_timedlock(&sem->mutex, &deadline) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    return pthread_mutex_unlock(&sem->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem) {
+        pthread_mutex_destroy(&sem->mutex);
+        free(sem);
+    }
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+// Headless stand-in for the LVGL 9 API surface used by the UI.
+// Widgets are plain tree nodes that remember the state the UI reads back
+// (label text, bar value, background colour, flags); nothing is rendered.
+// This keeps the UI update logic (formatting, dirty checks, countdowns)
+// runnable and profilable on a workstation.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct _lv_display_t lv_display_t;
+typedef struct _lv_obj_t   lv_obj_t;
+typedef struct _lv_event_t lv_event_t;
+typedef struct _lv_timer_t lv_timer_t;
+
+typedef uint8_t  lv_opa_t;
+typedef uint32_t lv_style_selector_t;
+typedef uint32_t lv_obj_flag_t;
+
+typedef struct {
+    uint8_t blue;
+    uint8_t green;
+    uint8_t red;
+} lv_color_t;
+
+typedef struct {
+    lv_color_t bg_color;
+    lv_opa_t   bg_opa;
+    int32_t    radius;
+} lv_style_t;
+
+typedef struct {
+    int line_height;
+} lv_font_t;
+
+extern const lv_font_t lv_font_montserrat_14;
+extern const lv_font_t lv_font_montserrat_16;
+extern const lv_font_t lv_font_montserrat_20;
+extern const lv_font_t lv_font_montserrat_24;
+
+#define LV_OPA_TRANSP 0
+#define LV_OPA_60     153
+#define LV_OPA_COVER  255
+
+#define LV_PART_MAIN      0x000000
+#define LV_PART_SCROLLBAR 0x010000
+#define LV_PART_INDICATOR 0x020000
+#define LV_PART_KNOB      0x030000
+#define LV_PART_SELECTED  0x040000
+#define LV_PART_ITEMS     0x050000
+#define LV_PART_CURSOR    0x060000
+
+#define LV_STATE_DEFAULT 0x0000
+#define LV_STATE_CHECKED 0x0001
+#define LV_STATE_PRESSED 0x0020
+
+#define LV_OBJ_FLAG_HIDDEN     (1u << 0)
+#define LV_OBJ_FLAG_CLICKABLE  (1u << 1)
+#define LV_OBJ_FLAG_SCROLLABLE (1u << 4)
+
+typedef enum {
+    LV_ANIM_OFF = 0,
+    LV_ANIM_ON,
+} lv_anim_enable_t;
+
+typedef enum {
+    LV_EVENT_ALL = 0,
+    LV_EVENT_PRESSED,
+    LV_EVENT_PRESSING,
+    LV_EVENT_PRESS_LOST,
+    LV_EVENT_SHORT_CLICKED,
+    LV_EVENT_LONG_PRESSED,
+    LV_EVENT_LONG_PRESSED_REPEAT,
+    LV_EVENT_CLICKED,
+    LV_EVENT_RELEASED,
+    LV_EVENT_VALUE_CHANGED = 35,
+} lv_event_code_t;
+
+typedef enum {
+    LV_TEXT_ALIGN_AUTO,
+    LV_TEXT_ALIGN_LEFT,
+    LV_TEXT_ALIGN_CENTER,
+    LV_TEXT_ALIGN_RIGHT,
+} lv_text_align_t;
+
+typedef enum {
+    LV_LABEL_LONG_WRAP,
+    LV_LABEL_LONG_DOT,
+    LV_LABEL_LONG_SCROLL,
+    LV_LABEL_LONG_SCROLL_CIRCULAR,
+    LV_LABEL_LONG_CLIP,
+} lv_label_long_mode_t;
+
+typedef enum {
+    LV_CHART_TYPE_NONE,
+    LV_CHART_TYPE_LINE,
+    LV_CHART_TYPE_BAR,
+    LV_CHART_TYPE_SCATTER,
+} lv_chart_type_t;
+
+typedef enum {
+    LV_CHART_AXIS_PRIMARY_Y   = 0x00,
+    LV_CHART_AXIS_SECONDARY_Y = 0x01,
+    LV_CHART_AXIS_PRIMARY_X   = 0x02,
+    LV_CHART_AXIS_SECONDARY_X = 0x04,
+} lv_chart_axis_t;
+
+#define LV_CHART_POINT_NONE INT32_MAX
+
+typedef struct {
+    int32_t   *y_points;
+    lv_color_t color;
+    bool       y_ext_buf_assigned;
+} lv_chart_series_t;
+
+typedef void (*lv_event_cb_t)(lv_event_t *e);
+typedef void (*lv_timer_cb_t)(lv_timer_t *timer);
+
+static inline lv_color_t lv_color_hex(uint32_t c)
+{
+    lv_color_t col = {
+        .blue = (uint8_t)(c & 0xFF),
+        .green = (uint8_t)((c >> 8) & 0xFF),
+        .red = (uint8_t)((c >> 16) & 0xFF),
+    };
+    return col;
+}
+
+// Core
+void lv_init(void);
+uint32_t lv_tick_get(void);
+uint32_t lv_tick_elaps(uint32_t prev_tick);
+uint32_t lv_timer_handler(void);
+lv_timer_t *lv_timer_create(lv_timer_cb_t cb, uint32_t period, void *user_data);
+void *lv_timer_get_user_data(lv_timer_t *timer);
+void lv_timer_ready(lv_timer_t *timer);
+
+// Objects
+lv_obj_t *lv_screen_active(void);
+lv_obj_t *lv_obj_create(lv_obj_t *parent);
+void lv_obj_delete(lv_obj_t *obj);
+void lv_obj_remove_style_all(lv_obj_t *obj);
+void lv_obj_set_size(lv_obj_t *obj, int32_t w, int32_t h);
+void lv_obj_set_width(lv_obj_t *obj, int32_t w);
+void lv_obj_set_height(lv_obj_t *obj, int32_t h);
+void lv_obj_set_pos(lv_obj_t *obj, int32_t x, int32_t y);
+void lv_obj_center(lv_obj_t *obj);
+void lv_obj_add_flag(lv_obj_t *obj, lv_obj_flag_t f);
+void lv_obj_remove_flag(lv_obj_t *obj, lv_obj_flag_t f);
+void lv_obj_clear_flag(lv_obj_t *obj, lv_obj_flag_t f);
+bool lv_obj_has_flag(const lv_obj_t *obj, lv_obj_flag_t f);
+uint32_t lv_obj_get_child_count(const lv_obj_t *obj);
+lv_obj_t *lv_obj_get_child(const lv_obj_t *obj, int32_t idx);
+void lv_obj_add_event_cb(lv_obj_t *obj, lv_event_cb_t cb, lv_event_code_t filter, void *user_data);
+void lv_obj_send_event(lv_obj_t *obj, lv_event_code_t code, void *param);
+void lv_obj_add_style(lv_obj_t *obj, lv_style_t *style, lv_style_selector_t selector);
+
+// Styles (only background colour is stored for read-back)
+void lv_obj_set_style_bg_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector);
+void lv_obj_set_style_text_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_text_font(lv_obj_t *obj, const lv_font_t *value, lv_style_selector_t selector);
+void lv_obj_set_style_text_align(lv_obj_t *obj, lv_text_align_t value, lv_style_selector_t selector);
+void lv_obj_set_style_radius(lv_obj_t *obj, int32_t value, lv_style_selector_t selector);
+void lv_obj_set_style_pad_all(lv_obj_t *obj, int32_t value, lv_style_selector_t selector);
+void lv_obj_set_style_border_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_size(lv_obj_t *obj, int32_t width, int32_t height, lv_style_selector_t selector);
+lv_color_t lv_obj_get_style_bg_color(const lv_obj_t *obj, lv_style_selector_t part);
+
+void lv_style_init(lv_style_t *style);
+void lv_style_set_bg_color(lv_style_t *style, lv_color_t value);
+void lv_style_set_bg_opa(lv_style_t *style, lv_opa_t value);
+void lv_style_set_radius(lv_style_t *style, int32_t value);
+
+// Events
+lv_event_code_t lv_event_get_code(lv_event_t *e);
+lv_obj_t *lv_event_get_target(lv_event_t *e);
+void *lv_event_get_user_data(lv_event_t *e);
+
+// Label
+lv_obj_t *lv_label_create(lv_obj_t *parent);
+void lv_label_set_text(lv_obj_t *obj, const char *text);
+char *lv_label_get_text(const lv_obj_t *obj);
+void lv_label_set_long_mode(lv_obj_t *obj, lv_label_long_mode_t mode);
+
+// Bar
+lv_obj_t *lv_bar_create(lv_obj_t *parent);
+void lv_bar_set_range(lv_obj_t *obj, int32_t min, int32_t max);
+void lv_bar_set_value(lv_obj_t *obj, int32_t value, lv_anim_enable_t anim);
+int32_t lv_bar_get_value(const lv_obj_t *obj);
+
+// Chart (series values are kept for read-back)
+lv_obj_t *lv_chart_create(lv_obj_t *parent);
+void lv_chart_set_type(lv_obj_t *obj, lv_chart_type_t type);
+void lv_chart_set_point_count(lv_obj_t *obj, uint32_t cnt);
+uint32_t lv_chart_get_point_count(const lv_obj_t *obj);
+void lv_chart_set_range(lv_obj_t *obj, lv_chart_axis_t axis, int32_t min, int32_t max);
+void lv_chart_set_div_line_count(lv_obj_t *obj, uint8_t hdiv, uint8_t vdiv);
+lv_chart_series_t *lv_chart_add_series(lv_obj_t *obj, lv_color_t color, lv_chart_axis_t axis);
+void lv_chart_set_ext_y_array(lv_obj_t *obj, lv_chart_series_t *ser, int32_t array[]);
+void lv_chart_set_next_value(lv_obj_t *obj, lv_chart_series_t *ser, int32_t value);
+void lv_chart_refresh(lv_obj_t *obj);
+
+// Tabview
+lv_obj_t *lv_tabview_create(lv_obj_t *parent);
+void lv_tabview_set_tab_bar_size(lv_obj_t *obj, int32_t size);
+lv_obj_t *lv_tabview_get_tab_bar(lv_obj_t *obj);
+lv_obj_t *lv_tabview_add_tab(lv_obj_t *obj, const char *name);
+
+// Host-only instrumentation: number of widget mutations that would have
+// invalidated a screen area on the device.
+uint32_t lv_host_invalidation_count(void);
@@ -0,0 +1,596 @@
+// Headless LVGL stand-in. See lvgl.h.
+
+#include "lvgl.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PART_SLOTS    8
+#define MAX_EVENT_CBS 4
+#define MAX_TIMERS    16
+#define MAX_SERIES    4
+
+typedef struct {
+    lv_event_cb_t   cb;
+    lv_event_code_t filter;
+    void           *user_data;
+} event_dsc_t;
+
+struct _lv_obj_t {
+    lv_obj_t  *parent;
+    lv_obj_t **children;
+    uint32_t   child_count;
+    uint32_t   child_cap;
+
+    lv_obj_flag_t flags;
+    char         *text;
+    int32_t       bar_min;
+    int32_t       bar_max;
+    int32_t       bar_value;
+    lv_color_t    bg_color[PART_SLOTS];
+    int32_t       x, y, w, h;
+
+    lv_chart_series_t *series[MAX_SERIES];
+    int                series_count;
+    uint32_t           point_count;
+
+    event_dsc_t events[MAX_EVENT_CBS];
+    int         event_count;
+};
+
+struct _lv_event_t {
+    lv_event_code_t code;
+    lv_obj_t       *target;
+    void           *user_data;
+    void           *param;
+};
+
+struct _lv_timer_t {
+    lv_timer_cb_t cb;
+    uint32_t      period;
+    uint32_t      last_run;
+    void         *user_data;
+};
+
+const lv_font_t lv_font_montserrat_14 = {.line_height = 16};
+const lv_font_t lv_font_montserrat_16 = {.line_height = 18};
+const lv_font_t lv_font_montserrat_20 = {.line_height = 22};
+const lv_font_t lv_font_montserrat_24 = {.line_height = 27};
+
+static lv_obj_t   *s_screen;
+static lv_timer_t  s_timers[MAX_TIMERS];
+static int         s_timer_count;
+static uint32_t    s_invalidations;
+
+static void invalidate(lv_obj_t *obj)
+{
+    (void)obj;
+    s_invalidations++;
+}
+
+uint32_t lv_host_invalidation_count(void)
+{
+    return s_invalidations;
+}
+
+void lv_init(void)
+{
+    lv_tick_get();
+}
+
+uint32_t lv_tick_get(void)
+{
+    static uint64_t s_start_ms = 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+    if (s_start_ms == 0) {
+        s_start_ms = now;
+    }
+    return (uint32_t)(now - s_start_ms);
+}
+
+uint32_t lv_tick_elaps(uint32_t prev_tick)
+{
+    return lv_tick_get() - prev_tick;
+}
+
+lv_timer_t *lv_timer_create(lv_timer_cb_t cb, uint32_t period, void *user_data)
+{
+    if (s_timer_count >= MAX_TIMERS) {
+        return NULL;
+    }
+    lv_timer_t *t = &s_timers[s_timer_count++];
+    t->cb = cb;
+    t->period = period;
+    t->last_run = lv_tick_get();
+    t->user_data = user_data;
+    return t;
+}
+
+void *lv_timer_get_user_data(lv_timer_t *timer)
+{
+    return timer->user_data;
+}
+
+void lv_timer_ready(lv_timer_t *timer)
+{
+    timer->last_run = lv_tick_get() - timer->period;
+}
+
+uint32_t lv_timer_handler(void)
+{
+    uint32_t next = 500;
+    for (int i = 0; i < s_timer_count; i++) {
+        lv_timer_t *t = &s_timers[i];
+        uint32_t elapsed = lv_tick_elaps(t->last_run);
+        if (elapsed >= t->period) {
+            t->last_run = lv_tick_get();
+            t->cb(t);
+            elapsed = 0;
+        }
+        uint32_t until = t->period - elapsed;
+        if (until < next) {
+            next = until;
+        }
+    }
+    return next;
+}
+
+static lv_obj_t *obj_alloc(lv_obj_t *parent)
+{
+    lv_obj_t *obj = calloc(1, sizeof(*obj));
+    if (!obj) {
+        abort();
+    }
+    obj->parent = parent;
+    obj->bar_max = 100;
+    if (parent) {
+        if (parent->child_count == parent->child_cap) {
+            parent->child_cap = parent->child_cap ? parent->child_cap * 2 : 4;
+            parent->children = realloc(parent->children, parent->child_cap * sizeof(lv_obj_t *));
+            if (!parent->children) {
+                abort();
+            }
+        }
+        parent->children[parent->child_count++] = obj;
+    }
+    return obj;
+}
+
+lv_obj_t *lv_screen_active(void)
+{
+    if (!s_screen) {
+        s_screen = obj_alloc(NULL);
+    }
+    return s_screen;
+}
+
+lv_obj_t *lv_obj_create(lv_obj_t *parent)
+{
+    return obj_alloc(parent);
+}
+
+void lv_obj_delete(lv_obj_t *obj)
+{
+    while (obj->child_count > 0) {
+        lv_obj_delete(obj->children[obj->child_count - 1]);
+    }
+    if (obj->parent) {
+        lv_obj_t *p = obj->parent;
+        for (uint32_t i = 0; i < p->child_count; i++) {
+            if (p->children[i] == obj) {
+                memmove(&p->children[i], &p->children[i + 1],
+                        (p->child_count - i - 1) * sizeof(lv_obj_t *));
+                p->child_count--;
+                break;
+            }
+        }
+    }
+    if (obj == s_screen) {
+        s_screen = NULL;
+    }
+    for (int i = 0; i < obj->series_count; i++) {
+        if (!obj->series[i]->y_ext_buf_assigned) {
+            free(obj->series[i]->y_points);
+        }
+        free(obj->series[i]);
+    }
+    free(obj->children);
+    free(obj->text);
+    free(obj);
+}
+
+void lv_obj_remove_style_all(lv_obj_t *obj)
+{
+    memset(obj->bg_color, 0, sizeof(obj->bg_color));
+    invalidate(obj);
+}
+
+void lv_obj_set_size(lv_obj_t *obj, int32_t w, int32_t h)
+{
+    if (obj->w != w || obj->h != h) {
+        obj->w = w;
+        obj->h = h;
+        invalidate(obj);
+    }
+}
+
+void lv_obj_set_width(lv_obj_t *obj, int32_t w)
+{
+    lv_obj_set_size(obj, w, obj->h);
+}
+
+void lv_obj_set_height(lv_obj_t *obj, int32_t h)
+{
+    lv_obj_set_size(obj, obj->w, h);
+}
+
+void lv_obj_set_pos(lv_obj_t *obj, int32_t x, int32_t y)
+{
+    if (obj->x != x || obj->y != y) {
+        obj->x = x;
+        obj->y = y;
+        invalidate(obj);
+    }
+}
+
+void lv_obj_center(lv_obj_t *obj)
+{
+    invalidate(obj);
+}
+
+void lv_obj_add_flag(lv_obj_t *obj, lv_obj_flag_t f)
+{
+    if ((obj->flags & f) != f) {
+        obj->flags |= f;
+        invalidate(obj);
+    }
+}
+
+void lv_obj_remove_flag(lv_obj_t *obj, lv_obj_flag_t f)
+{
+    if (obj->flags & f) {
+        obj->flags &= ~f;
+        invalidate(obj);
+    }
+}
+
+void lv_obj_clear_flag(lv_obj_t *obj, lv_obj_flag_t f)
+{
+    lv_obj_remove_flag(obj, f);
+}
+
+bool lv_obj_has_flag(const lv_obj_t *obj, lv_obj_flag_t f)
+{
+    return (obj->flags & f) == f;
+}
+
+uint32_t lv_obj_get_child_count(const lv_obj_t *obj)
+{
+    return obj->child_count;
+}
+
+lv_obj_t *lv_obj_get_child(const lv_obj_t *obj, int32_t idx)
+{
+    if (idx < 0) {
+        idx += (int32_t)obj->child_count;
+    }
+    if (idx < 0 || (uint32_t)idx >= obj->child_count) {
+        return NULL;
+    }
+    return obj->children[idx];
+}
+
+void lv_obj_add_event_cb(lv_obj_t *obj, lv_event_cb_t cb, lv_event_code_t filter, void *user_data)
+{
+    if (obj->event_count < MAX_EVENT_CBS) {
+        obj->events[obj->event_count++] = (event_dsc_t){cb, filter, user_data};
+    }
+}
+
+void lv_obj_send_event(lv_obj_t *obj, lv_event_code_t code, void *param)
+{
+    for (int i = 0; i < obj->event_count; i++) {
+        event_dsc_t *d = &obj->events[i];
+        if (d->filter == LV_EVENT_ALL || d->filter == code) {
+            lv_event_t e = {.code = code, .target = obj, .user_data = d->user_data, .param = param};
+            d->cb(&e);
+        }
+    }
+}
+
+void lv_obj_add_style(lv_obj_t *obj, lv_style_t *style, lv_style_selector_t selector)
+{
+    lv_obj_set_style_bg_color(obj, style->bg_color, selector);
+}
+
+static int part_slot(lv_style_selector_t selector)
+{
+    return (int)((selector >> 16) & (PART_SLOTS - 1));
+}
+
+void lv_obj_set_style_bg_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector)
+{
+    // Only default-state values are kept for read-back, like the real getter
+    if ((selector & 0xFFFF) == LV_STATE_DEFAULT) {
+        obj->bg_color[part_slot(selector)] = value;
+    }
+    invalidate(obj);
+}
+
+lv_color_t lv_obj_get_style_bg_color(const lv_obj_t *obj, lv_style_selector_t part)
+{
+    return obj->bg_color[part_slot(part)];
+}
+
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector)
+{
+    (void)value;
+    (void)selector;
+    invalidate(obj);
+}
+
+void lv_obj_set_style_text_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector)
+{
+    (void)value;
+    (void)selector;
+    invalidate(obj);
+}
+
+void lv_obj_set_style_text_font(lv_obj_t *obj, const lv_font_t *value, lv_style_selector_t selector)
+{
+    (void)value;
+    (void)selector;
+    invalidate(obj);
+}
+
+void lv_obj_set_style_text_align(lv_obj_t *obj, lv_text_align_t value, lv_style_selector_t selector)
+{
+    (void)value;
+    (void)selector;
+    invalidate(obj);
+}
+
+void lv_obj_set_style_radius(lv_obj_t *obj, int32_t value, lv_style_selector_t selector)
+{
+    (void)value;
+    (void)selector;
+    invalidate(obj);
+}
+
+void lv_obj_set_style_pad_all(lv_obj_t *obj, int32_t value, lv_style_selector_t selector)
+{
+    (void)value;
+    (void)selector;
+    invalidate(obj);
+}
+
+void lv_obj_set_style_border_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector)
+{
+    (void)value;
+    (void)selector;
+    invalidate(obj);
+}
+
+void lv_obj_set_style_size(lv_obj_t *obj, int32_t width, int32_t height, lv_style_selector_t selector)
+{
+    (void)width;
+    (void)height;
+    (void)selector;
+    invalidate(obj);
+}
+
+void lv_style_init(lv_style_t *style)
+{
+    memset(style, 0, sizeof(*style));
+}
+
+void lv_style_set_bg_color(lv_style_t *style, lv_color_t value)
+{
+    style->bg_color = value;
+}
+
+void lv_style_set_bg_opa(lv_style_t *style, lv_opa_t value)
+{
+    style->bg_opa = value;
+}
+
+void lv_style_set_radius(lv_style_t *style, int32_t value)
+{
+    style->radius = value;
+}
+
+lv_event_code_t lv_event_get_code(lv_event_t *e)
+{
+    return e->code;
+}
+
+lv_obj_t *lv_event_get_target(lv_event_t *e)
+{
+    return e->target;
+}
+
+void *lv_event_get_user_data(lv_event_t *e)
+{
+    return e->user_data;
+}
+
+lv_obj_t *lv_label_create(lv_obj_t *parent)
+{
+    lv_obj_t *obj = obj_alloc(parent);
+    obj->text = strdup("Text");
+    return obj;
+}
+
+void lv_label_set_text(lv_obj_t *obj, const char *text)
+{
+    // Like LVGL, this always reallocates and invalidates, even for equal text
+    char *copy = strdup(text ? text : "");
+    free(obj->text);
+    obj->text = copy;
+    invalidate(obj);
+}
+
+char *lv_label_get_text(const lv_obj_t *obj)
+{
+    return obj->text;
+}
+
+void lv_label_set_long_mode(lv_obj_t *obj, lv_label_long_mode_t mode)
+{
+    (void)mode;
+    invalidate(obj);
+}
+
+lv_obj_t *lv_bar_create(lv_obj_t *parent)
+{
+    return obj_alloc(parent);
+}
+
+void lv_bar_set_range(lv_obj_t *obj, int32_t min, int32_t max)
+{
+    obj->bar_min = min;
+    obj->bar_max = max;
+    invalidate(obj);
+}
+
+void lv_bar_set_value(lv_obj_t *obj, int32_t value, lv_anim_enable_t anim)
+{
+    (void)anim;
+    if (value < obj->bar_min) value = obj->bar_min;
+    if (value > obj->bar_max) value = obj->bar_max;
+    obj->bar_value = value;
+    invalidate(obj);
+}
+
+int32_t lv_bar_get_value(const lv_obj_t *obj)
+{
+    return obj->bar_value;
+}
+
+lv_obj_t *lv_chart_create(lv_obj_t *parent)
+{
+    lv_obj_t *obj = obj_alloc(parent);
+    obj->point_count = 10;      // LVGL's default
+    return obj;
+}
+
+void lv_chart_set_type(lv_obj_t *obj, lv_chart_type_t type)
+{
+    (void)type;
+    invalidate(obj);
+}
+
+static int32_t *alloc_points(uint32_t cnt)
+{
+    int32_t *p = malloc(cnt * sizeof(int32_t));
+    for (uint32_t i = 0; p && i < cnt; i++) {
+        p[i] = LV_CHART_POINT_NONE;
+    }
+    return p;
+}
+
+void lv_chart_set_point_count(lv_obj_t *obj, uint32_t cnt)
+{
+    if (cnt == obj->point_count) {
+        return;
+    }
+    obj->point_count = cnt;
+    for (int i = 0; i < obj->series_count; i++) {
+        if (!obj->series[i]->y_ext_buf_assigned) {
+            free(obj->series[i]->y_points);
+            obj->series[i]->y_points = alloc_points(cnt);
+        }
+    }
+    invalidate(obj);
+}
+
+uint32_t lv_chart_get_point_count(const lv_obj_t *obj)
+{
+    return obj->point_count;
+}
+
+void lv_chart_set_range(lv_obj_t *obj, lv_chart_axis_t axis, int32_t min, int32_t max)
+{
+    (void)axis;
+    (void)min;
+    (void)max;
+    invalidate(obj);
+}
+
+void lv_chart_set_div_line_count(lv_obj_t *obj, uint8_t hdiv, uint8_t vdiv)
+{
+    (void)hdiv;
+    (void)vdiv;
+    invalidate(obj);
+}
+
+lv_chart_series_t *lv_chart_add_series(lv_obj_t *obj, lv_color_t color, lv_chart_axis_t axis)
+{
+    (void)axis;
+    if (obj->series_count == MAX_SERIES) {
+        return NULL;
+    }
+    lv_chart_series_t *ser = calloc(1, sizeof(*ser));
+    ser->color = color;
+    ser->y_points = alloc_points(obj->point_count);
+    obj->series[obj->series_count++] = ser;
+    invalidate(obj);
+    return ser;
+}
+
+void lv_chart_set_ext_y_array(lv_obj_t *obj, lv_chart_series_t *ser, int32_t array[])
+{
+    if (!ser->y_ext_buf_assigned) {
+        free(ser->y_points);
+    }
+    ser->y_points = array;
+    ser->y_ext_buf_assigned = true;
+    invalidate(obj);
+}
+
+// Shift mode only
+void lv_chart_set_next_value(lv_obj_t *obj, lv_chart_series_t *ser, int32_t value)
+{
+    if (obj->point_count == 0) {
+        return;
+    }
+    memmove(ser->y_points, ser->y_points + 1, (obj->point_count - 1) * sizeof(int32_t));
+    ser->y_points[obj->point_count - 1] = value;
+    invalidate(obj);
+}
+
+void lv_chart_refresh(lv_obj_t *obj)
+{
+    invalidate(obj);
+}
+
+// Tabview layout: child 0 is the tab bar (one child per tab button),
+// child 1 is the content area (one child per tab page).
+lv_obj_t *lv_tabview_create(lv_obj_t *parent)
+{
+    lv_obj_t *tv = obj_alloc(parent);
+    obj_alloc(tv);
+    obj_alloc(tv);
+    return tv;
+}
+
+void lv_tabview_set_tab_bar_size(lv_obj_t *obj, int32_t size)
+{
+    lv_obj_set_height(obj->children[0], size);
+}
+
+lv_obj_t *lv_tabview_get_tab_bar(lv_obj_t *obj)
+{
+    return obj->children[0];
+}
+
+lv_obj_t *lv_tabview_add_tab(lv_obj_t *obj, const char *name)
+{
+    lv_obj_t *btn = obj_alloc(obj->children[0]);
+    lv_obj_t *label = lv_label_create(btn);
+    lv_label_set_text(label, name);
+    return obj_alloc(obj->children[1]);
+}
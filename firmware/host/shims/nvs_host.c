@@ -0,0 +1,138 @@
+// Host NVS: a handful of blobs, loaded from $ESPCLAUDE_NVS on first open and
+// written back on commit. One namespace per handle; no locking (the firmware
+// only touches NVS from one task at a time).
+
+#include "nvs.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ENTRIES 16
+#define NAME_LEN    16
+
+typedef struct {
+    char   ns[NAME_LEN];
+    char   key[NAME_LEN];
+    size_t len;
+    void  *data;
+} entry_t;
+
+static entry_t s_entries[MAX_ENTRIES];
+static size_t  s_count;
+static bool    s_loaded;
+static char    s_open_ns[NAME_LEN];
+
+static const char *backing_path(void)
+{
+    const char *path = getenv("ESPCLAUDE_NVS");
+    return path && *path ? path : NULL;
+}
+
+static void load(void)
+{
+    s_loaded = true;
+    FILE *f = fopen(backing_path(), "rb");
+    if (!f) {
+        return;
+    }
+    entry_t e;
+    while (s_count < MAX_ENTRIES && fread(e.ns, 1, NAME_LEN, f) == NAME_LEN &&
+           fread(e.key, 1, NAME_LEN, f) == NAME_LEN && fread(&e.len, sizeof(e.len), 1, f) == 1) {
+        e.data = malloc(e.len);
+        if (!e.data || fread(e.data, 1, e.len, f) != e.len) {
+            free(e.data);
+            break;
+        }
+        s_entries[s_count++] = e;
+    }
+    fclose(f);
+}
+
+static entry_t *find(const char *key)
+{
+    for (size_t i = 0; i < s_count; i++) {
+        if (strcmp(s_entries[i].ns, s_open_ns) == 0 && strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    (void)open_mode;
+    if (!backing_path()) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    if (!s_loaded) {
+        load();
+    }
+    snprintf(s_open_ns, sizeof(s_open_ns), "%s", namespace_name);
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    (void)handle;
+    entry_t *e = find(key);
+    if (!e) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (!out_value) {
+        *length = e->len;
+        return ESP_OK;
+    }
+    if (*length < e->len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out_value, e->data, e->len);
+    *length = e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    (void)handle;
+    entry_t *e = find(key);
+    if (!e) {
+        if (s_count == MAX_ENTRIES) {
+            return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+        e = &s_entries[s_count++];
+        snprintf(e->ns, sizeof(e->ns), "%s", s_open_ns);
+        snprintf(e->key, sizeof(e->key), "%s", key);
+        e->data = NULL;
+    }
+    void *data = realloc(e->data, length);
+    if (!data) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(data, value, length);
+    e->data = data;
+    e->len = length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    FILE *f = fopen(backing_path(), "wb");
+    if (!f) {
+        return ESP_FAIL;
+    }
+    for (size_t i = 0; i < s_count; i++) {
+        fwrite(s_entries[i].ns, 1, NAME_LEN, f);
+        fwrite(s_entries[i].key, 1, NAME_LEN, f);
+        fwrite(&s_entries[i].len, sizeof(s_entries[i].len), 1, f);
+        fwrite(s_entries[i].data, 1, s_entries[i].len, f);
+    }
+    return fclose(f) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
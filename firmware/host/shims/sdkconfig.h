@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for the generated sdkconfig.h: the subset of Kconfig options
+// the firmware and shims test for, matching firmware/sdkconfig.defaults.
+
+#define CONFIG_ESP_HTTP_CLIENT_ENABLE_HTTPS     1
+#define CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS   1
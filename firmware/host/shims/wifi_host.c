@@ -0,0 +1,26 @@
+// Host implementation of wifi.h: the workstation is always "connected".
+
+#include "wifi.h"
+#include "boot_timeline.h"
+
+esp_err_t wifi_init_sta(void)
+{
+    boot_timeline_mark(BOOT_WIFI_ASSOCIATED);
+    boot_timeline_mark(BOOT_IP_ACQUIRED);
+    return ESP_OK;
+}
+
+bool wifi_is_connected(void)
+{
+    return true;
+}
+
+const char *wifi_get_ip(void)
+{
+    return "127.0.0.1";
+}
+
+int8_t wifi_get_rssi(void)
+{
+    return -40;
+}
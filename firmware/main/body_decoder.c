@@ -0,0 +1,160 @@
+#include "body_decoder.h"
+
+#include <string.h>
+#include <strings.h>
+#include <zlib.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "body_decoder";
+
+enum {
+    MODE_IDENTITY,
+    MODE_GZIP,
+    MODE_DEFLATE,       // zlib-wrapped or raw, decided by the first byte
+    MODE_INFLATING,
+};
+
+#define OUT_BUF_SIZE 512
+
+// The history window is the one big allocation; keep it out of internal RAM
+static voidpf zalloc_psram(voidpf opaque, uInt items, uInt size)
+{
+    size_t bytes = (size_t)items * size;
+    void *p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    return p ? p : heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+}
+
+static void zfree_caps(voidpf opaque, voidpf p)
+{
+    heap_caps_free(p);
+}
+
+static void emit(body_decoder_t *d, const char *data, size_t len, body_sink_t sink, void *ctx)
+{
+    d->body_decoded += len;
+    d->stats.decoded_bytes += len;
+    if (d->body_decoded > d->stats.peak_decoded) {
+        d->stats.peak_decoded = d->body_decoded;
+    }
+    sink(ctx, data, len);
+}
+
+static bool ensure_stream(body_decoder_t *d)
+{
+    if (d->zs) {
+        return true;
+    }
+    z_stream *zs = heap_caps_calloc(1, sizeof(z_stream), MALLOC_CAP_8BIT);
+    if (!zs) {
+        return false;
+    }
+    zs->zalloc = zalloc_psram;
+    zs->zfree = zfree_caps;
+    // Window size is fixed here; later resets only switch the wrapper
+    if (inflateInit2(zs, 15 + 32) != Z_OK) {
+        heap_caps_free(zs);
+        return false;
+    }
+    d->zs = zs;
+    return true;
+}
+
+esp_err_t body_decoder_begin(body_decoder_t *d, const char *content_encoding)
+{
+    d->error = false;
+    d->ended = false;
+    d->mode = MODE_IDENTITY;
+    d->body_wire = 0;
+    d->body_decoded = 0;
+
+    if (!content_encoding || !content_encoding[0] ||
+        strcasecmp(content_encoding, "identity") == 0) {
+        return ESP_OK;
+    }
+
+    uint8_t mode;
+    if (strcasecmp(content_encoding, "gzip") == 0 || strcasecmp(content_encoding, "x-gzip") == 0) {
+        mode = MODE_GZIP;
+    } else if (strcasecmp(content_encoding, "deflate") == 0) {
+        mode = MODE_DEFLATE;
+    } else {
+        ESP_LOGW(TAG, "unsupported Content-Encoding: %s", content_encoding);
+        d->error = true;
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (!ensure_stream(d)) {
+        ESP_LOGE(TAG, "no memory for inflate state");
+        d->error = true;
+        return ESP_ERR_NO_MEM;
+    }
+    if (mode == MODE_GZIP) {
+        inflateReset2(d->zs, 15 + 16);
+        mode = MODE_INFLATING;
+    }
+    d->mode = mode;
+    d->stats.compressed++;
+    return ESP_OK;
+}
+
+bool body_decoder_feed(body_decoder_t *d, const char *data, size_t len,
+                       body_sink_t sink, void *ctx)
+{
+    if (d->error) {
+        return false;
+    }
+    d->body_wire += len;
+    d->stats.wire_bytes += len;
+    if (d->ended) {
+        return true;
+    }
+
+    if (d->mode == MODE_IDENTITY) {
+        emit(d, data, len, sink, ctx);
+        return true;
+    }
+    if (len == 0) {
+        return true;
+    }
+    if (d->mode == MODE_DEFLATE) {
+        // "deflate" should be zlib-wrapped, but some servers send it raw
+        uint8_t cmf = (uint8_t)data[0];
+        bool zlib_wrapped = (cmf & 0x0f) == 8 && (cmf >> 4) <= 7;
+        inflateReset2(d->zs, zlib_wrapped ? 15 : -15);
+        d->mode = MODE_INFLATING;
+    }
+
+    z_stream *zs = d->zs;
+    zs->next_in = (Bytef *)data;
+    zs->avail_in = (uInt)len;
+
+    char out[OUT_BUF_SIZE];
+    do {
+        zs->next_out = (Bytef *)out;
+        zs->avail_out = sizeof(out);
+        int rc = inflate(zs, Z_NO_FLUSH);
+        size_t produced = sizeof(out) - zs->avail_out;
+        if (produced) {
+            emit(d, out, produced, sink, ctx);
+        }
+        if (rc == Z_STREAM_END) {
+            // Anything after the end marker is ignored
+            d->ended = true;
+            break;
+        }
+        if (rc == Z_BUF_ERROR) {
+            break;  // needs more input
+        }
+        if (rc != Z_OK) {
+            ESP_LOGW(TAG, "inflate failed: %d", rc);
+            d->error = true;
+            return false;
+        }
+    } while (zs->avail_in > 0 || zs->avail_out == 0);
+    return true;
+}
+
+bool body_decoder_finish(const body_decoder_t *d)
+{
+    return !d->error && (d->mode == MODE_IDENTITY || d->ended);
+}
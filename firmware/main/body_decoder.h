@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Streaming Content-Encoding decoder for response bodies (gzip, deflate).
+//
+// Compressed bytes from HTTP_EVENT_ON_DATA are inflated chunk by chunk into a
+// small fixed output buffer and handed on to a sink, so the decoded body is
+// never held in memory. The inflate state and its history window (32 KB, the
+// size deflate streams may refer back into) are allocated on first use, from
+// PSRAM where available, and reused for every following response.
+
+typedef void (*body_sink_t)(void *ctx, const char *data, size_t len);
+
+typedef struct {
+    uint32_t wire_bytes;      // body bytes received (compressed or not)
+    uint32_t decoded_bytes;   // body bytes after decoding
+    uint32_t compressed;      // responses that arrived compressed
+    uint32_t peak_decoded;    // largest decoded body so far
+} body_decoder_stats_t;
+
+typedef struct {
+    void *zs;                 // z_stream, allocated on first compressed body
+    uint8_t mode;
+    bool    error;
+    bool    ended;            // the compressed stream reached its end marker
+    uint32_t body_wire;       // current body, as received
+    uint32_t body_decoded;    // current body, decoded
+    body_decoder_stats_t stats;
+} body_decoder_t;
+
+// Value for the Accept-Encoding request header.
+#define BODY_DECODER_ACCEPT_ENCODING "gzip, deflate"
+
+// Start a new body. content_encoding is the response's Content-Encoding
+// header (NULL or "identity" for none). Returns ESP_ERR_NOT_SUPPORTED for
+// unknown encodings and ESP_ERR_NO_MEM if the inflate state can't be allocated.
+esp_err_t body_decoder_begin(body_decoder_t *d, const char *content_encoding);
+
+// Decode the next chunk, passing the output to sink. Returns false once the
+// body is corrupt (further input is ignored).
+bool body_decoder_feed(body_decoder_t *d, const char *data, size_t len,
+                       body_sink_t sink, void *ctx);
+
+// True if the body decoded cleanly and, when compressed, was complete.
+bool body_decoder_finish(const body_decoder_t *d);
@@ -0,0 +1,46 @@
+#include "boot_timeline.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "boot";
+
+// One word per phase, so readers on other tasks never see it torn
+static volatile uint32_t s_ms[BOOT_PHASES];
+
+static const char *const s_names[BOOT_PHASES] = {
+    [BOOT_DISPLAY_UP]       = "display",
+    [BOOT_WIFI_ASSOCIATED]  = "wifi",
+    [BOOT_IP_ACQUIRED]      = "ip",
+    [BOOT_TIME_SYNCED]      = "ntp",
+    [BOOT_FIRST_RESPONSE]   = "response",
+    [BOOT_FIRST_PAINT]      = "paint",
+};
+
+void boot_timeline_mark(boot_phase_t phase)
+{
+    if (s_ms[phase] != 0) {
+        return;
+    }
+    uint32_t ms = (uint32_t)(esp_timer_get_time() / 1000);
+    s_ms[phase] = ms ? ms : 1;
+    ESP_LOGI(TAG, "%s at %u ms", s_names[phase], (unsigned)ms);
+
+    if (phase == BOOT_FIRST_PAINT) {
+        // 0 = not reached yet (typically ntp)
+        ESP_LOGI(TAG, "timeline: display %u, wifi %u, ip %u, ntp %u, response %u, paint %u ms",
+                 (unsigned)s_ms[BOOT_DISPLAY_UP], (unsigned)s_ms[BOOT_WIFI_ASSOCIATED],
+                 (unsigned)s_ms[BOOT_IP_ACQUIRED], (unsigned)s_ms[BOOT_TIME_SYNCED],
+                 (unsigned)s_ms[BOOT_FIRST_RESPONSE], (unsigned)s_ms[BOOT_FIRST_PAINT]);
+    }
+}
+
+uint32_t boot_timeline_ms(boot_phase_t phase)
+{
+    return s_ms[phase];
+}
+
+const char *boot_timeline_name(boot_phase_t phase)
+{
+    return s_names[phase];
+}
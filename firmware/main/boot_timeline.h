@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Boot phase timestamps (esp_timer, ms since boot), each recorded once when
+// first reached and logged, so start-up time can be compared across
+// releases. Phases can complete in any order: the first request goes out as
+// soon as there is an IP address, whether or not SNTP has set the clock yet.
+
+typedef enum {
+    BOOT_DISPLAY_UP,
+    BOOT_WIFI_ASSOCIATED,
+    BOOT_IP_ACQUIRED,
+    BOOT_TIME_SYNCED,
+    BOOT_FIRST_RESPONSE,
+    BOOT_FIRST_PAINT,
+    BOOT_PHASES,
+} boot_phase_t;
+
+// Record the phase if this is the first time it is reached. Any task.
+void boot_timeline_mark(boot_phase_t phase);
+
+// Milliseconds since boot when the phase was reached, 0 if not yet.
+uint32_t boot_timeline_ms(boot_phase_t phase);
+
+// Short phase name ("display", "ip", ...).
+const char *boot_timeline_name(boot_phase_t phase);
@@ -0,0 +1,200 @@
+#include "history.h"
+#include "config.h"
+
+// Pushed updates can arrive every few seconds; thin them out so the store
+// and the flash log still span weeks
+#ifndef HISTORY_MIN_SPACING_S
+#define HISTORY_MIN_SPACING_S 10
+#endif
+
+// 1 KB compressed blocks kept for long-horizon queries (see config.h.example)
+#ifndef HISTORY_STORE_BLOCKS
+#define HISTORY_STORE_BLOCKS 512
+#endif
+
+// Rollup horizons, in buckets per resolution (see config.h.example)
+#ifndef HISTORY_ROLLUP_MINUTES
+#define HISTORY_ROLLUP_MINUTES 1440
+#endif
+#ifndef HISTORY_ROLLUP_HOURS
+#define HISTORY_ROLLUP_HOURS 336
+#endif
+#ifndef HISTORY_ROLLUP_DAYS
+#define HISTORY_ROLLUP_DAYS 120
+#endif
+
+#include <stdatomic.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "history_log.h"
+#include "history_rollup.h"
+#include "history_store.h"
+
+static const char *TAG = "history";
+
+static bool s_initialised;
+
+// Time of the last sample kept; written by the HTTP engine task only
+static uint32_t s_last_time;
+
+// Long-horizon store and rollups; read from the UI and server tasks, so they
+// share a lock
+static history_store_t s_store;
+static history_rollup_t s_rollup;
+static SemaphoreHandle_t s_mutex;
+static atomic_uint s_rollup_generation;
+
+// Either of the store and the rollups works without the other
+static bool ensure_history(void)
+{
+    if (s_initialised) {
+        return s_store.blocks || s_rollup.tier[0].buckets;
+    }
+    s_initialised = true;
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex) {
+        ESP_LOGE(TAG, "no mutex; history disabled");
+        return false;
+    }
+    if (history_store_init(&s_store, HISTORY_STORE_BLOCKS) == ESP_OK) {
+        ESP_LOGI(TAG, "store: %u blocks (%u KB)", (unsigned)HISTORY_STORE_BLOCKS,
+                 (unsigned)(HISTORY_STORE_BLOCKS * HISTORY_BLOCK_BYTES / 1024));
+    } else {
+        ESP_LOGW(TAG, "no memory for the long-horizon store");
+    }
+    static const uint32_t rollup_capacity[HISTORY_RESOLUTIONS] = {
+        [HISTORY_RES_MINUTE] = HISTORY_ROLLUP_MINUTES,
+        [HISTORY_RES_HOUR]   = HISTORY_ROLLUP_HOURS,
+        [HISTORY_RES_DAY]    = HISTORY_ROLLUP_DAYS,
+    };
+    if (history_rollup_init(&s_rollup, rollup_capacity) == ESP_OK) {
+        ESP_LOGI(TAG, "rollups: %u min / %u h / %u d (%u KB)", (unsigned)HISTORY_ROLLUP_MINUTES,
+                 (unsigned)HISTORY_ROLLUP_HOURS, (unsigned)HISTORY_ROLLUP_DAYS,
+                 (unsigned)((HISTORY_ROLLUP_MINUTES + HISTORY_ROLLUP_HOURS + HISTORY_ROLLUP_DAYS) *
+                            sizeof(history_bucket_t) / 1024));
+    } else {
+        ESP_LOGW(TAG, "no memory for rollups");
+    }
+    return s_store.blocks || s_rollup.tier[0].buckets;
+}
+
+// Fold a sample in everywhere; false if it was thinned out of the store
+static bool record(const history_sample_t *sample)
+{
+    // Rollups see every status; only the store (and the flash log) are thinned
+    if (s_rollup.tier[0].buckets) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        history_rollup_add(&s_rollup, sample);
+        xSemaphoreGive(s_mutex);
+        atomic_fetch_add_explicit(&s_rollup_generation, 1, memory_order_release);
+    }
+
+    uint32_t time = sample->time;
+    if (s_last_time && time >= s_last_time && time - s_last_time < HISTORY_MIN_SPACING_S) {
+        return false;
+    }
+    s_last_time = time;
+
+    if (s_store.blocks) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        history_store_append(&s_store, sample);
+        xSemaphoreGive(s_mutex);
+    }
+    return true;
+}
+
+static void replay_cb(void *ctx, const history_sample_t *sample)
+{
+    (void)ctx;
+    if (sample->time >= CLOCK_VALID_AFTER) {
+        record(sample);
+    }
+}
+
+void history_init(void)
+{
+    if (ensure_history()) {
+        history_log_open(replay_cb, NULL);
+    }
+}
+
+void history_append(const status_data_t *status, uint32_t time)
+{
+    if (time < CLOCK_VALID_AFTER) {
+        return;
+    }
+    if (!ensure_history()) {
+        return;
+    }
+
+    history_sample_t sample = {
+        .time = time,
+        .session = status->session.utilisation,
+        .weekly_all = status->weekly_all.utilisation,
+        .weekly_sonnet = status->weekly_sonnet.utilisation,
+        .burn_cost_per_hour = status->burn_cost_per_hour,
+        .session_cost_usd = status->session_cost_usd,
+    };
+    if (record(&sample)) {
+        history_log_append(&sample);
+    }
+}
+
+// Collects max samples; the store is asked for one more to tell if any are left
+typedef struct {
+    history_sample_t *out;
+    size_t max;
+    size_t n;
+    bool more;
+} query_t;
+
+static void query_cb(void *ctx, const history_sample_t *sample)
+{
+    query_t *q = ctx;
+    if (q->n < q->max) {
+        q->out[q->n++] = *sample;
+    } else {
+        q->more = true;
+    }
+}
+
+size_t history_query(uint32_t from, uint32_t to, history_sample_t *out, size_t max, bool *more)
+{
+    query_t q = { .out = out, .max = max };
+    if (s_store.blocks) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        history_store_query_n(&s_store, from, to, max + 1, query_cb, &q);
+        xSemaphoreGive(s_mutex);
+    }
+    *more = q.more;
+    return q.n;
+}
+
+void history_get_store_stats(history_store_stats_t *out)
+{
+    if (!s_store.blocks) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    history_store_get_stats(&s_store, out);
+    xSemaphoreGive(s_mutex);
+}
+
+uint32_t history_rollup_generation(void)
+{
+    return atomic_load_explicit(&s_rollup_generation, memory_order_acquire);
+}
+
+void history_read_rollup(history_res_t res, uint32_t from, history_bucket_t *out, size_t n)
+{
+    if (!s_rollup.tier[0].buckets) {
+        history_rollup_read(&s_rollup, res, from, out, n);
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    history_rollup_read(&s_rollup, res, from, out, n);
+    xSemaphoreGive(s_mutex);
+}
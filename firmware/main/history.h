@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "http_client.h"
+#include "history_rollup.h"
+#include "history_store.h"
+
+// In-memory usage history, in PSRAM. Every accepted status is folded into
+// minute/hour/day rollups (history_rollup.h), which the Trend tab charts.
+// Samples thinned to at most one every HISTORY_MIN_SPACING_S go into a
+// compressed block store (history_store.h) holding weeks, which the status
+// server (status_server.h) serves raw, and are logged to flash and replayed
+// by history_init().
+//
+// The HTTP engine task appends; readers on other tasks take a lock only long
+// enough to copy out.
+
+// Allocate the history and restore what the flash log (history_log.h) kept
+// from before the last reboot. Call once at boot, before polling starts.
+void history_init(void);
+
+// Record a status received at time (epoch seconds). Samples are skipped while
+// the clock isn't set yet, or if the previous one is too recent.
+void history_append(const status_data_t *status, uint32_t time);
+
+// Copy up to max samples from the long-horizon store with from <= time <= to
+// into out, oldest first. Returns the number copied; *more is set if samples
+// past the last one copied were left out.
+size_t history_query(uint32_t from, uint32_t to, history_sample_t *out, size_t max, bool *more);
+
+void history_get_store_stats(history_store_stats_t *out);
+
+// Changes every time a status is folded into the rollups.
+uint32_t history_rollup_generation(void);
+
+// Copy the n buckets at resolution res starting at the one containing from.
+void history_read_rollup(history_res_t res, uint32_t from, history_bucket_t *out, size_t n);
@@ -0,0 +1,234 @@
+#include "history_log.h"
+#include "config.h"
+
+// Partition label (see partitions.csv)
+#ifndef HISTORY_LOG_PARTITION
+#define HISTORY_LOG_PARTITION "history"
+#endif
+
+#include <stdbool.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+
+static const char *TAG = "history_log";
+
+#define SECTOR_BYTES        4096
+#define PAGE_BYTES          256
+#define SLOT_BYTES          32
+#define SLOTS_PER_PAGE      (PAGE_BYTES / SLOT_BYTES)
+#define SLOTS_PER_SECTOR    (SECTOR_BYTES / SLOT_BYTES)
+
+#define SECTOR_MAGIC        0x474f4c48u     // "HLOG"
+#define LOG_VERSION         1
+
+// Slot 0 of every sector
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;                   // one more than the previous sector's
+    uint8_t  reserved[16];
+    uint32_t crc;
+} log_header_t;
+
+// Slots 1..127
+typedef struct {
+    history_sample_t sample;
+    uint32_t seq;                   // the sector's, so stray slots never pass
+    uint32_t crc;
+} log_entry_t;
+
+_Static_assert(sizeof(log_header_t) == SLOT_BYTES, "header must fill one slot");
+_Static_assert(sizeof(log_entry_t) == SLOT_BYTES, "entry must fill one slot");
+
+static const esp_partition_t *s_part;
+static uint32_t s_sectors;
+
+// Write position: the page at s_slot of s_sector, being filled in s_page
+static uint32_t s_sector;
+static uint32_t s_seq;              // sequence number of s_sector
+static uint32_t s_slot;             // first slot of the buffered page
+static uint32_t s_fill;             // slots buffered in s_page
+static uint8_t  s_page[PAGE_BYTES];
+
+static history_log_stats_t s_stats;
+
+static uint32_t slot_crc(const void *slot)
+{
+    return esp_rom_crc32_le(0, slot, SLOT_BYTES - sizeof(uint32_t));
+}
+
+static bool header_valid(const log_header_t *h)
+{
+    return h->magic == SECTOR_MAGIC && h->version == LOG_VERSION && h->crc == slot_crc(h);
+}
+
+static bool slot_erased(const uint8_t *slot)
+{
+    for (int i = 0; i < SLOT_BYTES; i++) {
+        if (slot[i] != 0xff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Replay one sector's valid entries; returns the first slot of the page
+// after the last one written (SLOTS_PER_SECTOR if full)
+static uint32_t replay_sector(const uint8_t *sector, uint32_t seq, history_store_cb_t cb, void *ctx)
+{
+    uint32_t end = 1;
+    for (uint32_t i = 1; i < SLOTS_PER_SECTOR; i++) {
+        const uint8_t *slot = sector + i * SLOT_BYTES;
+        if (slot_erased(slot)) {
+            continue;
+        }
+        end = i + 1;
+        log_entry_t e;
+        memcpy(&e, slot, sizeof(e));
+        if (e.seq == seq && e.crc == slot_crc(&e)) {
+            cb(ctx, &e.sample);
+            s_stats.replayed++;
+        }
+    }
+    return (end + SLOTS_PER_PAGE - 1) / SLOTS_PER_PAGE * SLOTS_PER_PAGE;
+}
+
+esp_err_t history_log_open(history_store_cb_t cb, void *ctx)
+{
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                      HISTORY_LOG_PARTITION);
+    if (!s_part) {
+        ESP_LOGW(TAG, "no \"%s\" partition; history is not kept across reboots",
+                 HISTORY_LOG_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_sectors = s_part->size / SECTOR_BYTES;
+    s_stats.sectors = s_sectors;
+    int64_t start = esp_timer_get_time();
+
+    // Newest sector by sequence number
+    bool found = false;
+    uint32_t head = 0, head_seq = 0;
+    for (uint32_t i = 0; i < s_sectors; i++) {
+        log_header_t h;
+        if (esp_partition_read(s_part, i * SECTOR_BYTES, &h, sizeof(h)) != ESP_OK || !header_valid(&h)) {
+            continue;
+        }
+        if (!found || (int32_t)(h.seq - head_seq) > 0) {
+            head = i;
+            head_seq = h.seq;
+            found = true;
+        }
+    }
+
+    s_sector = 0;
+    s_seq = 1;
+    s_slot = 0;
+    s_fill = 0;
+    if (!found) {
+        ESP_LOGI(TAG, "empty log, %u sectors", (unsigned)s_sectors);
+        return ESP_OK;
+    }
+
+    uint8_t *buf = heap_caps_malloc(SECTOR_BYTES, MALLOC_CAP_DEFAULT);
+    if (!buf) {
+        s_part = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Oldest first: the ring runs from the sector after head round to head,
+    // the sector n places after head holding sequence head_seq - (sectors - n).
+    // Anything else is left over from an earlier log and skipped.
+    uint32_t next_slot = SLOTS_PER_SECTOR;
+    for (uint32_t n = 1; n <= s_sectors; n++) {
+        uint32_t i = (head + n) % s_sectors;
+        if (esp_partition_read(s_part, i * SECTOR_BYTES, buf, SECTOR_BYTES) != ESP_OK) {
+            continue;
+        }
+        const log_header_t *h = (const log_header_t *)buf;
+        uint32_t age = head_seq - h->seq;
+        if (!header_valid(h) || age != s_sectors - n) {
+            continue;
+        }
+        uint32_t end = replay_sector(buf, h->seq, cb, ctx);
+        if (i == head) {
+            next_slot = end;
+        }
+    }
+    heap_caps_free(buf);
+
+    // Carry on in the head sector, or open the next one if it's full
+    if (next_slot < SLOTS_PER_SECTOR) {
+        s_sector = head;
+        s_seq = head_seq;
+        s_slot = next_slot;
+    } else {
+        s_sector = (head + 1) % s_sectors;
+        s_seq = head_seq + 1;
+        s_slot = 0;
+    }
+
+    s_stats.replay_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    ESP_LOGI(TAG, "replayed %u samples from %u sectors in %u ms", (unsigned)s_stats.replayed,
+             (unsigned)s_sectors, (unsigned)s_stats.replay_ms);
+    return ESP_OK;
+}
+
+static void write_page(void)
+{
+    size_t offset = s_sector * SECTOR_BYTES + s_slot * SLOT_BYTES;
+    esp_err_t err = esp_partition_write(s_part, offset, s_page, PAGE_BYTES);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "write at 0x%x failed: %s", (unsigned)offset, esp_err_to_name(err));
+    }
+
+    s_fill = 0;
+    s_slot += SLOTS_PER_PAGE;
+    if (s_slot == SLOTS_PER_SECTOR) {
+        s_sector = (s_sector + 1) % s_sectors;
+        s_seq++;
+        s_slot = 0;
+    }
+}
+
+void history_log_append(const history_sample_t *sample)
+{
+    if (!s_part) {
+        return;
+    }
+
+    // New sector: erase it (the oldest) and lead with its header
+    if (s_slot == 0 && s_fill == 0) {
+        esp_err_t err = esp_partition_erase_range(s_part, s_sector * SECTOR_BYTES, SECTOR_BYTES);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "erase of sector %u failed: %s", (unsigned)s_sector, esp_err_to_name(err));
+        }
+        memset(s_page, 0xff, sizeof(s_page));
+        log_header_t h = {.magic = SECTOR_MAGIC, .version = LOG_VERSION, .seq = s_seq};
+        memset(h.reserved, 0xff, sizeof(h.reserved));
+        h.crc = slot_crc(&h);
+        memcpy(s_page, &h, sizeof(h));
+        s_fill = 1;
+    } else if (s_fill == 0) {
+        memset(s_page, 0xff, sizeof(s_page));
+    }
+
+    log_entry_t e = {.sample = *sample, .seq = s_seq};
+    e.crc = slot_crc(&e);
+    memcpy(s_page + s_fill * SLOT_BYTES, &e, sizeof(e));
+    s_fill++;
+    s_stats.written++;
+
+    if (s_fill == SLOTS_PER_PAGE) {
+        write_page();
+    }
+}
+
+void history_log_get_stats(history_log_stats_t *out)
+{
+    *out = s_stats;
+}
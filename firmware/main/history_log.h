@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "history_store.h"
+
+// Append-only log of history samples in the "history" flash partition, so
+// history survives a reboot.
+//
+// The partition is a ring of 4 KB sectors written in order and erased one at
+// a time just before reuse, so every sector wears at the same rate. Each
+// sector starts with a header carrying a sequence number; samples follow in
+// 32-byte slots with their own CRC. Samples are buffered in RAM and written a
+// whole 256-byte flash page (8 slots) at a time, so a crash or power cut
+// loses at most the last few unwritten samples; a torn page or an erase cut
+// short fails its CRCs and is skipped on replay.
+//
+// Called from the HTTP engine task only (and once at boot before it starts).
+
+typedef struct {
+    uint32_t sectors;           // sectors in the partition (0 = no log)
+    uint32_t replayed;          // samples restored at boot
+    uint32_t replay_ms;         // time the boot replay took
+    uint32_t written;           // samples written to flash since boot
+} history_log_stats_t;
+
+// Find the partition, replay every sample it holds to cb (oldest first) and
+// position the log for appending. ESP_ERR_NOT_FOUND without a partition.
+esp_err_t history_log_open(history_store_cb_t cb, void *ctx);
+
+// Buffer a sample; writes the page out once it fills.
+void history_log_append(const history_sample_t *sample);
+
+void history_log_get_stats(history_log_stats_t *out);
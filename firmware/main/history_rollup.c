@@ -0,0 +1,108 @@
+#include "history_rollup.h"
+
+#include <string.h>
+#include "esp_heap_caps.h"
+
+static const uint32_t s_periods[HISTORY_RESOLUTIONS] = {
+    [HISTORY_RES_MINUTE] = 60,
+    [HISTORY_RES_HOUR]   = 3600,
+    [HISTORY_RES_DAY]    = 86400,
+};
+
+uint32_t history_rollup_period(history_res_t res)
+{
+    return s_periods[res];
+}
+
+esp_err_t history_rollup_init(history_rollup_t *r, const uint32_t capacity[HISTORY_RESOLUTIONS])
+{
+    memset(r, 0, sizeof(*r));
+    for (int i = 0; i < HISTORY_RESOLUTIONS; i++) {
+        history_rollup_tier_t *t = &r->tier[i];
+        t->period = s_periods[i];
+        t->capacity = capacity[i];
+        t->buckets = heap_caps_calloc(capacity[i], sizeof(history_bucket_t),
+                                      MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!t->buckets) {
+            history_rollup_free(r);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+void history_rollup_free(history_rollup_t *r)
+{
+    for (int i = 0; i < HISTORY_RESOLUTIONS; i++) {
+        heap_caps_free(r->tier[i].buckets);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+static void agg_first(history_agg_t *a, float v)
+{
+    a->min = a->max = a->sum = a->last = v;
+}
+
+static void agg_fold(history_agg_t *a, float v)
+{
+    if (v < a->min) a->min = v;
+    if (v > a->max) a->max = v;
+    a->sum += v;
+    a->last = v;
+}
+
+static void fold(history_rollup_tier_t *t, const history_sample_t *s)
+{
+    uint32_t start = s->time - s->time % t->period;
+    history_bucket_t *b = &t->buckets[(s->time / t->period) % t->capacity];
+
+    if (b->count && b->start == start) {
+        agg_fold(&b->session, s->session);
+        agg_fold(&b->weekly_all, s->weekly_all);
+        agg_fold(&b->weekly_sonnet, s->weekly_sonnet);
+        agg_fold(&b->burn_cost_per_hour, s->burn_cost_per_hour);
+        agg_fold(&b->session_cost_usd, s->session_cost_usd);
+        b->count++;
+        return;
+    }
+    // The slot holds a newer bucket: the clock stepped back past the horizon
+    if (b->count && b->start > start) {
+        return;
+    }
+    b->start = start;
+    b->count = 1;
+    agg_first(&b->session, s->session);
+    agg_first(&b->weekly_all, s->weekly_all);
+    agg_first(&b->weekly_sonnet, s->weekly_sonnet);
+    agg_first(&b->burn_cost_per_hour, s->burn_cost_per_hour);
+    agg_first(&b->session_cost_usd, s->session_cost_usd);
+}
+
+void history_rollup_add(history_rollup_t *r, const history_sample_t *sample)
+{
+    if (!r->tier[0].buckets) {
+        return;
+    }
+    for (int i = 0; i < HISTORY_RESOLUTIONS; i++) {
+        fold(&r->tier[i], sample);
+    }
+}
+
+void history_rollup_read(const history_rollup_t *r, history_res_t res, uint32_t from,
+                         history_bucket_t *out, size_t n)
+{
+    // An unallocated tier reads as empty
+    const history_rollup_tier_t *t = &r->tier[res];
+    uint32_t period = s_periods[res];
+    uint32_t start = from - from % period;
+    for (size_t i = 0; i < n; i++, start += period) {
+        const history_bucket_t *b = t->buckets ? &t->buckets[(start / period) % t->capacity] : NULL;
+        if (b && b->count && b->start == start) {
+            out[i] = *b;
+        } else {
+            memset(&out[i], 0, sizeof(out[i]));
+            out[i].start = start;
+        }
+    }
+}
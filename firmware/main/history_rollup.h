@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "history_store.h"
+
+// Incremental rollups: every sample is folded into one bucket per
+// resolution (minute, hour, day), each keeping min/max/sum/last per value.
+// A tier is a ring addressed directly by bucket number (time / period), so
+// reading the buckets behind n chart points costs O(n) whatever the sample
+// rate, and each tier keeps its own horizon: coarse aggregates outlive the
+// raw samples and finer tiers.
+//
+// Not thread-safe; the owner serialises access.
+
+typedef enum {
+    HISTORY_RES_MINUTE,
+    HISTORY_RES_HOUR,
+    HISTORY_RES_DAY,
+    HISTORY_RESOLUTIONS,
+} history_res_t;
+
+typedef struct {
+    float min;
+    float max;
+    float sum;                      // avg = sum / count
+    float last;
+} history_agg_t;
+
+typedef struct {
+    uint32_t start;                 // epoch seconds, multiple of the period
+    uint32_t count;                 // samples folded in (0 = no data)
+    history_agg_t session;
+    history_agg_t weekly_all;
+    history_agg_t weekly_sonnet;
+    history_agg_t burn_cost_per_hour;
+    history_agg_t session_cost_usd;
+} history_bucket_t;
+
+typedef struct {
+    uint32_t period;                // seconds per bucket
+    uint32_t capacity;              // buckets kept
+    history_bucket_t *buckets;
+} history_rollup_tier_t;
+
+typedef struct {
+    history_rollup_tier_t tier[HISTORY_RESOLUTIONS];
+} history_rollup_t;
+
+// Allocate the tiers (PSRAM where available) with the given bucket counts.
+esp_err_t history_rollup_init(history_rollup_t *r, const uint32_t capacity[HISTORY_RESOLUTIONS]);
+void history_rollup_free(history_rollup_t *r);
+
+uint32_t history_rollup_period(history_res_t res);
+
+void history_rollup_add(history_rollup_t *r, const history_sample_t *sample);
+
+// Copy the n buckets starting at the one containing from into out (one per
+// period; count = 0 where there is no data or it has aged out).
+void history_rollup_read(const history_rollup_t *r, history_res_t res, uint32_t from,
+                         history_bucket_t *out, size_t n);
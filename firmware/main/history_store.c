@@ -0,0 +1,306 @@
+#include "history_store.h"
+
+#include <string.h>
+#include "esp_heap_caps.h"
+
+// Times are stored relative to 2024-01-01 so they fit an int32 well past 2038
+#define TIME_BASE   1704067200
+#define MAX_VARINT  10
+
+static int32_t to_fixed(float x)
+{
+    // Two decimals; clamp what can't be a real reading rather than overflow
+    if (!(x > -2e7f)) return -2000000000;
+    if (x > 2e7f) return 2000000000;
+    x *= 100.0f;
+    return (int32_t)(x < 0 ? x - 0.5f : x + 0.5f);
+}
+
+static void sample_to_fixed(const history_sample_t *s, int32_t v[HISTORY_COLUMNS])
+{
+    v[HISTORY_COL_TIME] = (int32_t)((int64_t)s->time - TIME_BASE);
+    v[HISTORY_COL_SESSION] = to_fixed(s->session);
+    v[HISTORY_COL_WEEKLY_ALL] = to_fixed(s->weekly_all);
+    v[HISTORY_COL_WEEKLY_SONNET] = to_fixed(s->weekly_sonnet);
+    v[HISTORY_COL_BURN] = to_fixed(s->burn_cost_per_hour);
+    v[HISTORY_COL_COST] = to_fixed(s->session_cost_usd);
+}
+
+static void sample_from_fixed(const int32_t v[HISTORY_COLUMNS], history_sample_t *s)
+{
+    s->time = (uint32_t)((int64_t)v[HISTORY_COL_TIME] + TIME_BASE);
+    s->session = v[HISTORY_COL_SESSION] / 100.0f;
+    s->weekly_all = v[HISTORY_COL_WEEKLY_ALL] / 100.0f;
+    s->weekly_sonnet = v[HISTORY_COL_WEEKLY_SONNET] / 100.0f;
+    s->burn_cost_per_hour = v[HISTORY_COL_BURN] / 100.0f;
+    s->session_cost_usd = v[HISTORY_COL_COST] / 100.0f;
+}
+
+static int32_t time_key(uint32_t t)
+{
+    int64_t k = (int64_t)t - TIME_BASE;
+    return k > INT32_MAX ? INT32_MAX : (int32_t)k;
+}
+
+// Zigzag varint: small deltas of either sign take one byte
+static size_t put_varint(uint8_t *p, int64_t delta)
+{
+    uint64_t z = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+    size_t n = 0;
+    while (z >= 0x80) {
+        p[n++] = (uint8_t)z | 0x80;
+        z >>= 7;
+    }
+    p[n++] = (uint8_t)z;
+    return n;
+}
+
+static int64_t get_varint(const uint8_t **pp)
+{
+    const uint8_t *p = *pp;
+    uint64_t z = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+        b = *p++;
+        z |= (uint64_t)(b & 0x7f) << shift;
+        shift += 7;
+    } while ((b & 0x80) && shift < 64);
+    *pp = p;
+    return (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+}
+
+esp_err_t history_store_init(history_store_t *st, uint32_t nblocks)
+{
+    memset(st, 0, sizeof(*st));
+    st->blocks = heap_caps_malloc((size_t)nblocks * HISTORY_BLOCK_BYTES,
+                                  MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    st->staging = heap_caps_malloc(HISTORY_COLUMNS * HISTORY_BLOCK_PAYLOAD,
+                                   MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!st->blocks || !st->staging) {
+        history_store_free(st);
+        return ESP_ERR_NO_MEM;
+    }
+    st->nblocks = nblocks;
+    return ESP_OK;
+}
+
+void history_store_free(history_store_t *st)
+{
+    heap_caps_free(st->blocks);
+    heap_caps_free(st->staging);
+    memset(st, 0, sizeof(*st));
+}
+
+static const history_block_header_t *block_header(const history_store_t *st, uint32_t n)
+{
+    return (const history_block_header_t *)(st->blocks + (size_t)(n % st->nblocks) * HISTORY_BLOCK_BYTES);
+}
+
+static size_t open_bytes(const history_block_header_t *h)
+{
+    size_t used = 0;
+    for (int c = 0; c < HISTORY_COLUMNS; c++) {
+        used += h->col_len[c];
+    }
+    return used;
+}
+
+// Copy the open block into the ring, columns back to back after the header
+static void seal(history_store_t *st)
+{
+    uint8_t *dst = st->blocks + (size_t)(st->sealed % st->nblocks) * HISTORY_BLOCK_BYTES;
+    memcpy(dst, &st->open, sizeof(st->open));
+    size_t off = sizeof(st->open);
+    for (int c = 0; c < HISTORY_COLUMNS; c++) {
+        memcpy(dst + off, st->staging + c * HISTORY_BLOCK_PAYLOAD, st->open.col_len[c]);
+        off += st->open.col_len[c];
+    }
+    st->sealed++;
+    st->open.count = 0;
+}
+
+void history_store_append(history_store_t *st, const history_sample_t *sample)
+{
+    if (!st->blocks) {
+        return;
+    }
+    int32_t v[HISTORY_COLUMNS];
+    sample_to_fixed(sample, v);
+
+    history_block_header_t *h = &st->open;
+    if (h->count > 0 && (open_bytes(h) + HISTORY_COLUMNS * MAX_VARINT > HISTORY_BLOCK_PAYLOAD ||
+                         h->count == UINT16_MAX)) {
+        seal(st);
+    }
+
+    if (h->count == 0) {
+        memset(h->col_len, 0, sizeof(h->col_len));
+        memcpy(h->first, v, sizeof(v));
+        memcpy(h->min, v, sizeof(v));
+        memcpy(h->max, v, sizeof(v));
+    } else {
+        for (int c = 0; c < HISTORY_COLUMNS; c++) {
+            uint8_t *col = st->staging + c * HISTORY_BLOCK_PAYLOAD;
+            h->col_len[c] += put_varint(col + h->col_len[c], (int64_t)v[c] - st->prev[c]);
+            if (v[c] < h->min[c]) h->min[c] = v[c];
+            if (v[c] > h->max[c]) h->max[c] = v[c];
+        }
+    }
+    h->count++;
+    memcpy(st->prev, v, sizeof(v));
+}
+
+// Decode one block, row by row with a cursor per column stream, passing at
+// most limit samples to cb
+static size_t decode_block(const history_block_header_t *h, const uint8_t *cols[HISTORY_COLUMNS],
+                           int32_t from, int32_t to, size_t limit, history_store_cb_t cb, void *ctx)
+{
+    int32_t v[HISTORY_COLUMNS];
+    memcpy(v, h->first, sizeof(v));
+    size_t n = 0;
+    for (uint16_t i = 0; i < h->count && n < limit; i++) {
+        if (i > 0) {
+            for (int c = 0; c < HISTORY_COLUMNS; c++) {
+                v[c] = (int32_t)(v[c] + get_varint(&cols[c]));
+            }
+        }
+        if (v[HISTORY_COL_TIME] >= from && v[HISTORY_COL_TIME] <= to) {
+            history_sample_t s;
+            sample_from_fixed(v, &s);
+            cb(ctx, &s);
+            n++;
+        }
+    }
+    return n;
+}
+
+static bool overlaps(const history_block_header_t *h, int32_t from, int32_t to)
+{
+    return h->count > 0 && h->max[HISTORY_COL_TIME] >= from && h->min[HISTORY_COL_TIME] <= to;
+}
+
+static size_t query_fixed(const history_store_t *st, int32_t from, int32_t to, size_t limit,
+                          history_store_cb_t cb, void *ctx)
+{
+    if (!st->blocks) {
+        return 0;
+    }
+    size_t n = 0;
+    const uint8_t *cols[HISTORY_COLUMNS];
+
+    uint32_t oldest = st->sealed > st->nblocks ? st->sealed - st->nblocks : 0;
+    for (uint32_t b = oldest; b < st->sealed && n < limit; b++) {
+        const history_block_header_t *h = block_header(st, b);
+        if (!overlaps(h, from, to)) {
+            continue;
+        }
+        const uint8_t *p = (const uint8_t *)h + sizeof(*h);
+        for (int c = 0; c < HISTORY_COLUMNS; c++) {
+            cols[c] = p;
+            p += h->col_len[c];
+        }
+        n += decode_block(h, cols, from, to, limit - n, cb, ctx);
+    }
+
+    if (n < limit && overlaps(&st->open, from, to)) {
+        for (int c = 0; c < HISTORY_COLUMNS; c++) {
+            cols[c] = st->staging + c * HISTORY_BLOCK_PAYLOAD;
+        }
+        n += decode_block(&st->open, cols, from, to, limit - n, cb, ctx);
+    }
+    return n;
+}
+
+size_t history_store_query(const history_store_t *st, uint32_t from, uint32_t to,
+                           history_store_cb_t cb, void *ctx)
+{
+    return query_fixed(st, time_key(from), time_key(to), SIZE_MAX, cb, ctx);
+}
+
+size_t history_store_query_n(const history_store_t *st, uint32_t from, uint32_t to, size_t limit,
+                             history_store_cb_t cb, void *ctx)
+{
+    return query_fixed(st, time_key(from), time_key(to), limit, cb, ctx);
+}
+
+typedef struct {
+    history_column_t col;
+    bool    found;
+    int32_t max;
+} max_ctx_t;
+
+static void max_cb(void *ctx, const history_sample_t *s)
+{
+    max_ctx_t *m = ctx;
+    int32_t v[HISTORY_COLUMNS];
+    sample_to_fixed(s, v);
+    if (!m->found || v[m->col] > m->max) {
+        m->max = v[m->col];
+        m->found = true;
+    }
+}
+
+bool history_store_max(const history_store_t *st, uint32_t from, uint32_t to,
+                       history_column_t col, float *out)
+{
+    if (!st->blocks || col == HISTORY_COL_TIME) {
+        return false;
+    }
+    int32_t lo = time_key(from), hi = time_key(to);
+    max_ctx_t m = {.col = col};
+
+    uint32_t oldest = st->sealed > st->nblocks ? st->sealed - st->nblocks : 0;
+    for (uint32_t b = oldest; b < st->sealed; b++) {
+        const history_block_header_t *h = block_header(st, b);
+        if (!overlaps(h, lo, hi)) {
+            continue;
+        }
+        if (h->min[HISTORY_COL_TIME] >= lo && h->max[HISTORY_COL_TIME] <= hi) {
+            // Whole block in range: its header already knows
+            if (!m.found || h->max[col] > m.max) {
+                m.max = h->max[col];
+                m.found = true;
+            }
+            continue;
+        }
+        const uint8_t *cols[HISTORY_COLUMNS];
+        const uint8_t *p = (const uint8_t *)h + sizeof(*h);
+        for (int c = 0; c < HISTORY_COLUMNS; c++) {
+            cols[c] = p;
+            p += h->col_len[c];
+        }
+        decode_block(h, cols, lo, hi, SIZE_MAX, max_cb, &m);
+    }
+    if (overlaps(&st->open, lo, hi)) {
+        const uint8_t *cols[HISTORY_COLUMNS];
+        for (int c = 0; c < HISTORY_COLUMNS; c++) {
+            cols[c] = st->staging + c * HISTORY_BLOCK_PAYLOAD;
+        }
+        decode_block(&st->open, cols, lo, hi, SIZE_MAX, max_cb, &m);
+    }
+
+    if (m.found) {
+        *out = m.max / 100.0f;
+    }
+    return m.found;
+}
+
+void history_store_get_stats(const history_store_t *st, history_store_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!st->blocks) {
+        return;
+    }
+    uint32_t oldest = st->sealed > st->nblocks ? st->sealed - st->nblocks : 0;
+    for (uint32_t b = oldest; b < st->sealed; b++) {
+        const history_block_header_t *h = block_header(st, b);
+        out->samples += h->count;
+        out->bytes += sizeof(*h) + open_bytes(h);
+        out->blocks++;
+    }
+    if (st->open.count) {
+        out->samples += st->open.count;
+        out->bytes += sizeof(st->open) + open_bytes(&st->open);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Compact long-horizon history: samples are stored in fixed-point (basis
+// points for utilisation, cents for money), delta-encoded against the
+// previous sample and packed as zigzag varints. Storage is a ring of
+// fixed-size blocks, each holding one varint stream per column plus a header
+// with the block's first sample and per-column min/max. Range queries skip
+// blocks by their header alone; only overlapping blocks are decoded.
+//
+// Precision: 0.01 % for utilisation, 1 cent for cost and burn rate.
+// Not thread-safe; the owner serialises access.
+
+#define HISTORY_BLOCK_BYTES 1024
+
+typedef struct {
+    uint32_t time;                  // epoch seconds
+    float    session;               // utilisation, percent
+    float    weekly_all;
+    float    weekly_sonnet;
+    float    burn_cost_per_hour;
+    float    session_cost_usd;
+} history_sample_t;
+
+// Columns, in storage order (time is column 0)
+typedef enum {
+    HISTORY_COL_TIME,
+    HISTORY_COL_SESSION,
+    HISTORY_COL_WEEKLY_ALL,
+    HISTORY_COL_WEEKLY_SONNET,
+    HISTORY_COL_BURN,
+    HISTORY_COL_COST,
+    HISTORY_COLUMNS,
+} history_column_t;
+
+typedef struct {
+    uint16_t count;                        // samples in the block
+    uint16_t col_len[HISTORY_COLUMNS];     // varint bytes per column, in order
+    int32_t  first[HISTORY_COLUMNS];       // first sample, fixed-point
+    int32_t  min[HISTORY_COLUMNS];
+    int32_t  max[HISTORY_COLUMNS];
+} history_block_header_t;
+
+#define HISTORY_BLOCK_PAYLOAD (HISTORY_BLOCK_BYTES - sizeof(history_block_header_t))
+
+typedef struct {
+    uint8_t *blocks;        // nblocks sealed blocks, a ring indexed by sealed % nblocks
+    uint32_t nblocks;
+    uint32_t sealed;        // blocks sealed so far (older ones are overwritten)
+
+    // Block being filled: header plus one staging stream per column
+    history_block_header_t open;
+    uint8_t *staging;       // HISTORY_COLUMNS * HISTORY_BLOCK_PAYLOAD
+    int32_t  prev[HISTORY_COLUMNS];
+} history_store_t;
+
+typedef struct {
+    uint32_t samples;       // samples currently held
+    uint32_t blocks;        // sealed blocks currently held
+    uint32_t bytes;         // bytes in use (sealed blocks + open block)
+} history_store_stats_t;
+
+typedef void (*history_store_cb_t)(void *ctx, const history_sample_t *sample);
+
+// Allocate nblocks blocks (PSRAM where available).
+esp_err_t history_store_init(history_store_t *st, uint32_t nblocks);
+void history_store_free(history_store_t *st);
+
+void history_store_append(history_store_t *st, const history_sample_t *sample);
+
+// Pass every sample with from <= time <= to to cb, oldest first.
+// Returns the number of samples passed.
+size_t history_store_query(const history_store_t *st, uint32_t from, uint32_t to,
+                           history_store_cb_t cb, void *ctx);
+
+// The same, stopping after the first limit samples (and the blocks they need).
+size_t history_store_query_n(const history_store_t *st, uint32_t from, uint32_t to, size_t limit,
+                             history_store_cb_t cb, void *ctx);
+
+// Highest value of col over [from, to]. Blocks inside the range answer from
+// their header; only blocks straddling an end are decoded. False if empty.
+bool history_store_max(const history_store_t *st, uint32_t from, uint32_t to,
+                       history_column_t col, float *out);
+
+void history_store_get_stats(const history_store_t *st, history_store_stats_t *out);
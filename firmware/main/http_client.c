@@ -7,35 +7,240 @@
 #define API_TOKEN ""
 #endif
 
+// CA certificate for https:// server URLs; without one the built-in CA
+// bundle is used
+#ifndef SERVER_CERT_PEM
+#define SERVER_CERT_PEM NULL
+#endif
+
+// Every CCU instance to poll (see config.h.example); just SERVER_URL unless
+// a list is configured
+#ifndef SERVER_URLS
+#define SERVER_URLS { SERVER_URL }
+#endif
+
+// Push mode defaults (see config.h.example)
+#ifndef STREAM_ENABLED
+#define STREAM_ENABLED 0
+#endif
+#ifndef API_STREAM_PATH
+#define API_STREAM_PATH "/api/events"
+#endif
+#ifndef STREAM_IDLE_MS
+#define STREAM_IDLE_MS 60000
+#endif
+#ifndef STREAM_RETRY_MS
+#define STREAM_RETRY_MS 300000
+#endif
+
+// Save the status for the next boot at most this often (see config.h.example)
+#ifndef STATUS_CACHE_INTERVAL_S
+#define STATUS_CACHE_INTERVAL_S 600
+#endif
+
+// Longest a request may take, connect to last byte (and the longest an event
+// stream may take to open)
+#define REQUEST_TIMEOUT_MS 10000
+
+// While an event stream is up, this often check whether it should still be
+#define STREAM_CHECK_MS 1000
+
+#include <stdatomic.h>
+#include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 #include "esp_http_client.h"
 #include "esp_log.h"
-#include "cJSON.h"
+#include "esp_timer.h"
+#include "body_decoder.h"
+#include "boot_timeline.h"
+#include "history.h"
+#include "http_conn.h"
+#include "http_engine.h"
+#include "poll_scheduler.h"
+#include "status_aggregate.h"
+#include "status_parser.h"
+#include "sse_parser.h"
+#include "status_cache.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
 
 static const char *TAG = "http_client";
 
-#define HTTP_BUF_SIZE 4096
-
-static status_data_t s_status = {0};
-static status_data_t s_status_copy = {0};
-static SemaphoreHandle_t s_status_mutex;
-static bool s_got_first_response = false;
-static time_t s_last_success_time = 0;
+static const char *const s_server_urls[] = SERVER_URLS;
+#define ENDPOINT_COUNT (sizeof(s_server_urls) / sizeof(s_server_urls[0]))
+_Static_assert(ENDPOINT_COUNT >= 1 && ENDPOINT_COUNT <= MAX_ENDPOINTS,
+               "SERVER_URLS must list 1 to MAX_ENDPOINTS servers");
+
+// A status guarded by a sequence lock: its one writer makes seq odd while it
+// copies a new status in and even again after. Readers copy without locking
+// and retry if the sequence moved, so the writer never waits on them.
+// seq / 2 is the status generation.
+typedef struct {
+    status_data_t status;
+    atomic_uint   seq;
+} status_slot_t;
+
+// One CCU instance. Its requests run on the HTTP engine task (http_engine.h)
+// alongside every other server's, so a slow or dead one only delays itself.
+// Everything here belongs to that task; the snapshot, stats and flags are
+// read (without locking) by the UI and the aggregation.
+typedef struct {
+    const char *url;
+    char name[32];                  // host[:port] of the URL
+
+    http_conn_t conn;
+    http_request_t fetch;
+    http_timer_t timer;             // next poll (or stream check)
+    http_timer_t refresh;           // posted by http_client_refresh()
+    bool refresh_waiting;           // the fetch in flight answers a refresh
+    poll_scheduler_t schedule;
+
+    // Response body is parsed as it streams in
+    status_parser_t parser;
+    status_data_t parsed;
+
+    // Undoes any Content-Encoding before the parser sees the body
+    body_decoder_t body;
+    uint32_t body_truncated;
+    uint32_t body_clipped;
+
+    // Cache validators. The pending ones come from the response in flight and
+    // are only adopted once its body has parsed, so a bad body is never
+    // pinned by 304s.
+    char etag[64];
+    char last_modified[32];
+    char pending_etag[64];
+    char pending_last_modified[32];
+
+    // Push mode: a long-lived request on its own connection, carrying status
+    // events that are parsed as they arrive
+    http_conn_t stream_conn;
+    http_request_t stream;
+    bool stream_available;
+    volatile bool streaming;
+    int64_t stream_retry_at_us;
+    sse_parser_t sse;
+
+    bool got_first_response;
+    bool in_totals;                         // counted in the published status
+    volatile bool failing;                  // the last poll failed
+    volatile uint32_t last_success_time;    // epoch seconds, 0 = never
+    volatile TickType_t last_success_tick;  // the same on the tick clock, which
+                                            // SNTP doesn't move
+
+    status_slot_t snapshot;         // last status this server sent
+} endpoint_t;
+
+static endpoint_t s_endpoints[ENDPOINT_COUNT];
+
+// Published status: the endpoints' snapshots combined (status_aggregate.h).
+// Publishers take s_publish_mutex (the bench publishes from its own task);
+// readers only follow the sequence lock.
+static status_slot_t s_published;
+static SemaphoreHandle_t s_publish_mutex;
 static bool s_polling_paused = false;
-static char s_http_buf[HTTP_BUF_SIZE];
-static int s_http_buf_len = 0;
+static atomic_bool s_started;       // timers are set up, so an address may post them
+static volatile bool s_status_cached = false;
+static uint32_t s_cache_saved_at = 0;
+static void (*s_on_status)(void);
+
+// Latest success of any endpoint, read without locking: a 304 refreshes it
+// without touching the status. One 32-bit word (epoch seconds) so reads can't tear.
+static volatile uint32_t s_last_success_time = 0;
+
+// On-demand refresh. s_refresh_active hands the rest over: the requesting
+// task sets it and the start time, the engine task counts the servers down
+// and publishes the result before clearing it.
+static atomic_bool s_refresh_active;
+static int64_t s_refresh_started_us;
+static size_t s_refresh_pending;
+static bool s_refresh_failed;
+static volatile uint32_t s_refresh_completed;
+static volatile uint32_t s_refresh_rtt_ms;
+static volatile bool s_refresh_ok;
+
+// The server answered (a status, a 304, or stream traffic)
+static void note_success(endpoint_t *ep)
+{
+    uint32_t now = (uint32_t)time(NULL);
+    ep->last_success_time = now;
+    ep->last_success_tick = xTaskGetTickCount();
+    s_last_success_time = now;
+}
+
+static void slot_write(status_slot_t *slot, const status_data_t *status, uint32_t received_at)
+{
+    unsigned seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->status = *status;
+    slot->status.received_at = received_at;
+    slot->status.valid = true;
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+}
+
+// Copy the slot's status into *out if its generation differs from
+// *generation; false (leaving *out untouched) when it doesn't
+static bool slot_read(status_slot_t *slot, status_data_t *out, uint32_t *generation)
+{
+    for (;;) {
+        unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq / 2 == *generation && !(seq & 1)) {
+            return false;
+        }
+        if (seq & 1) {
+            // Mid-update; the writer may be preempted by us, so let it run
+            vTaskDelay(1);
+            continue;
+        }
+        *out = slot->status;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq) {
+            *generation = seq / 2;
+            return true;
+        }
+    }
+}
+
+static void parser_sink(void *ctx, const char *data, size_t len)
+{
+    endpoint_t *ep = ctx;
+    status_parser_feed(&ep->parser, data, len);
+}
 
 static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 {
+    endpoint_t *ep = evt->user_data;
+
     switch (evt->event_id) {
+    case HTTP_EVENT_HEADERS_SENT:
+        // Start of a request attempt (also after a transparent reconnect)
+        status_parser_init(&ep->parser, &ep->parsed);
+        body_decoder_begin(&ep->body, NULL);
+        ep->pending_etag[0] = '\0';
+        ep->pending_last_modified[0] = '\0';
+        break;
+    case HTTP_EVENT_ON_HEADER:
+        if (strcasecmp(evt->header_key, "Content-Type") == 0 &&
+            strncasecmp(evt->header_value, "application/cbor", 16) == 0) {
+            // The server took us up on Accept; anything else is parsed as JSON
+            status_parser_use_cbor(&ep->parser);
+        } else if (strcasecmp(evt->header_key, "Content-Encoding") == 0) {
+            body_decoder_begin(&ep->body, evt->header_value);
+        } else if (strcasecmp(evt->header_key, "ETag") == 0) {
+            snprintf(ep->pending_etag, sizeof(ep->pending_etag), "%s", evt->header_value);
+        } else if (strcasecmp(evt->header_key, "Last-Modified") == 0) {
+            snprintf(ep->pending_last_modified, sizeof(ep->pending_last_modified), "%s",
+                     evt->header_value);
+        }
+        break;
     case HTTP_EVENT_ON_DATA:
-        if (s_http_buf_len + evt->data_len < HTTP_BUF_SIZE - 1) {
-            memcpy(s_http_buf + s_http_buf_len, evt->data, evt->data_len);
-            s_http_buf_len += evt->data_len;
+        // Error bodies are not status documents; don't feed them to the parser
+        if (http_conn_status_code(&ep->conn) == 200) {
+            body_decoder_feed(&ep->body, evt->data, evt->data_len, parser_sink, ep);
         }
         break;
     default:
@@ -44,239 +249,555 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
-// Parse a usage tier from a JSON object with utilisation_pct, resets_at, resets_in_seconds
-static void parse_tier(cJSON *obj, usage_tier_t *tier)
+// Fields the status struct couldn't hold are dropped, not fatal; count them
+// (and warn once, as the same document shape repeats every poll)
+static void note_clipped(endpoint_t *ep)
 {
-    if (!obj || cJSON_IsNull(obj)) {
-        tier->present = false;
-        return;
+    if (ep->parser.clipped) {
+        if (ep->body_clipped == 0) {
+            ESP_LOGW(TAG, "%s: %u value(s) clipped to fit", ep->name, (unsigned)ep->parser.clipped);
+        }
+        ep->body_clipped += ep->parser.clipped;
     }
-    tier->present = true;
+}
 
-    cJSON *util = cJSON_GetObjectItem(obj, "utilisation_pct");
-    if (cJSON_IsNumber(util)) {
-        tier->utilisation = (float)util->valuedouble;
+static bool endpoint_stale(const endpoint_t *ep, TickType_t tick)
+{
+    return !ep->got_first_response ||
+           tick - ep->last_success_tick > pdMS_TO_TICKS(STALE_DATA_SECONDS * 1000u);
+}
+
+// Combine the snapshots of the endpoints that are still answering and publish
+// the result. Endpoints silent for STALE_DATA_SECONDS drop out of the totals.
+static void publish_aggregate(uint32_t now)
+{
+    static status_data_t snapshots[ENDPOINT_COUNT];
+    static status_data_t combined;
+    const status_data_t *live[ENDPOINT_COUNT];
+    size_t n = 0;
+
+    xSemaphoreTake(s_publish_mutex, portMAX_DELAY);
+    TickType_t tick = xTaskGetTickCount();
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        endpoint_t *ep = &s_endpoints[i];
+        uint32_t generation = 0;
+        ep->in_totals = !endpoint_stale(ep, tick) &&
+                        slot_read(&ep->snapshot, &snapshots[n], &generation);
+        if (ep->in_totals) {
+            live[n] = &snapshots[n];
+            n++;
+        }
     }
+    if (n == 0) {
+        xSemaphoreGive(s_publish_mutex);
+        return;
+    }
+    status_aggregate(live, n, &combined);
 
-    cJSON *resets = cJSON_GetObjectItem(obj, "resets_at");
-    if (cJSON_IsString(resets) && resets->valuestring) {
-        strncpy(tier->resets_at, resets->valuestring, sizeof(tier->resets_at) - 1);
+    slot_write(&s_published, &combined, now);
+    s_status_cached = false;
+    boot_timeline_mark(BOOT_FIRST_RESPONSE);
+    if (s_on_status) {
+        s_on_status();
     }
+    history_append(&combined, now);
 
-    cJSON *secs = cJSON_GetObjectItem(obj, "resets_in_seconds");
-    if (cJSON_IsNumber(secs)) {
-        tier->resets_in_seconds = (int64_t)secs->valuedouble;
+    // Keep a recent copy for the next boot; NVS wear rules out every poll
+    if (s_cache_saved_at == 0 || now - s_cache_saved_at >= STATUS_CACHE_INTERVAL_S) {
+        if (status_cache_save(&s_published.status) == ESP_OK) {
+            s_cache_saved_at = now;
+        }
     }
+    xSemaphoreGive(s_publish_mutex);
 }
 
-static void parse_status_response(const char *json_str)
+// Publish the totals again without any endpoint that has gone quiet since the
+// last time. Nothing else would: the rest may only be answering 304s.
+static void drop_stale_endpoints(void)
 {
-    cJSON *root = cJSON_Parse(json_str);
-    if (!root) {
-        ESP_LOGW(TAG, "JSON parse failed");
-        return;
+    TickType_t tick = xTaskGetTickCount();
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        if (s_endpoints[i].in_totals && endpoint_stale(&s_endpoints[i], tick)) {
+            ESP_LOGW(TAG, "%s: silent for %us, dropped from the totals", s_endpoints[i].name,
+                     (unsigned)STALE_DATA_SECONDS);
+            publish_aggregate((uint32_t)time(NULL));
+            return;
+        }
     }
+}
 
-    status_data_t new_status = {0};
-    new_status.valid = true;
+// Take a freshly parsed status from an endpoint and publish the new totals
+static void store_status(endpoint_t *ep, const status_data_t *new_status)
+{
+    uint32_t now = (uint32_t)time(NULL);
+    slot_write(&ep->snapshot, new_status, now);
+    note_success(ep);
+    ep->got_first_response = true;
 
-    // Parse session (5-hour)
-    cJSON *session = cJSON_GetObjectItem(root, "session");
-    if (session && !cJSON_IsNull(session)) {
-        parse_tier(session, &new_status.session);
+    ESP_LOGI(TAG, "%s: session=%.0f%% weekly=%.0f%% burn=$%.1f/hr", ep->name,
+             new_status->session.utilisation,
+             new_status->weekly_all.utilisation,
+             new_status->burn_cost_per_hour);
 
-        cJSON *cost = cJSON_GetObjectItem(session, "cost_usd");
-        if (cJSON_IsNumber(cost)) {
-            new_status.session_cost_usd = (float)cost->valuedouble;
-        }
+    publish_aggregate(now);
+}
 
-        cJSON *msgs = cJSON_GetObjectItem(session, "message_count");
-        if (cJSON_IsNumber(msgs)) {
-            new_status.session_message_count = (int)msgs->valuedouble;
-        }
+// Remember the validators of a response we accepted and send them on every
+// following poll, so an unchanged status costs a 304 with no body.
+static void adopt_validators(endpoint_t *ep)
+{
+    if (strcmp(ep->etag, ep->pending_etag) == 0 &&
+        strcmp(ep->last_modified, ep->pending_last_modified) == 0) {
+        return;
+    }
+    memcpy(ep->etag, ep->pending_etag, sizeof(ep->etag));
+    memcpy(ep->last_modified, ep->pending_last_modified, sizeof(ep->last_modified));
 
-        cJSON *rem_secs = cJSON_GetObjectItem(session, "remaining_seconds");
-        if (cJSON_IsNumber(rem_secs)) {
-            new_status.session_remaining_seconds = (int64_t)rem_secs->valuedouble;
-        }
+    // ETag is the stronger validator; only fall back to the date without one
+    http_conn_set_header(&ep->conn, "If-None-Match", ep->etag[0] ? ep->etag : NULL);
+    http_conn_set_header(&ep->conn, "If-Modified-Since",
+                         !ep->etag[0] && ep->last_modified[0] ? ep->last_modified : NULL);
+}
 
-        cJSON *rem_pct = cJSON_GetObjectItem(session, "remaining_pct");
-        if (cJSON_IsNumber(rem_pct)) {
-            new_status.session_remaining_pct = (float)rem_pct->valuedouble;
-        }
+// True (and counted) if the body ended before its Content-Length
+static bool body_truncated(endpoint_t *ep)
+{
+    int64_t expected = http_conn_content_length(&ep->conn);
+    if (expected <= 0 || ep->body.body_wire >= expected) {
+        return false;
+    }
+    ep->body_truncated++;
+    ESP_LOGW(TAG, "%s: status body truncated: %u of %lld bytes", ep->name,
+             (unsigned)ep->body.body_wire, (long long)expected);
+    return true;
+}
 
-        // Parse model distribution
-        cJSON *dist = cJSON_GetObjectItem(session, "model_distribution");
-        if (cJSON_IsArray(dist)) {
-            int count = cJSON_GetArraySize(dist);
-            if (count > MAX_MODELS) count = MAX_MODELS;
-            new_status.model_count = count;
-
-            for (int i = 0; i < count; i++) {
-                cJSON *item = cJSON_GetArrayItem(dist, i);
-                cJSON *model = cJSON_GetObjectItem(item, "model");
-                if (cJSON_IsString(model) && model->valuestring) {
-                    strncpy(new_status.models[i].model, model->valuestring,
-                            sizeof(new_status.models[i].model) - 1);
-                }
-                cJSON *pct = cJSON_GetObjectItem(item, "cost_pct");
-                if (cJSON_IsNumber(pct)) {
-                    new_status.models[i].cost_pct = (float)pct->valuedouble;
+// The outcome of one poll; true if the server answered with a usable status
+// (or a 304). *data_age_s is the age of the server's data, -1 when unknown
+// (no body, or the server does not report it).
+static bool fetch_status(endpoint_t *ep, esp_err_t err, int *data_age_s)
+{
+    *data_age_s = -1;
+    if (err == ESP_OK) {
+        int status = http_conn_status_code(&ep->conn);
+        if (status == 304 && (ep->etag[0] || ep->last_modified[0])) {
+            // Unchanged since the last accepted body: nothing to parse or publish
+            note_success(ep);
+            ESP_LOGD(TAG, "%s: status not modified", ep->name);
+            return true;
+        } else if (status == 200) {
+            if (body_truncated(ep)) {
+                // Connection cut mid-body; don't blame the parser
+            } else if (!body_decoder_finish(&ep->body)) {
+                ESP_LOGW(TAG, "%s: body decoding failed", ep->name);
+            } else if (status_parser_finish(&ep->parser)) {
+                ESP_LOGD(TAG, "%s: status body: %u bytes received, %u decoded", ep->name,
+                         (unsigned)ep->body.body_wire, (unsigned)ep->body.body_decoded);
+                note_clipped(ep);
+                store_status(ep, &ep->parsed);
+                adopt_validators(ep);
+                // Servers without the meta fields leave both empty/zero
+                if (ep->parsed.server_time[0]) {
+                    *data_age_s = ep->parsed.data_age_seconds;
                 }
+                return true;
+            } else {
+                ESP_LOGW(TAG, "%s: JSON parse failed", ep->name);
             }
+        } else {
+            ESP_LOGW(TAG, "%s: HTTP %d", ep->name, status);
         }
+    } else if (http_conn_status_code(&ep->conn) == 200 && ep->body.body_wire > 0 &&
+               body_truncated(ep)) {
+        // Depending on the IDF version a short body fails the request instead
+    } else {
+        ESP_LOGW(TAG, "%s: HTTP request failed: %s", ep->name, esp_err_to_name(err));
     }
+    return false;
+}
+
+static void stream_on_begin(void *ctx)
+{
+    endpoint_t *ep = ctx;
+    status_parser_init(&ep->parser, &ep->parsed);
+}
 
-    // Parse weekly tiers
-    cJSON *weekly = cJSON_GetObjectItem(root, "weekly");
-    if (weekly && !cJSON_IsNull(weekly)) {
-        parse_tier(cJSON_GetObjectItem(weekly, "all_models"), &new_status.weekly_all);
-        parse_tier(cJSON_GetObjectItem(weekly, "sonnet"), &new_status.weekly_sonnet);
-        parse_tier(cJSON_GetObjectItem(weekly, "opus"), &new_status.weekly_opus);
+static void stream_on_data(void *ctx, const char *data, size_t len)
+{
+    endpoint_t *ep = ctx;
+    status_parser_feed(&ep->parser, data, len);
+}
+
+static void stream_on_event(void *ctx, const char *name)
+{
+    endpoint_t *ep = ctx;
+    // Unnamed events are plain "message" events; anything else isn't for us
+    if (name[0] && strcmp(name, "status") != 0) {
+        return;
     }
+    if (status_parser_finish(&ep->parser)) {
+        note_clipped(ep);
+        store_status(ep, &ep->parsed);
+    } else {
+        ESP_LOGW(TAG, "%s: event stream: JSON parse failed", ep->name);
+    }
+}
 
-    // Parse burn rate
-    cJSON *burn = cJSON_GetObjectItem(root, "burn_rate");
-    if (burn && !cJSON_IsNull(burn)) {
-        new_status.burn_rate_present = true;
-        cJSON *tpm = cJSON_GetObjectItem(burn, "tokens_per_min");
-        if (cJSON_IsNumber(tpm)) {
-            new_status.burn_tokens_per_min = (float)tpm->valuedouble;
-        }
-        cJSON *cph = cJSON_GetObjectItem(burn, "cost_per_hour_usd");
-        if (cJSON_IsNumber(cph)) {
-            new_status.burn_cost_per_hour = (float)cph->valuedouble;
-        }
+// One server is done with the refresh; the last one finishes it
+static void refresh_answered(endpoint_t *ep, bool ok)
+{
+    ep->refresh_waiting = false;
+    s_refresh_failed |= !ok;
+    if (--s_refresh_pending > 0) {
+        return;
     }
+    s_refresh_rtt_ms = (uint32_t)((esp_timer_get_time() - s_refresh_started_us) / 1000);
+    s_refresh_ok = !s_refresh_failed;
+    s_refresh_completed++;
+    ESP_LOGI(TAG, "refresh %s in %u ms", s_refresh_ok ? "done" : "failed",
+             (unsigned)s_refresh_rtt_ms);
+    atomic_store(&s_refresh_active, false);
+}
 
-    // Parse prediction
-    cJSON *pred = cJSON_GetObjectItem(root, "prediction");
-    if (pred && !cJSON_IsNull(pred)) {
-        new_status.prediction_present = true;
+static void fetch_done(http_request_t *req, esp_err_t err)
+{
+    endpoint_t *ep = req->ctx;
+    int data_age_s;
+    uint32_t delay_ms;
+    bool ok = fetch_status(ep, err, &data_age_s);
+    if (ok) {
+        // The snapshot is only written by this task
+        const status_data_t *s = &ep->snapshot.status;
+        float burn = s->burn_rate_present ? s->burn_cost_per_hour : 0.0f;
+        ep->failing = false;
+        delay_ms = poll_scheduler_success(&ep->schedule, burn, data_age_s);
+    } else {
+        ep->failing = true;
+        delay_ms = poll_scheduler_failure(&ep->schedule);
+    }
+    http_engine_arm(&ep->timer, delay_ms);
+    if (ep->refresh_waiting) {
+        refresh_answered(ep, ok);
+    }
+}
 
-        cJSON *swhl = cJSON_GetObjectItem(pred, "session_will_hit_limit");
-        new_status.session_will_hit_limit = cJSON_IsTrue(swhl);
+// The stream is over (or never opened): poll, starting now so the data
+// doesn't lag, and try the stream again later
+static void stream_ended(endpoint_t *ep)
+{
+    ep->streaming = false;
+    http_conn_close(&ep->stream_conn);
+    ep->stream_retry_at_us = esp_timer_get_time() + (int64_t)STREAM_RETRY_MS * 1000;
+    if (s_polling_paused) {
+        return;
+    }
+    ESP_LOGI(TAG, "%s: polling, event stream retry in %ds", ep->name, STREAM_RETRY_MS / 1000);
+    http_engine_arm(&ep->timer, 0);
+}
 
-        cJSON *slis = cJSON_GetObjectItem(pred, "session_limit_in_seconds");
-        if (cJSON_IsNumber(slis)) {
-            new_status.session_limit_in_seconds = (int64_t)slis->valuedouble;
-        }
+static void stream_opened(http_request_t *req)
+{
+    endpoint_t *ep = req->ctx;
+    int status = http_conn_status_code(req->conn);
+    if (status != 200) {
+        ESP_LOGW(TAG, "%s: event stream: HTTP %d", ep->name, status);
+        http_engine_cancel(req);
+        stream_ended(ep);
+        return;
+    }
 
-        cJSON *wwhl = cJSON_GetObjectItem(pred, "weekly_will_hit_limit");
-        new_status.weekly_will_hit_limit = cJSON_IsTrue(wwhl);
+    ESP_LOGI(TAG, "%s: event stream open, switching to push mode", ep->name);
+    const sse_callbacks_t callbacks = {
+        .on_begin = stream_on_begin,
+        .on_data = stream_on_data,
+        .on_event = stream_on_event,
+        .ctx = ep,
+    };
+    sse_parser_init(&ep->sse, &callbacks);
+    ep->streaming = true;
+    req->deadline_us = esp_timer_get_time() + (int64_t)STREAM_IDLE_MS * 1000;
+}
 
-        cJSON *wlis = cJSON_GetObjectItem(pred, "weekly_limit_in_seconds");
-        if (cJSON_IsNumber(wlis)) {
-            new_status.weekly_limit_in_seconds = (int64_t)wlis->valuedouble;
-        }
+static void stream_data(http_request_t *req, const char *data, int len)
+{
+    endpoint_t *ep = req->ctx;
+    sse_parser_feed(&ep->sse, data, len);
+    req->deadline_us = esp_timer_get_time() + (int64_t)STREAM_IDLE_MS * 1000;
+    // Any traffic, keep-alive comments included, means the server is up and
+    // the last status it pushed is still current
+    if (ep->got_first_response) {
+        note_success(ep);
     }
+}
 
-    // Parse meta
-    cJSON *st = cJSON_GetObjectItem(root, "server_time");
-    if (cJSON_IsString(st) && st->valuestring) {
-        strncpy(new_status.server_time, st->valuestring, sizeof(new_status.server_time) - 1);
+static void stream_done(http_request_t *req, esp_err_t err)
+{
+    endpoint_t *ep = req->ctx;
+    if (!ep->streaming) {
+        ESP_LOGW(TAG, "%s: event stream unavailable: %s", ep->name, esp_err_to_name(err));
+    } else if (err == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "%s: event stream silent for %ds", ep->name, STREAM_IDLE_MS / 1000);
+    } else {
+        ESP_LOGW(TAG, "%s: event stream %s", ep->name,
+                 err == ESP_OK ? "closed by server" : "read failed");
     }
+    stream_ended(ep);
+}
 
-    cJSON *age = cJSON_GetObjectItem(root, "data_age_seconds");
-    if (cJSON_IsNumber(age)) {
-        new_status.data_age_seconds = (int)age->valuedouble;
+// The endpoint's timer: time for the next poll, or (while the event stream
+// is up) time to check it should stay up
+static void endpoint_timer(http_timer_t *timer)
+{
+    endpoint_t *ep = timer->ctx;
+    bool paused = s_polling_paused;
+    bool online = wifi_is_connected();
+
+    // Every endpoint's timer looks at all of them, so a dead server leaves
+    // the totals within one poll interval of any live one
+    drop_stale_endpoints();
+
+    if (http_engine_is_active(&ep->stream)) {
+        if (!paused && online) {
+            http_engine_arm(&ep->timer, STREAM_CHECK_MS);
+            return;
+        }
+        http_engine_cancel(&ep->stream);
+        stream_ended(ep);
     }
 
-    cJSON *plan = cJSON_GetObjectItem(root, "plan");
-    if (cJSON_IsString(plan) && plan->valuestring) {
-        strncpy(new_status.plan, plan->valuestring, sizeof(new_status.plan) - 1);
+    if (paused) {
+        // No point holding a socket open through hours of sleep
+        http_conn_close(&ep->conn);
+        http_conn_close(&ep->stream_conn);
+        http_engine_arm(&ep->timer, POLL_INTERVAL_MS);
+    } else if (!online) {
+        // Not the server's fault. Left unarmed: http_client_network_up()
+        // posts the timer the moment there is an address again.
+    } else if (http_engine_is_active(&ep->fetch)) {
+        // Posted while a poll is out; fetch_done schedules the next one
+    } else if (ep->stream_available && esp_timer_get_time() >= ep->stream_retry_at_us) {
+        // The polling connection sits idle while the stream is up
+        http_conn_close(&ep->conn);
+        if (http_engine_submit(&ep->stream, REQUEST_TIMEOUT_MS) == ESP_OK) {
+            http_engine_arm(&ep->timer, STREAM_CHECK_MS);
+        } else {
+            stream_ended(ep);
+        }
+    } else if (http_engine_submit(&ep->fetch, REQUEST_TIMEOUT_MS) != ESP_OK) {
+        ep->failing = true;
+        http_engine_arm(&ep->timer, poll_scheduler_failure(&ep->schedule));
     }
+}
 
-    xSemaphoreTake(s_status_mutex, portMAX_DELAY);
-    s_status = new_status;
-    s_got_first_response = true;
-    s_last_success_time = time(NULL);
-    xSemaphoreGive(s_status_mutex);
+// The endpoint's part of a refresh, on the engine task
+static void endpoint_refresh(http_timer_t *timer)
+{
+    endpoint_t *ep = timer->ctx;
+    ep->refresh_waiting = true;
+    if (http_engine_is_active(&ep->fetch)) {
+        // Already asking; that answer will do
+        return;
+    }
+    if (http_engine_is_active(&ep->stream) && ep->streaming) {
+        // Pushed statuses are as fresh as it gets
+        refresh_answered(ep, true);
+        return;
+    }
+    // Not while asleep, offline, opening the stream, or without a connection
+    // (bad URL)
+    if (s_polling_paused || !wifi_is_connected() || http_engine_is_active(&ep->stream) ||
+        !ep->fetch.conn || http_engine_submit(&ep->fetch, REQUEST_TIMEOUT_MS) != ESP_OK) {
+        refresh_answered(ep, false);
+        return;
+    }
+    // fetch_done schedules the next poll from this one
+    http_engine_disarm(&ep->timer);
+}
 
-    ESP_LOGI(TAG, "status: session=%.0f%% weekly=%.0f%% burn=$%.1f/hr",
-             new_status.session.utilisation,
-             new_status.weekly_all.utilisation,
-             new_status.burn_cost_per_hour);
+// The connections live as long as the firmware: URL, auth header and the
+// server address are set up once and the socket is kept alive between polls.
+static bool endpoint_connect(endpoint_t *ep)
+{
+    char url[192];
+    snprintf(url, sizeof(url), "%s%s", ep->url, API_STATUS_PATH);
+    if (http_conn_init(&ep->conn, url, API_TOKEN, SERVER_CERT_PEM,
+                       http_event_handler, ep) != ESP_OK) {
+        ESP_LOGE(TAG, "cannot set up connection to %s", ep->url);
+        return false;
+    }
+    // CBOR skips the repeated key names and float text conversion; servers
+    // that don't speak it answer in JSON
+    http_conn_set_header(&ep->conn, "Accept", "application/cbor, application/json;q=0.9");
+    // Fewer bytes on air; bodies are inflated as they stream in
+    http_conn_set_header(&ep->conn, "Accept-Encoding", BODY_DECODER_ACCEPT_ENCODING);
+    ep->fetch = (http_request_t){
+        .conn = &ep->conn,
+        .kind = HTTP_REQUEST_FETCH,
+        .on_done = fetch_done,
+        .ctx = ep,
+    };
 
-    cJSON_Delete(root);
+    if (STREAM_ENABLED) {
+        snprintf(url, sizeof(url), "%s%s", ep->url, API_STREAM_PATH);
+        ep->stream_available = http_conn_init(&ep->stream_conn, url, API_TOKEN,
+                                              SERVER_CERT_PEM, NULL, NULL) == ESP_OK;
+        if (ep->stream_available) {
+            http_conn_set_header(&ep->stream_conn, "Accept", "text/event-stream");
+            http_conn_set_header(&ep->stream_conn, "Cache-Control", "no-cache");
+        }
+        ep->stream = (http_request_t){
+            .conn = &ep->stream_conn,
+            .kind = HTTP_REQUEST_STREAM,
+            .on_open = stream_opened,
+            .on_data = stream_data,
+            .on_done = stream_done,
+            .ctx = ep,
+        };
+    }
+    return true;
 }
 
-static void fetch_status(void)
+// Name an endpoint after the host[:port] in its URL
+static void endpoint_name(const char *url, char *buf, size_t len)
 {
-    if (!wifi_is_connected()) {
-        return;
+    const char *host = strstr(url, "://");
+    host = host ? host + 3 : url;
+    size_t n = strcspn(host, "/");
+    snprintf(buf, len, "%.*s", (int)n, host);
+}
+
+static void endpoints_init(void)
+{
+    s_publish_mutex = xSemaphoreCreateMutex();
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        endpoint_t *ep = &s_endpoints[i];
+        ep->url = s_server_urls[i];
+        endpoint_name(s_server_urls[i], ep->name, sizeof(ep->name));
+        poll_scheduler_init(&ep->schedule);
+        ep->timer = (http_timer_t){.fn = endpoint_timer, .ctx = ep};
+        ep->refresh = (http_timer_t){.fn = endpoint_refresh, .ctx = ep};
     }
+}
+
+uint32_t http_client_status_generation(void)
+{
+    return atomic_load_explicit(&s_published.seq, memory_order_acquire) / 2;
+}
 
-    char url[128];
-    snprintf(url, sizeof(url), "%s%s", SERVER_URL, API_STATUS_PATH);
+bool http_client_read_status(status_data_t *out, uint32_t *generation)
+{
+    return slot_read(&s_published, out, generation);
+}
 
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = http_event_handler,
-        .timeout_ms = 5000,
-    };
+time_t http_client_last_success_time(void)
+{
+    return (time_t)s_last_success_time;
+}
+
+int64_t http_client_status_age_s(const status_data_t *status)
+{
+    int64_t age = status->server_time[0] ? status->data_age_seconds : 0;
+    time_t now = time(NULL);
+    if (status->received_at >= CLOCK_VALID_AFTER && now > (time_t)status->received_at) {
+        age += now - status->received_at;
+    }
+    return age > 0 ? age : 0;
+}
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    s_http_buf_len = 0;
+size_t http_client_endpoint_count(void)
+{
+    return ENDPOINT_COUNT;
+}
+
+bool http_client_read_endpoint(size_t i, http_endpoint_t *out, uint32_t *generation)
+{
+    endpoint_t *ep = &s_endpoints[i];
+    memcpy(out->name, ep->name, sizeof(out->name));
+    out->last_success = ep->last_success_time;
+    out->failing = ep->failing;
+    return slot_read(&ep->snapshot, &out->status, generation);
+}
 
-    // Send Bearer token if configured
-    if (sizeof(API_TOKEN) > 1) {  // non-empty string
-        char auth_header[128];
-        snprintf(auth_header, sizeof(auth_header), "Bearer %s", API_TOKEN);
-        esp_http_client_set_header(client, "Authorization", auth_header);
+void http_client_get_conn_stats(http_conn_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        const http_conn_stats_t *s = &s_endpoints[i].conn.stats;
+        out->requests += s->requests;
+        out->connects += s->connects;
+        out->reused += s->reused;
+        out->retries += s->retries;
+        out->failures += s->failures;
+        out->dns_lookups += s->dns_lookups;
+        out->tls_full += s->tls_full;
+        out->tls_resumed += s->tls_resumed;
+        if (s->tls_full_ms > out->tls_full_ms) out->tls_full_ms = s->tls_full_ms;
+        if (s->tls_resumed_ms > out->tls_resumed_ms) out->tls_resumed_ms = s->tls_resumed_ms;
+        out->completed += s->completed;
+        out->total_ms += s->total_ms;
+        if (s->last_ms > out->last_ms) out->last_ms = s->last_ms;
     }
+}
 
-    esp_err_t err = esp_http_client_perform(client);
-    if (err == ESP_OK) {
-        int status = esp_http_client_get_status_code(client);
-        if (status == 200) {
-            s_http_buf[s_http_buf_len] = '\0';
-            parse_status_response(s_http_buf);
-        } else {
-            ESP_LOGW(TAG, "HTTP %d", status);
+void http_client_get_body_stats(status_body_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        const endpoint_t *ep = &s_endpoints[i];
+        out->bytes.wire_bytes += ep->body.stats.wire_bytes;
+        out->bytes.decoded_bytes += ep->body.stats.decoded_bytes;
+        out->bytes.compressed += ep->body.stats.compressed;
+        if (ep->body.stats.peak_decoded > out->bytes.peak_decoded) {
+            out->bytes.peak_decoded = ep->body.stats.peak_decoded;
         }
-    } else {
-        ESP_LOGW(TAG, "HTTP request failed: %s", esp_err_to_name(err));
+        out->truncated += ep->body_truncated;
+        out->clipped += ep->body_clipped;
     }
-
-    esp_http_client_cleanup(client);
 }
 
-static void http_poll_task(void *arg)
+void http_client_get_poll_schedule(poll_scheduler_t *out)
 {
-    // Wait a moment for WiFi to stabilise
-    vTaskDelay(pdMS_TO_TICKS(2000));
-
-    while (1) {
-        if (!s_polling_paused) {
-            fetch_status();
+    const endpoint_t *next = &s_endpoints[0];
+    for (size_t i = 1; i < ENDPOINT_COUNT; i++) {
+        if (s_endpoints[i].schedule.next_at_us < next->schedule.next_at_us) {
+            next = &s_endpoints[i];
         }
-        TickType_t delay = pdMS_TO_TICKS(
-            s_got_first_response ? POLL_INTERVAL_MS : POLL_FAST_INTERVAL_MS);
-        vTaskDelay(delay);
     }
+    *out = next->schedule;
 }
 
-const status_data_t *http_client_get_status(void)
+bool http_client_is_streaming(void)
 {
-    if (!s_status_mutex) {
-        return &s_status_copy;
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        if (s_endpoints[i].streaming) {
+            return true;
+        }
     }
-    xSemaphoreTake(s_status_mutex, portMAX_DELAY);
-    s_status_copy = s_status;
-    xSemaphoreGive(s_status_mutex);
-    return &s_status_copy;
+    return false;
 }
 
-time_t http_client_last_success_time(void)
+bool http_client_refresh(void)
 {
-    if (!s_status_mutex) {
-        return 0;
+    bool idle = false;
+    if (!atomic_compare_exchange_strong(&s_refresh_active, &idle, true)) {
+        return false;
+    }
+    s_refresh_started_us = esp_timer_get_time();
+    s_refresh_pending = ENDPOINT_COUNT;
+    s_refresh_failed = false;
+    // Posting is the release: the engine sees the fields above
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        http_engine_post(&s_endpoints[i].refresh);
     }
-    xSemaphoreTake(s_status_mutex, portMAX_DELAY);
-    time_t t = s_last_success_time;
-    xSemaphoreGive(s_status_mutex);
-    return t;
+    return true;
+}
+
+void http_client_get_refresh(http_refresh_t *out)
+{
+    out->in_progress = atomic_load(&s_refresh_active);
+    out->completed = s_refresh_completed;
+    out->rtt_ms = s_refresh_rtt_ms;
+    out->ok = s_refresh_ok;
 }
 
 void http_client_pause_polling(void)
@@ -289,15 +810,46 @@ void http_client_resume_polling(void)
     s_polling_paused = false;
 }
 
-void http_client_init(void)
+void http_client_restore_status(const status_data_t *status)
+{
+    slot_write(&s_published, status, status->received_at);
+    s_status_cached = true;
+}
+
+bool http_client_status_is_cached(void)
 {
-    s_status_mutex = xSemaphoreCreateMutex();
+    return s_status_cached;
+}
+
+void http_client_on_status(void (*cb)(void))
+{
+    s_on_status = cb;
+}
+
+void http_client_network_up(void)
+{
+    if (!atomic_load(&s_started)) {
+        return;                     // the timers' first run finds the address
+    }
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        if (s_endpoints[i].fetch.conn) {
+            http_engine_post(&s_endpoints[i].timer);
+        }
+    }
 }
 
 void http_client_start(void)
 {
-    if (!s_status_mutex) {
-        http_client_init();
+    endpoints_init();
+    for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+        if (endpoint_connect(&s_endpoints[i])) {
+            // First poll now if WiFi is already up, else when it comes up
+            http_engine_arm(&s_endpoints[i].timer, 0);
+        }
     }
-    xTaskCreate(http_poll_task, "http_poll", 8192, NULL, 5, NULL);
+    // Before the timers first run: an address that arrives after they found
+    // none must post them
+    atomic_store(&s_started, true);
+    // Every server's polls and streams share the engine's one task
+    http_engine_start();
 }
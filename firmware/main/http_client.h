@@ -2,11 +2,21 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <time.h>
+#include "body_decoder.h"
+#include "http_conn.h"
+#include "poll_scheduler.h"
+
+// Epoch seconds before this mean SNTP hasn't set the clock yet
+#define CLOCK_VALID_AFTER 1700000000u
 
 // Maximum number of models in distribution
 #define MAX_MODELS 4
 
+// Maximum number of CCU instances polled at once (SERVER_URLS)
+#define MAX_ENDPOINTS 4
+
 // Usage tier data (shared by session and weekly tiers)
 typedef struct {
     float   utilisation;       // 0-100+ (session can exceed 100)
@@ -17,7 +27,7 @@ typedef struct {
 
 // Model distribution entry
 typedef struct {
-    char  model[24];
+    char  model[32];
     float cost_pct;
 } model_dist_t;
 
@@ -55,23 +65,104 @@ typedef struct {
     char server_time[32];
     int  data_age_seconds;
     char plan[16];
+    uint32_t received_at;          // epoch seconds when it arrived (0 = unknown)
     bool valid;
 } status_data_t;
 
-// Get a pointer to the current status data (thread-safe read).
-// Safe to call before http_client_start() -- returns zeroed data with valid=false.
-const status_data_t *http_client_get_status(void);
+// Generation of the published status: 0 until the first response, then
+// incremented each time a new status is stored. Lock-free.
+uint32_t http_client_status_generation(void);
+
+// Copy the current status into *out if its generation differs from
+// *generation, and update *generation. Returns false (leaving *out untouched)
+// when nothing changed. Never blocks the HTTP engine task; safe to call from
+// any task at any time.
+// Start with *generation = 0 and a zeroed *out (valid=false).
+bool http_client_read_status(status_data_t *out, uint32_t *generation);
 
-// Create the status mutex. Call before any LVGL timers that use http_client_get_status().
-void http_client_init(void);
+// Publish a status saved before the last reboot (status_cache.h) until the
+// first fresh one arrives. Call before http_client_start().
+void http_client_restore_status(const status_data_t *status);
 
-// Start the HTTP polling task. Polls /api/status every POLL_INTERVAL_MS.
-// Calls http_client_init() if not already called.
+// True while the published status is the restored one.
+bool http_client_status_is_cached(void);
+
+// Call cb from the HTTP engine task each time a new status is published (to
+// wake the UI instead of waiting for its next tick). cb must not block: every
+// server's requests wait on it. Set before http_client_start().
+void http_client_on_status(void (*cb)(void));
+
+// Start polling. Every server in SERVER_URLS (or just SERVER_URL) has its
+// /api/status polled on the adaptive schedule in poll_scheduler.h, by a timer
+// and request of its own on the one HTTP engine task (http_engine.h), and the
+// published status is their statuses combined (status_aggregate.h).
 void http_client_start(void);
 
-// Returns the time of the last successful API response (0 if none yet).
+// WiFi has an address (again): poll every server now rather than at its next
+// slot. Any task; before http_client_start() it does nothing.
+void http_client_network_up(void);
+
+// Returns the time of the last successful API response (0 if none yet),
+// including 304 Not Modified answers to a conditional poll.
 time_t http_client_last_success_time(void);
 
+// How old the numbers in a status are now, in seconds: the server's own data
+// age plus, once the clock is set, the time since the status arrived (which
+// matters for a cached one).
+int64_t http_client_status_age_s(const status_data_t *status);
+
+// One server's share of the published status.
+typedef struct {
+    char name[32];              // host[:port] of its URL
+    status_data_t status;       // the last status it sent (valid=false until then)
+    uint32_t last_success;      // epoch seconds of its last answer (0 = none)
+    bool failing;               // its last poll failed
+} http_endpoint_t;
+
+// Number of servers polled, 1 to MAX_ENDPOINTS.
+size_t http_client_endpoint_count(void);
+
+// Fill in server i's name and health, and copy its status if that has a
+// different generation than *generation (updated). Returns whether it did.
+// Lock-free, like http_client_read_status().
+bool http_client_read_endpoint(size_t i, http_endpoint_t *out, uint32_t *generation);
+
+// Connection reuse counters and request latency, summed over the servers
+// (reused vs re-established; last_ms and the TLS times are the slowest one's).
+void http_client_get_conn_stats(http_conn_stats_t *out);
+
+// Status body sizes and anomalies, across polls, pushed events and servers.
+typedef struct {
+    body_decoder_stats_t bytes;   // as received vs decoded, peak body size
+    uint32_t truncated;           // bodies that ended short of their Content-Length
+    uint32_t clipped;             // values that didn't fit status_data_t
+} status_body_stats_t;
+
+void http_client_get_body_stats(status_body_stats_t *out);
+
+// Scheduler state and the time of the next poll of whichever server is
+// polled next (meaningless while streaming). Copied without locking.
+void http_client_get_poll_schedule(poll_scheduler_t *out);
+
+// True while status updates are pushed over the event stream (STREAM_ENABLED)
+// rather than polled, by any of the servers.
+bool http_client_is_streaming(void);
+
+// On-demand refresh: poll every server now rather than at its next slot. A
+// server whose poll is already in flight isn't asked twice; that answer
+// serves. Returns false when a refresh is still running, which the new one
+// joins instead. Any task.
+bool http_client_refresh(void);
+
+typedef struct {
+    bool     in_progress;
+    uint32_t completed;     // refreshes finished since boot
+    uint32_t rtt_ms;        // the last one: request to the last server's answer
+    bool     ok;            // ...and every server answered (pushed data counts)
+} http_refresh_t;
+
+void http_client_get_refresh(http_refresh_t *out);
+
 // Pause and resume HTTP polling (for sleep mode).
 void http_client_pause_polling(void);
 void http_client_resume_polling(void);
@@ -0,0 +1,482 @@
+#include "http_conn.h"
+#include "sdkconfig.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include "esp_crt_bundle.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "http_conn";
+
+// Longest a single step waits on the socket before handing back
+// ESP_ERR_HTTP_EAGAIN; whole requests are bounded by the caller
+#define HTTP_IO_WAIT_MS 10
+
+// Lookups waiting for the resolver task at once (a poll and a stream
+// connection per server)
+#define RESOLVER_QUEUE 8
+
+static _Atomic(http_conn_t *) s_lookups[RESOLVER_QUEUE];
+static TaskHandle_t s_resolver;
+
+static esp_err_t parse_url(http_conn_t *conn, const char *url)
+{
+    const char *sep = strstr(url, "://");
+    if (!sep || (size_t)(sep - url) >= sizeof(conn->scheme)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    snprintf(conn->scheme, sizeof(conn->scheme), "%.*s", (int)(sep - url), url);
+
+    const char *host = sep + 3;
+    const char *path = strchr(host, '/');
+    if (!path) {
+        path = host + strlen(host);
+    }
+    const char *colon = memchr(host, ':', path - host);
+    const char *host_end = colon ? colon : path;
+    if ((size_t)(host_end - host) >= sizeof(conn->host)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    snprintf(conn->host, sizeof(conn->host), "%.*s", (int)(host_end - host), host);
+
+    bool https = strcmp(conn->scheme, "https") == 0;
+    conn->port = colon ? atoi(colon + 1) : (https ? 443 : 80);
+    snprintf(conn->path, sizeof(conn->path), "%s", *path ? path : "/");
+
+    if (colon) {
+        snprintf(conn->host_header, sizeof(conn->host_header), "%s:%d", conn->host, conn->port);
+    } else {
+        snprintf(conn->host_header, sizeof(conn->host_header), "%s", conn->host);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t conn_event_handler(esp_http_client_event_t *evt)
+{
+    http_conn_t *conn = evt->user_data;
+
+    switch (evt->event_id) {
+    case HTTP_EVENT_ON_CONNECTED:
+        conn->connected_this_request = true;
+        conn->stats.connects++;
+        if (conn->https) {
+            // ON_CONNECTED fires once the TLS handshake is done, so this is
+            // the full connect cost of this attempt
+            uint32_t ms = (uint32_t)((esp_timer_get_time() - conn->attempt_start_us) / 1000);
+            if (conn->tls_session_saved) {
+                conn->stats.tls_resumed++;
+                conn->stats.tls_resumed_ms = ms;
+            } else {
+                conn->stats.tls_full++;
+                conn->stats.tls_full_ms = ms;
+            }
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+            conn->tls_session_saved = true;
+#endif
+            ESP_LOGD(TAG, "TLS connect %u ms (%u full / %u resumed)", (unsigned)ms,
+                     (unsigned)conn->stats.tls_full, (unsigned)conn->stats.tls_resumed);
+        }
+        ESP_LOGI(TAG, "connected to %s (%s), %u reused / %u new so far",
+                 conn->host_header, conn->resolved_url,
+                 (unsigned)conn->stats.reused, (unsigned)conn->stats.connects);
+        break;
+    default:
+        break;
+    }
+
+    if (conn->handler) {
+        evt->user_data = conn->user_data;
+        esp_err_t err = conn->handler(evt);
+        evt->user_data = conn;
+        return err;
+    }
+    return ESP_OK;
+}
+
+// Point the client at addr, keeping the original Host header
+static void use_address(http_conn_t *conn, const char *addr, bool v6)
+{
+    snprintf(conn->resolved_url, sizeof(conn->resolved_url), "%s://%s%s%s:%d%s",
+             conn->scheme, v6 ? "[" : "", addr, v6 ? "]" : "", conn->port, conn->path);
+
+    bool ok;
+    if (conn->https) {
+        // set_url resets the Host header, so restore the name the server expects
+        ok = esp_http_client_set_url(conn->client, conn->resolved_url) == ESP_OK &&
+             esp_http_client_set_header(conn->client, "Host", conn->host_header) == ESP_OK;
+    } else {
+        ok = http_plain_set_address(&conn->plain, addr, v6, conn->port);
+    }
+    if (ok) {
+        conn->have_address = true;
+        conn->resolved = true;
+    }
+}
+
+// A literal address needs no lookup
+static bool literal_address(http_conn_t *conn)
+{
+    char addr[INET6_ADDRSTRLEN];
+    struct in_addr a4;
+    struct in6_addr a6;
+    if (inet_pton(AF_INET, conn->host, &a4) == 1) {
+        inet_ntop(AF_INET, &a4, addr, sizeof(addr));
+        use_address(conn, addr, false);
+        return true;
+    }
+    if (inet_pton(AF_INET6, conn->host, &a6) == 1) {
+        inet_ntop(AF_INET6, &a6, addr, sizeof(addr));
+        use_address(conn, addr, true);
+        return true;
+    }
+    return false;
+}
+
+// Runs on the resolver task
+static void lookup(http_conn_t *conn)
+{
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo *res = NULL;
+    int rc = getaddrinfo(conn->host, NULL, &hints, &res);
+    conn->lookup_addr[0] = '\0';
+    if (rc == 0 && res) {
+        if (res->ai_family == AF_INET) {
+            inet_ntop(AF_INET, &((struct sockaddr_in *)res->ai_addr)->sin_addr,
+                      conn->lookup_addr, sizeof(conn->lookup_addr));
+            conn->lookup_v6 = false;
+        } else if (res->ai_family == AF_INET6) {
+            inet_ntop(AF_INET6, &((struct sockaddr_in6 *)res->ai_addr)->sin6_addr,
+                      conn->lookup_addr, sizeof(conn->lookup_addr));
+            conn->lookup_v6 = true;
+        }
+        freeaddrinfo(res);
+    } else {
+        ESP_LOGW(TAG, "DNS lookup for %s failed (%d)", conn->host, rc);
+    }
+    atomic_store(&conn->lookup, conn->lookup_addr[0] ? HTTP_LOOKUP_DONE : HTTP_LOOKUP_FAILED);
+}
+
+static void resolver_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (int i = 0; i < RESOLVER_QUEUE; i++) {
+            http_conn_t *conn = atomic_exchange(&s_lookups[i], NULL);
+            if (conn) {
+                lookup(conn);
+            }
+        }
+    }
+}
+
+// Queue a lookup. Only the task owning the conns queues, so a free slot
+// can't be taken from under it (the resolver only empties them).
+static bool lookup_start(http_conn_t *conn)
+{
+    if (!s_resolver) {
+        xTaskCreate(resolver_task, "http_resolver", 4096, NULL, 4, &s_resolver);
+    }
+    for (int i = 0; i < RESOLVER_QUEUE; i++) {
+        if (!atomic_load(&s_lookups[i])) {
+            conn->stats.dns_lookups++;
+            atomic_store(&conn->lookup, HTTP_LOOKUP_PENDING);
+            atomic_store(&s_lookups[i], conn);
+            xTaskNotifyGive(s_resolver);
+            return true;
+        }
+    }
+    ESP_LOGW(TAG, "more than %d lookups queued", RESOLVER_QUEUE);
+    return false;
+}
+
+// Settle the address for the attempt about to start: ESP_OK to go ahead,
+// ESP_ERR_HTTP_EAGAIN while the first lookup runs, ESP_ERR_HTTP_CONNECT when
+// there is no address to use.
+static esp_err_t address_step(http_conn_t *conn)
+{
+    if (conn->address_checked) {
+        return ESP_OK;
+    }
+    if (!conn->resolved) {
+        switch (atomic_load(&conn->lookup)) {
+        case HTTP_LOOKUP_IDLE:
+            if (!lookup_start(conn) && !conn->have_address) {
+                return ESP_ERR_HTTP_CONNECT;
+            }
+            break;
+        case HTTP_LOOKUP_DONE:
+            atomic_store(&conn->lookup, HTTP_LOOKUP_IDLE);
+            use_address(conn, conn->lookup_addr, conn->lookup_v6);
+            break;
+        case HTTP_LOOKUP_FAILED:
+            atomic_store(&conn->lookup, HTTP_LOOKUP_IDLE);
+            if (!conn->have_address) {
+                return ESP_ERR_HTTP_CONNECT;
+            }
+            // Keep the last good address until it fails again
+            conn->resolved = true;
+            break;
+        default:
+            break;
+        }
+        if (!conn->have_address) {
+            return ESP_ERR_HTTP_EAGAIN;
+        }
+    }
+    conn->address_checked = true;
+    return ESP_OK;
+}
+
+esp_err_t http_conn_init(http_conn_t *conn, const char *url, const char *token,
+                         const char *cert_pem, http_event_handle_cb handler, void *user_data)
+{
+    memset(conn, 0, sizeof(*conn));
+    conn->handler = handler;
+    conn->user_data = user_data;
+    snprintf(conn->url, sizeof(conn->url), "%s", url);
+
+    esp_err_t err = parse_url(conn, url);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "invalid URL: %s", url);
+        return err;
+    }
+
+    conn->https = strcmp(conn->scheme, "https") == 0;
+    if (conn->https) {
+        esp_http_client_config_t config = {
+            .url = conn->url,
+            .event_handler = conn_event_handler,
+            .user_data = conn,
+            .timeout_ms = HTTP_IO_WAIT_MS,
+            .is_async = true,
+            // The URL may point at the cached address; verify against the name
+            .common_name = conn->host,
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+            .save_client_session = true,
+#endif
+        };
+        if (cert_pem) {
+            config.cert_pem = cert_pem;
+        } else {
+            config.crt_bundle_attach = esp_crt_bundle_attach;
+        }
+        conn->client = esp_http_client_init(&config);
+        if (!conn->client) {
+            return ESP_ERR_NO_MEM;
+        }
+    } else {
+        // esp_http_client's async mode is HTTPS-only
+        http_plain_init(&conn->plain, conn->host_header, conn->path, HTTP_IO_WAIT_MS,
+                        conn_event_handler, conn);
+    }
+    conn->ready = true;
+
+    if (token && token[0]) {
+        snprintf(conn->auth_header, sizeof(conn->auth_header), "Bearer %s", token);
+        http_conn_set_header(conn, "Authorization", conn->auth_header);
+    }
+    literal_address(conn);
+    return ESP_OK;
+}
+
+static void begin_attempt(http_conn_t *conn)
+{
+    conn->connected_this_request = false;
+    conn->address_checked = false;
+    conn->attempt_start_us = esp_timer_get_time();
+}
+
+static void begin_request(http_conn_t *conn)
+{
+    conn->stats.requests++;
+    conn->in_flight = true;
+    conn->retried = false;
+    conn->stream_sent = false;
+    begin_attempt(conn);
+    conn->request_start_us = conn->attempt_start_us;
+}
+
+static void request_done(http_conn_t *conn)
+{
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - conn->request_start_us) / 1000);
+    conn->in_flight = false;
+    conn->stats.completed++;
+    conn->stats.last_ms = ms;
+    conn->stats.total_ms += ms;
+}
+
+static esp_err_t request_failed(http_conn_t *conn, esp_err_t err)
+{
+    conn->in_flight = false;
+    conn->stats.failures++;
+    if (err == ESP_ERR_HTTP_CONNECT) {
+        // The server may have moved; look it up again next time
+        conn->resolved = false;
+    }
+    return err;
+}
+
+static void transport_close(http_conn_t *conn)
+{
+    if (conn->https) {
+        esp_http_client_close(conn->client);
+    } else {
+        http_plain_close(&conn->plain);
+    }
+}
+
+esp_err_t http_conn_perform(http_conn_t *conn)
+{
+    if (!conn->ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!conn->in_flight) {
+        begin_request(conn);
+    }
+    esp_err_t err = address_step(conn);
+    if (err == ESP_ERR_HTTP_EAGAIN) {
+        return err;
+    }
+    if (err != ESP_OK) {
+        return request_failed(conn, err);
+    }
+
+    err = conn->https ? esp_http_client_perform(conn->client) : http_plain_perform(&conn->plain);
+    if (err == ESP_ERR_HTTP_EAGAIN) {
+        return err;
+    }
+    bool reused = !conn->connected_this_request;
+    if (err == ESP_OK) {
+        request_done(conn);
+        if (reused) {
+            conn->stats.reused++;
+        }
+        return ESP_OK;
+    }
+
+    // Leave the client in a clean state for the next attempt
+    transport_close(conn);
+
+    // A kept-alive connection the server has since closed fails on first
+    // use; that's expected, so try once more on a fresh connection.
+    if (reused && !conn->retried) {
+        conn->retried = true;
+        conn->stats.retries++;
+        ESP_LOGD(TAG, "kept-alive connection went stale (%s), reconnecting", esp_err_to_name(err));
+        begin_attempt(conn);
+        return ESP_ERR_HTTP_EAGAIN;
+    }
+    return request_failed(conn, err);
+}
+
+esp_err_t http_conn_open_stream(http_conn_t *conn)
+{
+    if (!conn->ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!conn->in_flight) {
+        // A stream holds its connection for good, so any previous one is stale
+        transport_close(conn);
+        begin_request(conn);
+    }
+
+    esp_err_t err = address_step(conn);
+    if (err == ESP_ERR_HTTP_EAGAIN) {
+        return err;
+    }
+    if (err != ESP_OK) {
+        return request_failed(conn, err);
+    }
+    if (!conn->https) {
+        err = http_plain_open(&conn->plain);
+        if (err == ESP_ERR_HTTP_EAGAIN) {
+            return err;
+        }
+    } else if (!conn->stream_sent) {
+        err = esp_http_client_open(conn->client, 0);
+        if (err == ESP_ERR_HTTP_EAGAIN) {
+            return err;
+        }
+        conn->stream_sent = err == ESP_OK;
+    }
+    if (err == ESP_OK && conn->https) {
+        int64_t len = esp_http_client_fetch_headers(conn->client);
+        if (len == -ESP_ERR_HTTP_EAGAIN) {
+            return ESP_ERR_HTTP_EAGAIN;
+        }
+        if (len < 0) {
+            err = ESP_ERR_HTTP_FETCH_HEADER;
+        }
+    }
+    if (err != ESP_OK) {
+        transport_close(conn);
+        return request_failed(conn, err);
+    }
+    request_done(conn);
+    return ESP_OK;
+}
+
+int http_conn_read(http_conn_t *conn, char *buf, int len)
+{
+    if (!conn->ready) {
+        return -1;
+    }
+    return conn->https ? esp_http_client_read(conn->client, buf, len)
+                       : http_plain_read(&conn->plain, buf, len);
+}
+
+esp_err_t http_conn_set_header(http_conn_t *conn, const char *key, const char *value)
+{
+    if (!conn->ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!conn->https) {
+        return http_plain_set_header(&conn->plain, key, value);
+    }
+    if (!value) {
+        esp_http_client_delete_header(conn->client, key);
+        return ESP_OK;
+    }
+    return esp_http_client_set_header(conn->client, key, value);
+}
+
+int http_conn_status_code(const http_conn_t *conn)
+{
+    if (!conn->ready) {
+        return 0;
+    }
+    return conn->https ? esp_http_client_get_status_code(conn->client)
+                       : http_plain_status_code(&conn->plain);
+}
+
+int64_t http_conn_content_length(const http_conn_t *conn)
+{
+    if (!conn->ready) {
+        return -1;
+    }
+    return conn->https ? esp_http_client_get_content_length(conn->client)
+                       : http_plain_content_length(&conn->plain);
+}
+
+void http_conn_close(http_conn_t *conn)
+{
+    conn->in_flight = false;
+    if (conn->ready) {
+        transport_close(conn);
+    }
+}
+
+void http_conn_abort(http_conn_t *conn)
+{
+    if (conn->in_flight) {
+        conn->stats.failures++;
+    }
+    http_conn_close(conn);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_client.h"
+#include "http_plain.h"
+
+// Long-lived HTTP connection to one server, owned by a single task.
+//
+// Requests never block: http_conn_perform() and http_conn_open_stream() each
+// do what the socket allows (waiting at most a few ms) and return
+// ESP_ERR_HTTP_EAGAIN until the request completes, so one task can drive
+// many connections (see http_engine.h). Time limits are the caller's: a
+// request that runs too long is dropped with http_conn_abort().
+//
+// https:// URLs go through esp_http_client in async mode; http:// ones
+// through http_plain.h, as that mode is HTTPS-only. The request URL and auth
+// header are built once, the server address is resolved once and cached, and
+// the client is kept across requests so HTTP/1.1 keep-alive can reuse the TCP
+// connection. Lookups run on a resolver task of their own, since
+// getaddrinfo() blocks for as long as the DNS server takes: the first request
+// waits for one (as EAGAIN steps), and after a connect failure the address is
+// looked up again in the background while requests keep using the last good
+// one. A request that fails on a reused connection (the server closed it
+// while idle) is retried once on a fresh one.
+//
+// For https:// URLs the TLS session is saved after each handshake and offered
+// on the next connect, so reconnects resume instead of running a full
+// handshake. The session lives with the handle, so it survives polls,
+// keep-alive drops and WiFi reconnects.
+
+typedef struct {
+    uint32_t requests;      // requests attempted
+    uint32_t connects;      // new connections established
+    uint32_t reused;        // requests served on an already-open connection
+    uint32_t retries;       // stale keep-alive connections transparently replaced
+    uint32_t failures;      // requests that failed even after a retry
+    uint32_t dns_lookups;   // address resolutions (cache misses)
+
+    // TLS handshakes, split by whether a saved session was offered. A server
+    // that declines resumption still counts as resumed here but shows up as a
+    // full-length connect time.
+    uint32_t tls_full;
+    uint32_t tls_resumed;
+    uint32_t tls_full_ms;     // connect time (TCP + TLS) of the last full handshake
+    uint32_t tls_resumed_ms;  // connect time of the last resumed handshake
+
+    // Latency of successful requests (whole fetches; streams up to their
+    // headers), from the first attempt, retries included
+    uint32_t completed;
+    uint32_t last_ms;
+    uint64_t total_ms;
+} http_conn_stats_t;
+
+typedef enum {
+    HTTP_LOOKUP_IDLE,
+    HTTP_LOOKUP_PENDING,    // queued for or running on the resolver task
+    HTTP_LOOKUP_DONE,       // lookup_addr holds the answer
+    HTTP_LOOKUP_FAILED,
+} http_lookup_state_t;
+
+typedef struct {
+    esp_http_client_handle_t client;    // https:// only
+    http_plain_t             plain;     // http:// (esp_http_client is async for HTTPS only)
+    bool                     ready;     // http_conn_init() succeeded
+    http_event_handle_cb     handler;
+    void                    *user_data;
+
+    char url[192];          // as configured, e.g. http://ccu.lan:19840/api/status
+    char host[64];
+    char host_header[72];   // host[:port] as sent in the Host header
+    char path[96];
+    char scheme[8];
+    int  port;
+
+    char resolved_url[192]; // url with the host replaced by its cached address
+    bool have_address;      // the client points at resolved_url
+    bool resolved;          // ...and it is current (cleared by a connect failure)
+    bool address_checked;   // this attempt has its address
+
+    // Background lookup, handed between this conn's task and the resolver
+    atomic_int lookup;      // http_lookup_state_t
+    char lookup_addr[48];
+    bool lookup_v6;
+
+    char auth_header[160];  // "Bearer <token>", empty if no token
+
+    bool    https;
+    bool    tls_session_saved;  // a session is available to resume
+    int64_t attempt_start_us;
+    int64_t request_start_us;
+
+    bool connected_this_request;
+    bool in_flight;         // a request is between steps
+    bool retried;           // ...and is on its stale-connection retry
+    bool stream_sent;       // ...and is a stream whose GET has gone out
+    http_conn_stats_t stats;
+} http_conn_t;
+
+// Prepare a connection to url. token may be NULL or empty for no auth.
+// cert_pem is the CA (or self-signed server) certificate for https; NULL
+// verifies against the built-in CA bundle. handler receives all
+// esp_http_client events (user_data in the event is replaced with the one
+// passed here).
+esp_err_t http_conn_init(http_conn_t *conn, const char *url, const char *token,
+                         const char *cert_pem, http_event_handle_cb handler, void *user_data);
+
+// Perform a GET on the connection, reconnecting transparently if the kept-alive
+// connection turns out to be stale. The first call starts the request; call
+// again while it returns ESP_ERR_HTTP_EAGAIN. Handlers see
+// HTTP_EVENT_HEADERS_SENT at the start of every attempt, so per-request state
+// should be reset there.
+esp_err_t http_conn_perform(http_conn_t *conn);
+
+// Streaming request: send the GET and read the response headers, leaving the
+// body to http_conn_read(). Stepped like http_conn_perform(). Check
+// http_conn_status_code() before reading.
+esp_err_t http_conn_open_stream(http_conn_t *conn);
+
+// Read the next body bytes of a stream. Returns the byte count, 0 at the end
+// of the body, -ESP_ERR_HTTP_EAGAIN if nothing has arrived, or another
+// negative value once the connection has failed.
+int http_conn_read(http_conn_t *conn, char *buf, int len);
+
+// Set a request header sent on every following request; value NULL removes it.
+esp_err_t http_conn_set_header(http_conn_t *conn, const char *key, const char *value);
+
+// HTTP status of the last completed request.
+int http_conn_status_code(const http_conn_t *conn);
+
+// Content-Length of the last response, or -1 if it had none (chunked).
+int64_t http_conn_content_length(const http_conn_t *conn);
+
+// Drop the TCP connection (the handle and cached address are kept), along
+// with any request in flight.
+void http_conn_close(http_conn_t *conn);
+
+// Give up on the request in flight (timed out or cancelled), counting it as a
+// failure, and drop the connection.
+void http_conn_abort(http_conn_t *conn);
+
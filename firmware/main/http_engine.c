@@ -0,0 +1,273 @@
+#include "http_engine.h"
+
+#include <stdatomic.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "http_engine";
+
+// Longest sleep with nothing in flight (posts wake it early)
+#define ENGINE_IDLE_MAX_MS 1000
+
+// Body bytes handed to a stream's on_data per step
+#define STREAM_CHUNK 256
+
+// Slots, not lists: callbacks may submit, cancel and arm while the engine is
+// walking them, and a freed slot just reads as NULL
+static http_request_t *s_requests[HTTP_ENGINE_MAX_REQUESTS];
+static http_timer_t *s_timers[HTTP_ENGINE_MAX_TIMERS];
+
+// Timers posted from other tasks, claimed with compare-and-swap so posting
+// never waits on the engine
+static _Atomic(http_timer_t *) s_posted[HTTP_ENGINE_MAX_TIMERS];
+static TaskHandle_t s_task;
+
+static int request_slot(const http_request_t *req)
+{
+    for (int i = 0; i < HTTP_ENGINE_MAX_REQUESTS; i++) {
+        if (s_requests[i] == req) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int timer_slot(const http_timer_t *timer)
+{
+    for (int i = 0; i < HTTP_ENGINE_MAX_TIMERS; i++) {
+        if (s_timers[i] == timer) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t http_engine_submit(http_request_t *req, uint32_t timeout_ms)
+{
+    if (req->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int slot = request_slot(NULL);
+    if (slot < 0) {
+        ESP_LOGE(TAG, "more than %d requests at once", HTTP_ENGINE_MAX_REQUESTS);
+        return ESP_ERR_NO_MEM;
+    }
+    req->deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    req->active = true;
+    req->opened = false;
+    s_requests[slot] = req;
+    return ESP_OK;
+}
+
+static void request_remove(http_request_t *req)
+{
+    int slot = request_slot(req);
+    if (slot >= 0) {
+        s_requests[slot] = NULL;
+    }
+    req->active = false;
+}
+
+void http_engine_cancel(http_request_t *req)
+{
+    if (!req->active) {
+        return;
+    }
+    request_remove(req);
+    http_conn_close(req->conn);
+}
+
+bool http_engine_is_active(const http_request_t *req)
+{
+    return req->active;
+}
+
+void http_engine_arm(http_timer_t *timer, uint32_t delay_ms)
+{
+    timer->at_us = esp_timer_get_time() + (int64_t)delay_ms * 1000;
+    if (timer->armed) {
+        return;
+    }
+    int slot = timer_slot(NULL);
+    if (slot < 0) {
+        ESP_LOGE(TAG, "more than %d timers at once", HTTP_ENGINE_MAX_TIMERS);
+        return;
+    }
+    timer->armed = true;
+    s_timers[slot] = timer;
+}
+
+void http_engine_disarm(http_timer_t *timer)
+{
+    if (!timer->armed) {
+        return;
+    }
+    int slot = timer_slot(timer);
+    if (slot >= 0) {
+        s_timers[slot] = NULL;
+    }
+    timer->armed = false;
+}
+
+void http_engine_post(http_timer_t *timer)
+{
+    // The flag, not the slots, says whether a run is pending: two tasks
+    // posting the same timer must not both find it missing
+    bool expected = false;
+    if (!atomic_compare_exchange_strong(&timer->posted, &expected, true)) {
+        return;
+    }
+    for (int i = 0; i < HTTP_ENGINE_MAX_TIMERS; i++) {
+        http_timer_t *free_slot = NULL;
+        if (atomic_compare_exchange_strong(&s_posted[i], &free_slot, timer)) {
+            if (s_task) {
+                xTaskNotifyGive(s_task);
+            }
+            return;
+        }
+    }
+    atomic_store(&timer->posted, false);
+    ESP_LOGW(TAG, "post dropped: more than %d pending", HTTP_ENGINE_MAX_TIMERS);
+}
+
+static void run_posted(void)
+{
+    for (int i = 0; i < HTTP_ENGINE_MAX_TIMERS; i++) {
+        http_timer_t *timer = atomic_exchange(&s_posted[i], NULL);
+        if (timer) {
+            // Cleared first, so a post made while fn runs isn't lost
+            atomic_store(&timer->posted, false);
+            http_engine_disarm(timer);
+            timer->fn(timer);
+        }
+    }
+}
+
+static void finish(http_request_t *req, esp_err_t err)
+{
+    request_remove(req);
+    if (req->on_done) {
+        req->on_done(req, err);
+    }
+}
+
+// Move a request on as far as its socket allows. True if anything happened
+// (data moved, or the request opened or ended).
+static bool step(http_request_t *req)
+{
+    if (esp_timer_get_time() >= req->deadline_us) {
+        http_conn_abort(req->conn);
+        finish(req, ESP_ERR_TIMEOUT);
+        return true;
+    }
+
+    esp_err_t err;
+    if (req->kind == HTTP_REQUEST_FETCH) {
+        err = http_conn_perform(req->conn);
+        if (err == ESP_ERR_HTTP_EAGAIN) {
+            return false;
+        }
+        finish(req, err);
+        return true;
+    }
+
+    if (!req->opened) {
+        err = http_conn_open_stream(req->conn);
+        if (err == ESP_ERR_HTTP_EAGAIN) {
+            return false;
+        }
+        if (err != ESP_OK) {
+            finish(req, err);
+            return true;
+        }
+        req->opened = true;
+        if (req->on_open) {
+            req->on_open(req);
+        }
+        return true;
+    }
+
+    char buf[STREAM_CHUNK];
+    int n = http_conn_read(req->conn, buf, sizeof(buf));
+    if (n > 0) {
+        if (req->on_data) {
+            req->on_data(req, buf, n);
+        }
+        return true;
+    }
+    if (n == -ESP_ERR_HTTP_EAGAIN) {
+        return false;
+    }
+    // A stream's connection is spent once its body ends
+    http_conn_close(req->conn);
+    finish(req, n == 0 ? ESP_OK : ESP_FAIL);
+    return true;
+}
+
+// Fire the due timers; returns the time to the next one in ms (capped)
+static uint32_t run_timers(void)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t next = now + (int64_t)ENGINE_IDLE_MAX_MS * 1000;
+    for (int i = 0; i < HTTP_ENGINE_MAX_TIMERS; i++) {
+        http_timer_t *timer = s_timers[i];
+        if (!timer) {
+            continue;
+        }
+        if (timer->at_us <= now) {
+            // Free the slot first: the callback usually re-arms
+            s_timers[i] = NULL;
+            timer->armed = false;
+            timer->fn(timer);
+        }
+    }
+    // Anything armed by the callbacks counts too
+    for (int i = 0; i < HTTP_ENGINE_MAX_TIMERS; i++) {
+        if (s_timers[i] && s_timers[i]->at_us < next) {
+            next = s_timers[i]->at_us;
+        }
+    }
+    return next > now ? (uint32_t)((next - now + 999) / 1000) : 0;
+}
+
+static void engine_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        run_posted();
+        uint32_t idle_ms = run_timers();
+
+        bool busy = false;
+        bool progress = false;
+        for (int i = 0; i < HTTP_ENGINE_MAX_REQUESTS; i++) {
+            if (s_requests[i]) {
+                busy = true;
+                progress |= step(s_requests[i]);
+            }
+        }
+
+        if (!busy) {
+            if (idle_ms > 0) {
+                // Until the next timer, or a post from another task
+                TickType_t ticks = pdMS_TO_TICKS(idle_ms);
+                ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+            }
+        } else if (!progress) {
+            // Every request is waiting on the network (each step already
+            // waited a little in the client); let lower priorities run
+            vTaskDelay(1);
+        }
+    }
+}
+
+void http_engine_start(void)
+{
+    xTaskCreate(engine_task, "http_engine", 8192, NULL, 5, &s_task);
+}
+
+TaskHandle_t http_engine_task(void)
+{
+    return s_task;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "http_conn.h"
+
+// One task that runs every HTTP request the firmware makes.
+//
+// Requests are stepped round-robin without blocking (see http_conn.h), so a
+// slow or dead server holds up nothing but its own request, and another
+// server or endpoint costs a request struct rather than a task and its
+// stack. Every request has a deadline: one still running when it passes is
+// aborted and ends with ESP_ERR_TIMEOUT. Timers put other work (the next
+// poll) on the same task, which sleeps until the earliest of them while no
+// request is in flight.
+//
+// Call these from the engine task (request and timer callbacks), or before
+// http_engine_start(); only http_engine_post() may be called from other
+// tasks. Requests and timers belong to the caller and must stay put while
+// submitted, armed or posted.
+
+// Requests running and timers armed at once: two requests (poll and event
+// stream) and a timer per server, with room to spare
+#define HTTP_ENGINE_MAX_REQUESTS 12
+#define HTTP_ENGINE_MAX_TIMERS   8
+
+typedef struct http_request http_request_t;
+
+typedef enum {
+    HTTP_REQUEST_FETCH,     // one whole response, through the conn's event handler
+    HTTP_REQUEST_STREAM,    // a long-lived body, handed to on_data as it arrives
+} http_request_kind_t;
+
+struct http_request {
+    http_conn_t *conn;
+    http_request_kind_t kind;
+
+    // Streams: the response headers are in (whatever the status; the
+    // callback checks it and may cancel), then each run of body bytes
+    void (*on_open)(http_request_t *req);
+    void (*on_data)(http_request_t *req, const char *data, int len);
+
+    // The request is over: ESP_OK (a fetch got its response, a stream was
+    // closed by the server), ESP_ERR_TIMEOUT, or the client's error. Not
+    // called for a cancelled request.
+    void (*on_done)(http_request_t *req, esp_err_t err);
+    void *ctx;
+
+    // esp_timer time the request is given up at. Set by submit; callbacks
+    // may move it (a stream pushes it out as data arrives, as an idle timeout).
+    int64_t deadline_us;
+
+    // Engine state
+    bool active;
+    bool opened;
+};
+
+typedef struct http_timer http_timer_t;
+
+struct http_timer {
+    void (*fn)(http_timer_t *timer);
+    void *ctx;
+
+    // Engine state
+    int64_t at_us;
+    bool armed;
+    atomic_bool posted;     // a post is waiting to run
+};
+
+// Start a request that must finish within timeout_ms. ESP_ERR_INVALID_STATE
+// if it is already running, ESP_ERR_NO_MEM if HTTP_ENGINE_MAX_REQUESTS are.
+esp_err_t http_engine_submit(http_request_t *req, uint32_t timeout_ms);
+
+// Stop a running request and drop its connection; no-op if it isn't running.
+void http_engine_cancel(http_request_t *req);
+
+bool http_engine_is_active(const http_request_t *req);
+
+// Run timer->fn on the engine task delay_ms from now, replacing any earlier
+// arming of the same timer.
+void http_engine_arm(http_timer_t *timer, uint32_t delay_ms);
+void http_engine_disarm(http_timer_t *timer);
+
+// From any task: run timer->fn on the engine task as soon as it is free
+// (waking it if idle), whether or not the timer is armed. Posting a timer
+// whose run is still pending does nothing more.
+void http_engine_post(http_timer_t *timer);
+
+// Start the engine task.
+void http_engine_start(void);
+
+// The engine task (NULL until started), for stack and CPU figures.
+TaskHandle_t http_engine_task(void);
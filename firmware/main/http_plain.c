@@ -0,0 +1,559 @@
+#include "http_plain.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include "esp_log.h"
+
+static const char *TAG = "http_plain";
+
+// lwIP accepts the flag but has no SIGPIPE to suppress
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+typedef enum {
+    PLAIN_IDLE,         // no request (the socket may be open, kept alive)
+    PLAIN_CONNECTING,
+    PLAIN_SENDING,
+    PLAIN_STATUS,       // reading the status line
+    PLAIN_HEADERS,
+    PLAIN_BODY,
+} plain_state_t;
+
+typedef enum {
+    BODY_DONE,
+    BODY_LENGTH,        // remaining bytes of a Content-Length body
+    BODY_CLOSE,         // everything until the server closes
+    BODY_CHUNK_SIZE,
+    BODY_CHUNK_DATA,    // remaining bytes of this chunk
+    BODY_CHUNK_END,     // the CRLF after a chunk
+    BODY_TRAILERS,
+} plain_body_t;
+
+static void emit(http_plain_t *p, esp_http_client_event_id_t id, char *data, int len,
+                 char *key, char *value)
+{
+    if (!p->handler) {
+        return;
+    }
+    esp_http_client_event_t evt = {
+        .event_id = id,
+        .data = data,
+        .data_len = len,
+        .user_data = p->ctx,
+        .header_key = key,
+        .header_value = value,
+    };
+    p->handler(&evt);
+}
+
+// Wait up to wait_ms for the socket to be readable (or writable)
+static bool wait_ready(const http_plain_t *p, bool write)
+{
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(p->fd, &set);
+    struct timeval tv = {
+        .tv_sec = p->wait_ms / 1000,
+        .tv_usec = (p->wait_ms % 1000) * 1000,
+    };
+    return select(p->fd + 1, write ? NULL : &set, write ? &set : NULL, NULL, &tv) > 0;
+}
+
+void http_plain_init(http_plain_t *p, const char *host_header, const char *path,
+                     uint32_t wait_ms, http_event_handle_cb handler, void *ctx)
+{
+    memset(p, 0, sizeof(*p));
+    p->host_header = host_header;
+    p->path = path;
+    p->wait_ms = wait_ms;
+    p->handler = handler;
+    p->ctx = ctx;
+    p->fd = -1;
+    p->content_length = -1;
+}
+
+bool http_plain_set_address(http_plain_t *p, const char *addr, bool v6, int port)
+{
+    memset(&p->addr, 0, sizeof(p->addr));
+    p->addr_len = 0;
+    if (v6) {
+        struct sockaddr_in6 *a = (struct sockaddr_in6 *)&p->addr;
+        a->sin6_family = AF_INET6;
+        a->sin6_port = htons(port);
+        if (inet_pton(AF_INET6, addr, &a->sin6_addr) != 1) {
+            return false;
+        }
+        p->addr_len = sizeof(*a);
+    } else {
+        struct sockaddr_in *a = (struct sockaddr_in *)&p->addr;
+        a->sin_family = AF_INET;
+        a->sin_port = htons(port);
+        if (inet_pton(AF_INET, addr, &a->sin_addr) != 1) {
+            return false;
+        }
+        p->addr_len = sizeof(*a);
+    }
+    return true;
+}
+
+esp_err_t http_plain_set_header(http_plain_t *p, const char *key, const char *value)
+{
+    http_plain_header_t *free_slot = NULL;
+    for (int i = 0; i < HTTP_PLAIN_MAX_HEADERS; i++) {
+        http_plain_header_t *h = &p->headers[i];
+        if (!h->key) {
+            if (!free_slot) {
+                free_slot = h;
+            }
+            continue;
+        }
+        if (strcasecmp(h->key, key) == 0) {
+            free(h->value);
+            h->value = NULL;
+            if (!value) {
+                free(h->key);
+                h->key = NULL;
+                return ESP_OK;
+            }
+            h->value = strdup(value);
+            return h->value ? ESP_OK : ESP_ERR_NO_MEM;
+        }
+    }
+    if (!value) {
+        return ESP_OK;
+    }
+    if (!free_slot) {
+        return ESP_ERR_NO_MEM;
+    }
+    free_slot->key = strdup(key);
+    free_slot->value = strdup(value);
+    if (!free_slot->key || !free_slot->value) {
+        free(free_slot->key);
+        free(free_slot->value);
+        free_slot->key = NULL;
+        free_slot->value = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void http_plain_close(http_plain_t *p)
+{
+    if (p->fd >= 0) {
+        close(p->fd);
+        p->fd = -1;
+    }
+    p->state = PLAIN_IDLE;
+    p->len = 0;
+    p->off = 0;
+}
+
+// Render the request into buf; false if it doesn't fit
+static bool build_request(http_plain_t *p)
+{
+    size_t cap = sizeof(p->buf);
+    int n = snprintf(p->buf, cap, "GET %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: ESP32 HTTP Client/1.0\r\n",
+                     p->path, p->host_header);
+    for (int i = 0; i < HTTP_PLAIN_MAX_HEADERS && n > 0 && (size_t)n < cap; i++) {
+        const http_plain_header_t *h = &p->headers[i];
+        if (h->key) {
+            n += snprintf(p->buf + n, cap - n, "%s: %s\r\n", h->key, h->value);
+        }
+    }
+    if (n > 0 && (size_t)n < cap) {
+        n += snprintf(p->buf + n, cap - n, "\r\n");
+    }
+    if (n <= 0 || (size_t)n >= cap) {
+        return false;
+    }
+    p->len = (size_t)n;
+    p->off = 0;
+    return true;
+}
+
+static esp_err_t connect_start(http_plain_t *p)
+{
+    if (!p->addr_len) {
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    p->fd = socket(p->addr.ss_family, SOCK_STREAM, IPPROTO_TCP);
+    if (p->fd < 0) {
+        ESP_LOGE(TAG, "socket: errno %d", errno);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    int flags = fcntl(p->fd, F_GETFL, 0);
+    fcntl(p->fd, F_SETFL, flags | O_NONBLOCK);
+    int one = 1;
+    setsockopt(p->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(p->fd, (struct sockaddr *)&p->addr, p->addr_len) != 0 && errno != EINPROGRESS) {
+        ESP_LOGD(TAG, "connect: errno %d", errno);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    p->state = PLAIN_CONNECTING;
+    return ESP_OK;
+}
+
+static esp_err_t connect_step(http_plain_t *p)
+{
+    if (!wait_ready(p, true)) {
+        return ESP_ERR_HTTP_EAGAIN;
+    }
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(p->fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+        ESP_LOGD(TAG, "connect: error %d", err);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    p->state = PLAIN_SENDING;
+    emit(p, HTTP_EVENT_ON_CONNECTED, NULL, 0, NULL, NULL);
+    return ESP_OK;
+}
+
+static esp_err_t send_step(http_plain_t *p)
+{
+    while (p->off < p->len) {
+        ssize_t n = send(p->fd, p->buf + p->off, p->len - p->off, MSG_NOSIGNAL);
+        if (n > 0) {
+            p->off += (size_t)n;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!wait_ready(p, true)) {
+                return ESP_ERR_HTTP_EAGAIN;
+            }
+        } else {
+            return ESP_ERR_HTTP_WRITE_DATA;
+        }
+    }
+    p->len = 0;
+    p->off = 0;
+    p->state = PLAIN_STATUS;
+    emit(p, HTTP_EVENT_HEADERS_SENT, NULL, 0, NULL, NULL);
+    return ESP_OK;
+}
+
+// More response bytes into buf: the count, 0 once the server has closed,
+// -ESP_ERR_HTTP_EAGAIN if none arrived in time, -1 on failure
+static int recv_more(http_plain_t *p)
+{
+    if (p->off > 0) {
+        memmove(p->buf, p->buf + p->off, p->len - p->off);
+        p->len -= p->off;
+        p->off = 0;
+    }
+    if (p->len == sizeof(p->buf)) {
+        ESP_LOGW(TAG, "response line over %d bytes", HTTP_PLAIN_BUFFER);
+        return -1;
+    }
+    for (int tries = 0; tries < 2; tries++) {
+        ssize_t n = recv(p->fd, p->buf + p->len, sizeof(p->buf) - p->len, 0);
+        if (n >= 0) {
+            p->len += (size_t)n;
+            return (int)n;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            return -1;
+        }
+        if (!wait_ready(p, false)) {
+            break;
+        }
+    }
+    return -ESP_ERR_HTTP_EAGAIN;
+}
+
+// The next line, without its CRLF, in *line (valid until the next read): 1,
+// -ESP_ERR_HTTP_EAGAIN, or -1 if the connection failed or closed first
+static int read_line(http_plain_t *p, char **line)
+{
+    while (1) {
+        char *start = p->buf + p->off;
+        char *nl = memchr(start, '\n', p->len - p->off);
+        if (nl) {
+            *nl = '\0';
+            if (nl > start && nl[-1] == '\r') {
+                nl[-1] = '\0';
+            }
+            p->off = (size_t)(nl + 1 - p->buf);
+            *line = start;
+            return 1;
+        }
+        int n = recv_more(p);
+        if (n == 0) {
+            return -1;
+        }
+        if (n < 0) {
+            return n;
+        }
+    }
+}
+
+// A response header: note the framing, then pass it on
+static void on_header(http_plain_t *p, char *line)
+{
+    char *colon = strchr(line, ':');
+    if (!colon) {
+        return;
+    }
+    *colon = '\0';
+    char *value = colon + 1;
+    while (*value == ' ' || *value == '\t') {
+        value++;
+    }
+    size_t len = strlen(value);
+    while (len > 0 && (value[len - 1] == ' ' || value[len - 1] == '\t')) {
+        value[--len] = '\0';
+    }
+
+    if (strcasecmp(line, "Content-Length") == 0) {
+        p->content_length = strtoll(value, NULL, 10);
+    } else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+        // chunked is always the last coding
+        if (len >= 7 && strcasecmp(value + len - 7, "chunked") == 0) {
+            p->body = BODY_CHUNK_SIZE;
+        }
+    } else if (strcasecmp(line, "Connection") == 0) {
+        if (strcasecmp(value, "close") == 0) {
+            p->keep_alive = false;
+        } else if (strcasecmp(value, "keep-alive") == 0) {
+            p->keep_alive = true;
+        }
+    }
+    emit(p, HTTP_EVENT_ON_HEADER, NULL, 0, line, value);
+}
+
+static esp_err_t headers_step(http_plain_t *p)
+{
+    char *line;
+    while (p->state == PLAIN_STATUS || p->state == PLAIN_HEADERS) {
+        int r = read_line(p, &line);
+        if (r == -ESP_ERR_HTTP_EAGAIN) {
+            return ESP_ERR_HTTP_EAGAIN;
+        }
+        if (r < 0) {
+            return ESP_ERR_HTTP_FETCH_HEADER;
+        }
+
+        if (p->state == PLAIN_STATUS) {
+            // "HTTP/1.x NNN reason"
+            if (strncmp(line, "HTTP/1.", 7) != 0 || strlen(line) < 12) {
+                ESP_LOGW(TAG, "bad status line");
+                return ESP_ERR_HTTP_FETCH_HEADER;
+            }
+            p->keep_alive = line[7] == '1';
+            p->status = atoi(line + 9);
+            p->content_length = -1;
+            p->body = BODY_DONE;
+            p->state = PLAIN_HEADERS;
+            continue;
+        }
+        if (line[0] != '\0') {
+            on_header(p, line);
+            continue;
+        }
+
+        // End of the headers
+        if (p->status >= 100 && p->status < 200) {
+            p->state = PLAIN_STATUS;        // an interim response; the real one follows
+            continue;
+        }
+        if (p->status == 204 || p->status == 304) {
+            p->body = BODY_DONE;
+        } else if (p->body != BODY_CHUNK_SIZE) {
+            if (p->content_length >= 0) {
+                p->body = BODY_LENGTH;
+                p->remaining = (uint64_t)p->content_length;
+            } else {
+                p->body = BODY_CLOSE;
+                p->keep_alive = false;
+            }
+        }
+        p->state = PLAIN_BODY;
+    }
+    return ESP_OK;
+}
+
+// Start, connect, send and read the headers, as far as the socket allows:
+// ESP_OK once the body is next
+static esp_err_t request_step(http_plain_t *p)
+{
+    esp_err_t err = ESP_OK;
+    if (p->state == PLAIN_IDLE) {
+        if (!build_request(p)) {
+            ESP_LOGE(TAG, "request headers over %d bytes", HTTP_PLAIN_BUFFER);
+            return ESP_ERR_HTTP_WRITE_DATA;
+        }
+        if (p->fd >= 0) {
+            p->state = PLAIN_SENDING;       // on the kept-alive connection
+        } else {
+            err = connect_start(p);
+        }
+    }
+    if (err == ESP_OK && p->state == PLAIN_CONNECTING) {
+        err = connect_step(p);
+    }
+    if (err == ESP_OK && p->state == PLAIN_SENDING) {
+        err = send_step(p);
+    }
+    if (err == ESP_OK && (p->state == PLAIN_STATUS || p->state == PLAIN_HEADERS)) {
+        err = headers_step(p);
+    }
+    if (err != ESP_OK && err != ESP_ERR_HTTP_EAGAIN) {
+        http_plain_close(p);
+    }
+    return err;
+}
+
+// The next run of body bytes, at most max, left in buf at *data: as for
+// http_plain_read()
+static int body_next(http_plain_t *p, char **data, size_t max)
+{
+    char *line;
+    int r;
+    while (1) {
+        switch (p->body) {
+        case BODY_DONE:
+            return 0;
+        case BODY_LENGTH:
+        case BODY_CHUNK_DATA:
+        case BODY_CLOSE: {
+            if (p->body != BODY_CLOSE && p->remaining == 0) {
+                p->body = p->body == BODY_LENGTH ? BODY_DONE : BODY_CHUNK_END;
+                continue;
+            }
+            if (p->off == p->len) {
+                r = recv_more(p);
+                if (r == 0) {
+                    // Closed: the end of a read-until-close body, or one cut
+                    // short (the caller sees less than Content-Length)
+                    p->keep_alive = false;
+                    if (p->body == BODY_CHUNK_DATA) {
+                        return -1;
+                    }
+                    p->body = BODY_DONE;
+                    return 0;
+                }
+                if (r < 0) {
+                    return r;
+                }
+            }
+            size_t n = p->len - p->off;
+            if (n > max) {
+                n = max;
+            }
+            if (p->body != BODY_CLOSE) {
+                if (n > p->remaining) {
+                    n = (size_t)p->remaining;
+                }
+                p->remaining -= n;
+            }
+            *data = p->buf + p->off;
+            p->off += n;
+            return (int)n;
+        }
+        case BODY_CHUNK_SIZE: {
+            if ((r = read_line(p, &line)) < 0) {
+                return r;
+            }
+            char *end;
+            p->remaining = strtoull(line, &end, 16);
+            if (end == line) {
+                ESP_LOGW(TAG, "bad chunk size");
+                return -1;
+            }
+            p->body = p->remaining ? BODY_CHUNK_DATA : BODY_TRAILERS;
+            break;
+        }
+        case BODY_CHUNK_END:
+            if ((r = read_line(p, &line)) < 0) {
+                return r;
+            }
+            p->body = BODY_CHUNK_SIZE;
+            break;
+        case BODY_TRAILERS:
+            if ((r = read_line(p, &line)) < 0) {
+                return r;
+            }
+            if (line[0] == '\0') {
+                p->body = BODY_DONE;
+            }
+            break;
+        }
+    }
+}
+
+// The body is over: keep the socket for the next request if the server will
+static void request_done(http_plain_t *p)
+{
+    p->state = PLAIN_IDLE;
+    if (!p->keep_alive || p->off != p->len) {
+        http_plain_close(p);
+    }
+    p->len = 0;
+    p->off = 0;
+}
+
+esp_err_t http_plain_perform(http_plain_t *p)
+{
+    esp_err_t err = request_step(p);
+    if (err != ESP_OK) {
+        return err;
+    }
+    while (1) {
+        char *data;
+        int n = body_next(p, &data, sizeof(p->buf));
+        if (n > 0) {
+            emit(p, HTTP_EVENT_ON_DATA, data, n, NULL, NULL);
+            continue;
+        }
+        if (n == -ESP_ERR_HTTP_EAGAIN) {
+            return ESP_ERR_HTTP_EAGAIN;
+        }
+        if (n < 0) {
+            http_plain_close(p);
+            return ESP_FAIL;
+        }
+        request_done(p);
+        emit(p, HTTP_EVENT_ON_FINISH, NULL, 0, NULL, NULL);
+        return ESP_OK;
+    }
+}
+
+esp_err_t http_plain_open(http_plain_t *p)
+{
+    return request_step(p);
+}
+
+int http_plain_read(http_plain_t *p, char *buf, int len)
+{
+    if (p->state != PLAIN_BODY || len <= 0) {
+        return -1;
+    }
+    char *data;
+    int n = body_next(p, &data, (size_t)len);
+    if (n > 0) {
+        memcpy(buf, data, (size_t)n);
+    } else if (n == 0) {
+        request_done(p);
+    } else if (n != -ESP_ERR_HTTP_EAGAIN) {
+        http_plain_close(p);
+    }
+    return n;
+}
+
+int http_plain_status_code(const http_plain_t *p)
+{
+    return p->status;
+}
+
+int64_t http_plain_content_length(const http_plain_t *p)
+{
+    return p->content_length;
+}
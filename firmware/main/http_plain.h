@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include "esp_err.h"
+#include "esp_http_client.h"
+
+// HTTP/1.1 GET over a plain TCP socket, stepped without blocking, for
+// http:// servers: esp_http_client's async mode only supports HTTPS, so
+// http_conn.h uses this instead for plain HTTP.
+//
+// It steps the way http_conn.h does. Each call waits at most wait_ms on the
+// socket and returns ESP_ERR_HTTP_EAGAIN until the request is done. Events go
+// to an esp_http_client event handler (with client NULL): ON_CONNECTED,
+// HEADERS_SENT at the start of every attempt, ON_HEADER, ON_DATA and
+// ON_FINISH. The socket is kept alive between requests unless the server
+// says otherwise.
+//
+// Bodies may be Content-Length, chunked or read until the server closes.
+// There are no redirects, auth challenges or request bodies; CCU needs none.
+
+#define HTTP_PLAIN_MAX_HEADERS 8
+
+// Holds the request going out, then the response coming in; no status or
+// header line may be longer
+#define HTTP_PLAIN_BUFFER      1024
+
+typedef struct {
+    char *key;
+    char *value;
+} http_plain_header_t;
+
+typedef struct {
+    const char          *host_header;   // host[:port] for the Host header
+    const char          *path;
+    uint32_t             wait_ms;
+    http_event_handle_cb handler;
+    void                *ctx;           // the events' user_data
+
+    struct sockaddr_storage addr;
+    socklen_t               addr_len;   // 0 until an address is set
+    http_plain_header_t     headers[HTTP_PLAIN_MAX_HEADERS];
+
+    int      fd;                // -1 while not connected
+    bool     keep_alive;        // the server takes another request on fd
+    uint8_t  state;             // where the request is
+    uint8_t  body;              // how the response body is framed, and where in it
+    int      status;
+    int64_t  content_length;    // -1 if the response has none (chunked)
+    uint64_t remaining;         // bytes left of the body or the current chunk
+    char     buf[HTTP_PLAIN_BUFFER];
+    size_t   len;               // bytes in buf
+    size_t   off;               // ...of which consumed
+} http_plain_t;
+
+// Prepare p for GETs of path on host_header; both strings must outlive it.
+void http_plain_init(http_plain_t *p, const char *host_header, const char *path,
+                     uint32_t wait_ms, http_event_handle_cb handler, void *ctx);
+
+// Connect to addr (an IPv4 or IPv6 literal) from the next connection on.
+bool http_plain_set_address(http_plain_t *p, const char *addr, bool v6, int port);
+
+// Send key on every following request; value NULL removes it.
+esp_err_t http_plain_set_header(http_plain_t *p, const char *key, const char *value);
+
+// Step a whole GET, the body going to ON_DATA events.
+esp_err_t http_plain_perform(http_plain_t *p);
+
+// Step a GET up to the end of its response headers, leaving the body to
+// http_plain_read().
+esp_err_t http_plain_open(http_plain_t *p);
+
+// Next body bytes: the count, 0 at the end of the body, -ESP_ERR_HTTP_EAGAIN
+// if none have arrived, or -1 once the connection has failed.
+int http_plain_read(http_plain_t *p, char *buf, int len);
+
+int http_plain_status_code(const http_plain_t *p);
+int64_t http_plain_content_length(const http_plain_t *p);
+
+// Drop the socket and any request in flight.
+void http_plain_close(http_plain_t *p);
@@ -1,3 +1,4 @@
+#include <stdatomic.h>
 #include <stdio.h>
 #include <time.h>
 
@@ -11,40 +12,63 @@
 #include "config.h"
 #include "wifi.h"
 #include "http_client.h"
+#include "boot_timeline.h"
+#include "history.h"
+#include "status_cache.h"
+#include "status_server.h"
 
 #include "ui/ui.h"
 
 static const char *TAG = "espclaude";
 
-static void sntp_init_time(void)
+// Time sync completes in the background; nothing waits on it. Until it does
+// the clock reads 1970: history is held back and countdowns run from boot.
+static void time_synced_cb(struct timeval *tv)
 {
-    ESP_LOGI(TAG, "initialising SNTP");
-    esp_sntp_setoperatingmode(ESP_SNTP_OPMODE_POLL);
-    esp_sntp_setservername(0, NTP_SERVER_1);
-    esp_sntp_setservername(1, NTP_SERVER_2);
-    esp_sntp_init();
+    boot_timeline_mark(BOOT_TIME_SYNCED);
 
-    // Wait for time to be set (timeout after ~10s)
-    int retry = 0;
-    while (esp_sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET && retry < 20) {
-        vTaskDelay(pdMS_TO_TICKS(500));
-        retry++;
-    }
-
-    time_t now;
+    time_t now = tv->tv_sec;
     struct tm timeinfo;
-    time(&now);
     localtime_r(&now, &timeinfo);
     char strftime_buf[32];
     strftime(strftime_buf, sizeof(strftime_buf), "%Y-%m-%d %H:%M:%S", &timeinfo);
     ESP_LOGI(TAG, "current time: %s", strftime_buf);
 }
 
+static void sntp_start(void)
+{
+    ESP_LOGI(TAG, "initialising SNTP");
+    esp_sntp_setoperatingmode(ESP_SNTP_OPMODE_POLL);
+    esp_sntp_setservername(0, NTP_SERVER_1);
+    esp_sntp_setservername(1, NTP_SERVER_2);
+    sntp_set_time_sync_notification_cb(time_synced_cb);
+    esp_sntp_init();
+}
+
+static lv_timer_t *s_ui_timer;
+
+// HTTP starts before the display; until the LVGL port is up its lock
+// doesn't exist yet
+static atomic_bool s_display_started;
+
 static void ui_update_timer_cb(lv_timer_t *timer)
 {
     ui_update();
 }
 
+// New status from the HTTP engine task: paint it now rather than on the next tick
+static void status_arrived(void)
+{
+    if (!atomic_load(&s_display_started)) {
+        return;                     // ui_init() paints what is there
+    }
+    bsp_display_lock(0);
+    if (s_ui_timer) {               // else ui_init() paints what is there
+        lv_timer_ready(s_ui_timer);
+    }
+    bsp_display_unlock();
+}
+
 void app_main(void)
 {
     // Initialise NVS (required for WiFi)
@@ -55,40 +79,44 @@ void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
+    // Start associating first: it takes longest, and everything below runs
+    // while it does. Nothing waits for it except the HTTP requests.
+    ESP_LOGI(TAG, "connecting to WiFi...");
+    wifi_init_sta();
+
+    // Restore usage history and the last status from flash before anything
+    // draws or appends to them
+    history_init();
+    status_data_t cached;
+    if (status_cache_load(&cached) == ESP_OK) {
+        http_client_restore_status(&cached);
+    }
+
+    // The first polls go out as soon as there is an IP address; SNTP syncs
+    // alongside them
+    http_client_on_status(status_arrived);
+    http_client_start();
+    status_server_start();
+    sntp_start();
+
     // Initialise BSP display
     bsp_display_start();
+    atomic_store(&s_display_started, true);
     bsp_display_backlight_on();
-
-    ESP_LOGI(TAG, "display initialised");
-
-    // Create the HTTP client mutex BEFORE any LVGL timers that call http_client_get_status().
-    // Without this, the timer callback would xSemaphoreTake(NULL) and trigger a panic.
-    http_client_init();
+    boot_timeline_mark(BOOT_DISPLAY_UP);
 
     // Lock LVGL mutex for UI setup
     bsp_display_lock(0);
 
-    // Create UI
+    // Create UI (painting the cached status, if any, in the first frame)
     ui_init();
 
     // Create an LVGL timer to update the UI every second
-    lv_timer_create(ui_update_timer_cb, UI_COUNTDOWN_MS, NULL);
+    s_ui_timer = lv_timer_create(ui_update_timer_cb, UI_COUNTDOWN_MS, NULL);
+    // A status may have landed while the UI was being built
+    lv_timer_ready(s_ui_timer);
 
     bsp_display_unlock();
 
-    // Connect to WiFi (non-blocking: times out after 15s but keeps retrying)
-    ESP_LOGI(TAG, "connecting to WiFi...");
-    ret = wifi_init_sta();
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "WiFi connected");
-    } else {
-        ESP_LOGW(TAG, "WiFi not yet connected, will keep retrying in background");
-    }
-
-    // Start NTP and HTTP regardless -- both tolerate no connectivity and
-    // will begin working once WiFi connects (even if that's later).
-    sntp_init_time();
-    http_client_start();
-
     ESP_LOGI(TAG, "espclaude firmware running");
 }
@@ -0,0 +1,194 @@
+#include "poll_scheduler.h"
+#include "config.h"
+
+// Adaptive polling defaults (see config.h.example)
+#ifndef POLL_BUSY_INTERVAL_MS
+#define POLL_BUSY_INTERVAL_MS 10000
+#endif
+#ifndef POLL_IDLE_INTERVAL_MS
+#define POLL_IDLE_INTERVAL_MS 60000
+#endif
+#ifndef POLL_BUSY_BURN_PER_HOUR
+#define POLL_BUSY_BURN_PER_HOUR 5.0f
+#endif
+#ifndef POLL_BACKOFF_MAX_MS
+#define POLL_BACKOFF_MAX_MS 120000
+#endif
+#ifndef POLL_CIRCUIT_FAILURES
+#define POLL_CIRCUIT_FAILURES 6
+#endif
+#ifndef POLL_CIRCUIT_OPEN_MS
+#define POLL_CIRCUIT_OPEN_MS 300000
+#endif
+#ifndef POLL_ALIGN_MARGIN_MS
+#define POLL_ALIGN_MARGIN_MS 1500
+#endif
+
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+
+static const char *TAG = "poll_scheduler";
+
+// Spread of the steady intervals, as a fraction of the interval
+#define STEADY_JITTER_PCT 10
+
+// Refresh estimates this close together are the same refresh: data_age is
+// whole seconds, and the request takes a moment
+#define SAME_REFRESH_US 2000000
+
+static const char *const s_state_names[] = {
+    [POLL_STATE_STARTING] = "starting",
+    [POLL_STATE_NORMAL]   = "normal",
+    [POLL_STATE_BUSY]     = "busy",
+    [POLL_STATE_IDLE]     = "idle",
+    [POLL_STATE_BACKOFF]  = "backoff",
+    [POLL_STATE_OPEN]     = "circuit open",
+};
+
+// Uniform in [base - spread, base + spread]
+static uint32_t jitter(uint32_t base, uint32_t spread)
+{
+    if (spread == 0) {
+        return base;
+    }
+    return base - spread + esp_random() % (2 * spread + 1);
+}
+
+static uint32_t schedule(poll_scheduler_t *s, poll_state_t state, uint32_t delay_ms)
+{
+    if (state != s->state) {
+        ESP_LOGI(TAG, "%s -> %s, next poll in %u ms", s_state_names[s->state],
+                 s_state_names[state], (unsigned)delay_ms);
+    }
+    s->state = state;
+    s->delay_ms = delay_ms;
+    s->next_at_us = esp_timer_get_time() + (int64_t)delay_ms * 1000;
+    return delay_ms;
+}
+
+void poll_scheduler_init(poll_scheduler_t *s)
+{
+    s->state = POLL_STATE_STARTING;
+    s->failures = 0;
+    s->delay_ms = 0;
+    s->next_at_us = esp_timer_get_time();
+    s->refresh_at_us = 0;
+    s->cadence_ms = 0;
+}
+
+// Fold one observation of the server's data age into the refresh estimate
+static void learn_refresh(poll_scheduler_t *s, int64_t now_us, int data_age_s)
+{
+    // data_age is truncated, so this is at or just after the actual refresh
+    int64_t refresh_us = now_us - (int64_t)data_age_s * 1000000;
+
+    if (s->refresh_at_us == 0 || refresh_us < s->refresh_at_us - SAME_REFRESH_US) {
+        // First sighting, or the server went back in time (restarted): start over
+        s->refresh_at_us = refresh_us;
+        s->cadence_ms = 0;
+        return;
+    }
+    if (refresh_us <= s->refresh_at_us + SAME_REFRESH_US) {
+        // The same refresh seen again; the earliest estimate is the closest
+        if (refresh_us < s->refresh_at_us) {
+            s->refresh_at_us = refresh_us;
+        }
+        return;
+    }
+
+    // A new refresh. Polls that are further apart than the server's refreshes
+    // only see every second or third one, so a much shorter gap replaces the
+    // estimate, a much longer one is ignored and the rest are averaged in.
+    uint32_t gap_ms = (uint32_t)((refresh_us - s->refresh_at_us) / 1000);
+    s->refresh_at_us = refresh_us;
+    if (s->cadence_ms == 0 || gap_ms < s->cadence_ms * 3 / 4) {
+        s->cadence_ms = gap_ms;
+        ESP_LOGI(TAG, "server refreshes about every %us", (unsigned)(gap_ms + 500) / 1000);
+    } else if (gap_ms <= s->cadence_ms * 3 / 2) {
+        s->cadence_ms = (s->cadence_ms * 3 + gap_ms) / 4;
+    }
+}
+
+// Move a delay to land just after an expected server refresh: the last one
+// before now + delay_ms, or the first one after now if none falls in between.
+// Never later than POLL_IDLE_INTERVAL_MS, in case the cadence was learned
+// across a stall.
+static uint32_t align_to_refresh(const poll_scheduler_t *s, int64_t now_us, uint32_t delay_ms)
+{
+    int64_t cadence_us = (int64_t)s->cadence_ms * 1000;
+    int64_t margin_us = (int64_t)POLL_ALIGN_MARGIN_MS * 1000;
+    int64_t deadline_us = now_us + (int64_t)delay_ms * 1000;
+
+    // Refreshes after the last one seen, latest at or before the deadline
+    int64_t target_us = s->refresh_at_us + cadence_us + margin_us;
+    if (target_us <= deadline_us) {
+        target_us += (deadline_us - target_us) / cadence_us * cadence_us;
+    }
+    if (target_us <= now_us) {
+        target_us += ((now_us - target_us) / cadence_us + 1) * cadence_us;
+    }
+    // A little spread so boxes on the same server don't all land at once
+    target_us += esp_random() % (uint32_t)(margin_us / 2 + 1);
+
+    uint32_t aligned_ms = (uint32_t)((target_us - now_us) / 1000);
+    uint32_t limit_ms = delay_ms > POLL_IDLE_INTERVAL_MS ? delay_ms : POLL_IDLE_INTERVAL_MS;
+    return aligned_ms <= limit_ms ? aligned_ms : delay_ms;
+}
+
+uint32_t poll_scheduler_success(poll_scheduler_t *s, float burn_cost_per_hour, int data_age_s)
+{
+    int64_t now_us = esp_timer_get_time();
+    if (data_age_s >= 0) {
+        learn_refresh(s, now_us, data_age_s);
+    }
+
+    if (s->state == POLL_STATE_OPEN) {
+        ESP_LOGI(TAG, "server answering again after %u failures", (unsigned)s->failures);
+    }
+    s->failures = 0;
+
+    poll_state_t state = POLL_STATE_NORMAL;
+    uint32_t interval = POLL_INTERVAL_MS;
+    if (burn_cost_per_hour >= POLL_BUSY_BURN_PER_HOUR) {
+        state = POLL_STATE_BUSY;
+        interval = POLL_BUSY_INTERVAL_MS;
+    } else if (burn_cost_per_hour <= 0.0f) {
+        state = POLL_STATE_IDLE;
+        interval = POLL_IDLE_INTERVAL_MS;
+    }
+    if (s->cadence_ms == 0) {
+        return schedule(s, state, jitter(interval, interval / 100 * STEADY_JITTER_PCT));
+    }
+    return schedule(s, state, align_to_refresh(s, now_us, interval));
+}
+
+uint32_t poll_scheduler_failure(poll_scheduler_t *s)
+{
+    s->failures++;
+
+    if (s->failures >= POLL_CIRCUIT_FAILURES) {
+        if (s->state != POLL_STATE_OPEN) {
+            ESP_LOGW(TAG, "%u failures in a row, backing off for %us", (unsigned)s->failures,
+                     POLL_CIRCUIT_OPEN_MS / 1000);
+        }
+        return schedule(s, POLL_STATE_OPEN,
+                        jitter(POLL_CIRCUIT_OPEN_MS, POLL_CIRCUIT_OPEN_MS / 100 * STEADY_JITTER_PCT));
+    }
+
+    // Exponential from the fast interval, capped; half fixed and half random
+    // so retries from many boxes spread over the whole window
+    uint32_t backoff = POLL_FAST_INTERVAL_MS;
+    for (uint32_t i = 1; i < s->failures && backoff < POLL_BACKOFF_MAX_MS; i++) {
+        backoff *= 2;
+    }
+    if (backoff > POLL_BACKOFF_MAX_MS) {
+        backoff = POLL_BACKOFF_MAX_MS;
+    }
+    return schedule(s, POLL_STATE_BACKOFF, backoff / 2 + esp_random() % (backoff / 2 + 1));
+}
+
+const char *poll_scheduler_state_name(poll_state_t state)
+{
+    return s_state_names[state];
+}
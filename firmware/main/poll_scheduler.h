@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Decides when a server is asked for its status next.
+//
+// While things work the interval follows usage: POLL_BUSY_INTERVAL_MS while
+// the burn rate is high, POLL_IDLE_INTERVAL_MS while nothing is being spent,
+// POLL_INTERVAL_MS otherwise. Failures (the first poll's included) are
+// retried after POLL_FAST_INTERVAL_MS, doubling up to POLL_BACKOFF_MAX_MS.
+// After POLL_CIRCUIT_FAILURES in a row the circuit opens and the server is
+// left alone for POLL_CIRCUIT_OPEN_MS; then a single probe either closes it
+// again or keeps it open another period. Every delay is jittered so boxes
+// that rebooted together drift apart.
+//
+// The server only refreshes its own data every so often, and each status
+// says how old that data is (data_age_seconds). From that the scheduler
+// tracks when the server last refreshed and, from the gaps between
+// refreshes, how often it does; successful polls are then moved to land
+// POLL_ALIGN_MARGIN_MS after an expected refresh (the last one before the
+// usage-driven deadline, or the next one if none falls before it), so each
+// request picks up the freshest data and no poll goes out between refreshes
+// only to be answered with the same numbers.
+//
+// One per server, owned by the HTTP engine task; the UI reads a copy without
+// locking.
+
+typedef enum {
+    POLL_STATE_STARTING,        // no response yet
+    POLL_STATE_NORMAL,
+    POLL_STATE_BUSY,            // high burn rate
+    POLL_STATE_IDLE,            // nothing being spent
+    POLL_STATE_BACKOFF,         // recent failures
+    POLL_STATE_OPEN,            // circuit open: too many failures in a row
+} poll_state_t;
+
+typedef struct {
+    poll_state_t state;
+    uint32_t failures;          // consecutive failed polls
+    uint32_t delay_ms;          // last delay handed out
+    int64_t  next_at_us;        // esp_timer time of the next poll
+
+    int64_t  refresh_at_us;     // estimated time of the server's last refresh (0 = unknown)
+    uint32_t cadence_ms;        // estimated server refresh interval (0 = unknown)
+} poll_scheduler_t;
+
+void poll_scheduler_init(poll_scheduler_t *s);
+
+// Record a successful poll, with the current burn rate (0 when the status
+// carries none) and the age of the server's data (-1 for a 304, which carries
+// no body). Returns the delay until the next poll.
+uint32_t poll_scheduler_success(poll_scheduler_t *s, float burn_cost_per_hour, int data_age_s);
+
+// Record a failed poll (timeout, refused, HTTP error, bad body).
+// Returns the delay until the next poll.
+uint32_t poll_scheduler_failure(poll_scheduler_t *s);
+
+// Short state name for logs and the Settings tab ("normal", "backoff", ...).
+const char *poll_scheduler_state_name(poll_state_t state);
@@ -0,0 +1,142 @@
+#include "sse_parser.h"
+
+#include <string.h>
+
+enum {
+    ST_LINE_START,
+    ST_FIELD,       // reading the field name
+    ST_SPACE,       // just after ':' (one leading space is dropped)
+    ST_DATA,        // "data" value, streamed to on_data
+    ST_NAME,        // "event" value, kept in name
+    ST_IGNORE,      // comment or unused field, skipped to end of line
+};
+
+#define FIELD_TOO_LONG 0xff
+
+void sse_parser_init(sse_parser_t *p, const sse_callbacks_t *cb)
+{
+    memset(p, 0, sizeof(*p));
+    p->cb = *cb;
+}
+
+static bool field_is(const sse_parser_t *p, const char *name)
+{
+    return p->field_len != FIELD_TOO_LONG && p->field_len == strlen(name) &&
+           memcmp(p->field, name, p->field_len) == 0;
+}
+
+// A data line starts: open the event, or separate it from the previous line
+static void begin_data_line(sse_parser_t *p)
+{
+    if (!p->has_data) {
+        p->has_data = true;
+        if (p->cb.on_begin) {
+            p->cb.on_begin(p->cb.ctx);
+        }
+    } else if (p->cb.on_data) {
+        p->cb.on_data(p->cb.ctx, "\n", 1);
+    }
+}
+
+// Field name complete: pick where its value goes
+static uint8_t value_state(sse_parser_t *p)
+{
+    if (field_is(p, "data")) {
+        begin_data_line(p);
+        return ST_DATA;
+    }
+    if (field_is(p, "event")) {
+        p->name_len = 0;
+        p->name[0] = '\0';
+        return ST_NAME;
+    }
+    return ST_IGNORE;
+}
+
+static void end_of_line(sse_parser_t *p)
+{
+    switch (p->state) {
+    case ST_LINE_START:
+        // Blank line: dispatch the event, if it carried any data
+        if (p->has_data && p->cb.on_event) {
+            p->cb.on_event(p->cb.ctx, p->name);
+        }
+        p->has_data = false;
+        p->name_len = 0;
+        p->name[0] = '\0';
+        break;
+    case ST_FIELD:
+    case ST_SPACE:
+        // No colon, or nothing after it: the field has an empty value
+        value_state(p);
+        break;
+    default:
+        break;
+    }
+    p->state = ST_LINE_START;
+}
+
+void sse_parser_feed(sse_parser_t *p, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+
+        if (c == '\n' && p->last_cr) {
+            // Second half of a CRLF; the CR already ended the line
+            p->last_cr = false;
+            continue;
+        }
+        p->last_cr = c == '\r';
+        if (c == '\r' || c == '\n') {
+            end_of_line(p);
+            continue;
+        }
+
+        switch (p->state) {
+        case ST_LINE_START:
+            if (c == ':') {
+                p->state = ST_IGNORE;
+                break;
+            }
+            p->field_len = 0;
+            p->state = ST_FIELD;
+            // fall through
+        case ST_FIELD:
+            if (c == ':') {
+                p->state = ST_SPACE;
+            } else if (p->field_len < sizeof(p->field)) {
+                p->field[p->field_len++] = c;
+            } else {
+                p->field_len = FIELD_TOO_LONG;
+            }
+            break;
+        case ST_SPACE:
+            p->state = value_state(p);
+            if (c == ' ') {
+                break;
+            }
+            i--;    // reprocess this byte as part of the value
+            break;
+        case ST_DATA: {
+            // Hand over the rest of the line in one piece
+            size_t end = i;
+            while (end < len && data[end] != '\r' && data[end] != '\n') {
+                end++;
+            }
+            if (p->cb.on_data) {
+                p->cb.on_data(p->cb.ctx, data + i, end - i);
+            }
+            i = end - 1;
+            break;
+        }
+        case ST_NAME:
+            if (p->name_len < sizeof(p->name) - 1) {
+                p->name[p->name_len++] = c;
+                p->name[p->name_len] = '\0';
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
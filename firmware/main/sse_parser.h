@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Incremental parser for a text/event-stream (Server-Sent Events) body.
+//
+// Bytes are fed in arbitrary chunks. The value of each "data:" field is
+// handed to on_data as it arrives, without buffering the event, with
+// consecutive data lines joined by '\n' as the spec requires. on_event fires
+// at the blank line that ends an event. Comments, "id" and "retry" are ignored.
+
+#define SSE_EVENT_NAME_LEN 24
+
+typedef struct {
+    // Start of an event's data (first byte of its first data line)
+    void (*on_begin)(void *ctx);
+    // Next piece of the event's data
+    void (*on_data)(void *ctx, const char *data, size_t len);
+    // End of an event that carried data; name is "" when no "event:" field
+    void (*on_event)(void *ctx, const char *name);
+    void *ctx;
+} sse_callbacks_t;
+
+typedef struct {
+    sse_callbacks_t cb;
+
+    uint8_t state;
+    char    field[8];       // field name being read (longer names are ignored)
+    uint8_t field_len;
+    bool    has_data;       // the current event has at least one data line
+    bool    last_cr;        // previous byte was CR (a following LF is part of it)
+
+    char    name[SSE_EVENT_NAME_LEN];
+    uint8_t name_len;
+} sse_parser_t;
+
+void sse_parser_init(sse_parser_t *p, const sse_callbacks_t *cb);
+
+// Consume the next chunk of the stream.
+void sse_parser_feed(sse_parser_t *p, const char *data, size_t len);
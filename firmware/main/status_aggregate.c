@@ -0,0 +1,142 @@
+#include "status_aggregate.h"
+
+#include <string.h>
+
+typedef struct {
+    char  model[32];
+    float cost;
+} model_cost_t;
+
+// Highest-utilisation copy of one tier across the statuses; returns the index
+// it came from, -1 if no status has the tier
+static int aggregate_tier(const status_data_t *const *statuses, size_t n,
+                          size_t offset, usage_tier_t *out)
+{
+    int from = -1;
+    memset(out, 0, sizeof(*out));
+    for (size_t i = 0; i < n; i++) {
+        const usage_tier_t *tier = (const usage_tier_t *)((const char *)statuses[i] + offset);
+        if (tier->present && (from < 0 || tier->utilisation > out->utilisation)) {
+            *out = *tier;
+            from = (int)i;
+        }
+    }
+    return from;
+}
+
+// Model shares are of each instance's session cost; weight them by that
+// cost (equally when nothing has been spent yet) and keep the largest
+static void aggregate_models(const status_data_t *const *statuses, size_t n, status_data_t *out)
+{
+    model_cost_t merged[MAX_MODELS * 4];
+    size_t count = 0;
+    float total = 0.0f;
+
+    float spent = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        spent += statuses[i]->session_cost_usd;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const status_data_t *s = statuses[i];
+        float weight = spent > 0.0f ? s->session_cost_usd : 1.0f;
+        for (int m = 0; m < s->model_count && m < MAX_MODELS; m++) {
+            float cost = s->models[m].cost_pct / 100.0f * weight;
+            size_t j = 0;
+            while (j < count && strcmp(merged[j].model, s->models[m].model) != 0) {
+                j++;
+            }
+            if (j == count) {
+                if (count == sizeof(merged) / sizeof(merged[0])) {
+                    continue;
+                }
+                memcpy(merged[j].model, s->models[m].model, sizeof(merged[j].model));
+                merged[j].cost = 0.0f;
+                count++;
+            }
+            merged[j].cost += cost;
+            total += cost;
+        }
+    }
+
+    // Largest first (a handful of entries: insertion sort)
+    for (size_t i = 1; i < count; i++) {
+        model_cost_t m = merged[i];
+        size_t j = i;
+        while (j > 0 && merged[j - 1].cost < m.cost) {
+            merged[j] = merged[j - 1];
+            j--;
+        }
+        merged[j] = m;
+    }
+
+    out->model_count = count < MAX_MODELS ? (int)count : MAX_MODELS;
+    for (int m = 0; m < out->model_count; m++) {
+        memcpy(out->models[m].model, merged[m].model, sizeof(out->models[m].model));
+        out->models[m].cost_pct = total > 0.0f ? merged[m].cost / total * 100.0f : 0.0f;
+    }
+}
+
+void status_aggregate(const status_data_t *const *statuses, size_t n, status_data_t *out)
+{
+    if (n == 1) {
+        *out = *statuses[0];
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+
+    int session_from = aggregate_tier(statuses, n, offsetof(status_data_t, session), &out->session);
+    aggregate_tier(statuses, n, offsetof(status_data_t, weekly_all), &out->weekly_all);
+    aggregate_tier(statuses, n, offsetof(status_data_t, weekly_sonnet), &out->weekly_sonnet);
+    aggregate_tier(statuses, n, offsetof(status_data_t, weekly_opus), &out->weekly_opus);
+
+    const status_data_t *session = statuses[session_from >= 0 ? session_from : 0];
+    out->session_remaining_seconds = session->session_remaining_seconds;
+    out->session_remaining_pct = session->session_remaining_pct;
+
+    int oldest = 0;
+    for (size_t i = 0; i < n; i++) {
+        const status_data_t *s = statuses[i];
+
+        out->session_cost_usd += s->session_cost_usd;
+        out->session_message_count += s->session_message_count;
+
+        if (s->burn_rate_present) {
+            out->burn_rate_present = true;
+            out->burn_tokens_per_min += s->burn_tokens_per_min;
+            out->burn_cost_per_hour += s->burn_cost_per_hour;
+        }
+
+        if (s->prediction_present) {
+            out->prediction_present = true;
+            if (s->session_will_hit_limit &&
+                (!out->session_will_hit_limit ||
+                 s->session_limit_in_seconds < out->session_limit_in_seconds)) {
+                out->session_will_hit_limit = true;
+                out->session_limit_in_seconds = s->session_limit_in_seconds;
+            }
+            if (s->weekly_will_hit_limit &&
+                (!out->weekly_will_hit_limit ||
+                 s->weekly_limit_in_seconds < out->weekly_limit_in_seconds)) {
+                out->weekly_will_hit_limit = true;
+                out->weekly_limit_in_seconds = s->weekly_limit_in_seconds;
+            }
+        }
+
+        if (s->data_age_seconds > statuses[oldest]->data_age_seconds) {
+            oldest = (int)i;
+        }
+        if (!out->plan[0] && s->plan[0]) {
+            memcpy(out->plan, s->plan, sizeof(out->plan));
+        }
+        if (s->received_at > out->received_at) {
+            out->received_at = s->received_at;
+        }
+    }
+
+    aggregate_models(statuses, n, out);
+
+    memcpy(out->server_time, statuses[oldest]->server_time, sizeof(out->server_time));
+    out->data_age_seconds = statuses[oldest]->data_age_seconds;
+    out->valid = true;
+}
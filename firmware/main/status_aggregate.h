@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+#include "http_client.h"
+
+// Combines the statuses of several CCU instances (one per developer machine)
+// into one, so the dashboard shows the team as a single account:
+//
+//   tiers        the most utilised instance's tier (with its reset time)
+//   session      cost and messages summed; remaining time from the instance
+//                with the most utilised session
+//   models       cost-weighted across instances, largest MAX_MODELS kept
+//   burn rate    summed
+//   prediction   a limit is hit if any instance hits it, at the earliest time
+//   meta         the oldest data (largest data_age_seconds) and its time
+//
+// A single status is passed through unchanged.
+
+// statuses[0..n) must all be valid, n >= 1.
+void status_aggregate(const status_data_t *const *statuses, size_t n, status_data_t *out);
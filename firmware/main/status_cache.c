@@ -0,0 +1,64 @@
+#include "status_cache.h"
+
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+
+static const char *TAG = "status_cache";
+
+#define NVS_NAMESPACE   "espclaude"
+#define NVS_KEY         "status"
+#define CACHE_VERSION   1
+
+typedef struct {
+    uint16_t version;
+    uint16_t size;                  // sizeof(status_data_t) when saved
+    status_data_t status;
+} cache_record_t;
+
+esp_err_t status_cache_load(status_data_t *out)
+{
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (err != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    static cache_record_t rec;
+    size_t len = sizeof(rec);
+    err = nvs_get_blob(nvs, NVS_KEY, &rec, &len);
+    nvs_close(nvs);
+    if (err != ESP_OK || len != sizeof(rec) || rec.version != CACHE_VERSION ||
+        rec.size != sizeof(status_data_t) || !rec.status.valid) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *out = rec.status;
+    ESP_LOGI(TAG, "restored status received at %u", (unsigned)out->received_at);
+    return ESP_OK;
+}
+
+esp_err_t status_cache_save(const status_data_t *status)
+{
+    if (status->received_at < CLOCK_VALID_AFTER) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        ESP_LOGD(TAG, "nvs_open: %s", esp_err_to_name(err));
+        return err;
+    }
+    static cache_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.version = CACHE_VERSION;
+    rec.size = sizeof(status_data_t);
+    rec.status = *status;
+    err = nvs_set_blob(nvs, NVS_KEY, &rec, sizeof(rec));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "save failed: %s", esp_err_to_name(err));
+    }
+    return err;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "esp_err.h"
+#include "http_client.h"
+
+// Last good status kept in NVS, so the screen can show real numbers straight
+// after a reboot while WiFi, SNTP and the first poll are still under way.
+// The record is tied to the status_data_t layout: a firmware update that
+// changes it invalidates the cached copy rather than misreading it.
+
+// Load the saved status into *out. ESP_ERR_NOT_FOUND if there is none (or
+// it was saved by a firmware with a different status layout).
+esp_err_t status_cache_load(status_data_t *out);
+
+// Save status (with its received_at). Refused until the clock is set, as the
+// receive time is what the restored copy is aged by.
+esp_err_t status_cache_save(const status_data_t *status);
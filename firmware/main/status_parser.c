@@ -0,0 +1,1010 @@
+#include "status_parser.h"
+
+#include <string.h>
+
+// Lexer states
+enum {
+    ST_VALUE,           // expecting any value
+    ST_VALUE_OR_END,    // just after '[': value or ']'
+    ST_KEY_OR_END,      // just after '{': key or '}'
+    ST_KEY,             // after ',' in an object
+    ST_COLON,
+    ST_AFTER_VALUE,     // expecting ',' or a closing bracket
+    ST_STRING,
+    ST_STRING_ESC,
+    ST_STRING_UNICODE,
+    ST_NUMBER_INT,
+    ST_NUMBER_FRAC,
+    ST_NUMBER_EXP_SIGN,
+    ST_NUMBER_EXP,
+    ST_LITERAL,
+    ST_CBOR_HEAD,       // expecting the initial byte of a CBOR item
+    ST_CBOR_ARG,        // reading the item's argument bytes
+    ST_CBOR_STRING,     // reading string bytes
+    ST_DONE,
+    ST_ERROR,
+};
+
+// What a container holds, derived from its parent context and key
+enum {
+    CTX_SKIP,
+    CTX_ROOT,
+    CTX_SESSION,
+    CTX_WEEKLY,
+    CTX_TIER,
+    CTX_MODEL_LIST,
+    CTX_MODEL,
+    CTX_BURN,
+    CTX_PREDICTION,
+};
+
+enum {
+    KEY_UNKNOWN,
+    KEY_SESSION,
+    KEY_WEEKLY,
+    KEY_ALL_MODELS,
+    KEY_SONNET,
+    KEY_OPUS,
+    KEY_UTILISATION_PCT,
+    KEY_RESETS_AT,
+    KEY_RESETS_IN_SECONDS,
+    KEY_COST_USD,
+    KEY_MESSAGE_COUNT,
+    KEY_REMAINING_SECONDS,
+    KEY_REMAINING_PCT,
+    KEY_MODEL_DISTRIBUTION,
+    KEY_MODEL,
+    KEY_COST_PCT,
+    KEY_BURN_RATE,
+    KEY_TOKENS_PER_MIN,
+    KEY_COST_PER_HOUR_USD,
+    KEY_PREDICTION,
+    KEY_SESSION_WILL_HIT_LIMIT,
+    KEY_SESSION_LIMIT_IN_SECONDS,
+    KEY_WEEKLY_WILL_HIT_LIMIT,
+    KEY_WEEKLY_LIMIT_IN_SECONDS,
+    KEY_SERVER_TIME,
+    KEY_DATA_AGE_SECONDS,
+    KEY_PLAN,
+    KEY_COUNT
+};
+
+typedef struct {
+    const char *name;
+    uint8_t     len;
+} key_name_t;
+
+#define KEY_NAME(s) {s, sizeof(s) - 1}
+
+static const key_name_t s_keys[KEY_COUNT] = {
+    [KEY_SESSION]                  = KEY_NAME("session"),
+    [KEY_WEEKLY]                   = KEY_NAME("weekly"),
+    [KEY_ALL_MODELS]               = KEY_NAME("all_models"),
+    [KEY_SONNET]                   = KEY_NAME("sonnet"),
+    [KEY_OPUS]                     = KEY_NAME("opus"),
+    [KEY_UTILISATION_PCT]          = KEY_NAME("utilisation_pct"),
+    [KEY_RESETS_AT]                = KEY_NAME("resets_at"),
+    [KEY_RESETS_IN_SECONDS]        = KEY_NAME("resets_in_seconds"),
+    [KEY_COST_USD]                 = KEY_NAME("cost_usd"),
+    [KEY_MESSAGE_COUNT]            = KEY_NAME("message_count"),
+    [KEY_REMAINING_SECONDS]        = KEY_NAME("remaining_seconds"),
+    [KEY_REMAINING_PCT]            = KEY_NAME("remaining_pct"),
+    [KEY_MODEL_DISTRIBUTION]       = KEY_NAME("model_distribution"),
+    [KEY_MODEL]                    = KEY_NAME("model"),
+    [KEY_COST_PCT]                 = KEY_NAME("cost_pct"),
+    [KEY_BURN_RATE]                = KEY_NAME("burn_rate"),
+    [KEY_TOKENS_PER_MIN]           = KEY_NAME("tokens_per_min"),
+    [KEY_COST_PER_HOUR_USD]        = KEY_NAME("cost_per_hour_usd"),
+    [KEY_PREDICTION]               = KEY_NAME("prediction"),
+    [KEY_SESSION_WILL_HIT_LIMIT]   = KEY_NAME("session_will_hit_limit"),
+    [KEY_SESSION_LIMIT_IN_SECONDS] = KEY_NAME("session_limit_in_seconds"),
+    [KEY_WEEKLY_WILL_HIT_LIMIT]    = KEY_NAME("weekly_will_hit_limit"),
+    [KEY_WEEKLY_LIMIT_IN_SECONDS]  = KEY_NAME("weekly_limit_in_seconds"),
+    [KEY_SERVER_TIME]              = KEY_NAME("server_time"),
+    [KEY_DATA_AGE_SECONDS]         = KEY_NAME("data_age_seconds"),
+    [KEY_PLAN]                     = KEY_NAME("plan"),
+};
+
+static const float s_pow10f[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+#define MANTISSA_LIMIT ((INT64_MAX - 9) / 10)
+
+#define CBOR_INDEFINITE UINT32_MAX
+
+static uint8_t lookup_key(const char *s, uint8_t len)
+{
+    for (uint8_t k = 1; k < KEY_COUNT; k++) {
+        if (s_keys[k].len == len && memcmp(s_keys[k].name, s, len) == 0) {
+            return k;
+        }
+    }
+    return KEY_UNKNOWN;
+}
+
+static inline bool is_ws(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline status_parser_frame_t *top(status_parser_t *p)
+{
+    return &p->stack[p->depth - 1];
+}
+
+static float number_as_float(const status_parser_t *p)
+{
+    if (p->num_is_float) {
+        return p->num_float;
+    }
+    int e = p->exp10 + (p->exp_negative ? -p->exp_value : p->exp_value);
+    float v = (float)p->mantissa;
+    while (e > 0) {
+        int step = e > 10 ? 10 : e;
+        v *= s_pow10f[step];
+        e -= step;
+    }
+    while (e < 0) {
+        int step = -e > 10 ? 10 : -e;
+        v /= s_pow10f[step];
+        e += step;
+    }
+    return p->negative ? -v : v;
+}
+
+// Truncates toward zero, matching a C cast from double
+static int64_t number_as_int(const status_parser_t *p)
+{
+    if (p->num_is_float) {
+        return (int64_t)p->num_float;
+    }
+    int e = p->exp10 + (p->exp_negative ? -p->exp_value : p->exp_value);
+    int64_t v = p->mantissa;
+    for (; e > 0 && v < INT64_MAX / 10; e--) {
+        v *= 10;
+    }
+    for (; e < 0 && v != 0; e++) {
+        v /= 10;
+    }
+    return p->negative ? -v : v;
+}
+
+// --- Field mapping ---
+
+static uint8_t open_context(status_parser_t *p, bool is_array, int elem, void **target)
+{
+    *target = NULL;
+    if (p->depth == 0) {
+        return CTX_ROOT;
+    }
+
+    status_parser_frame_t *parent = top(p);
+    status_data_t *s = p->out;
+
+    if (parent->is_array) {
+        if (parent->ctx == CTX_MODEL_LIST && !is_array && elem < MAX_MODELS) {
+            *target = &s->models[elem];
+            return CTX_MODEL;
+        }
+        return CTX_SKIP;
+    }
+
+    switch (parent->ctx) {
+    case CTX_ROOT:
+        if (is_array) break;
+        switch (parent->key) {
+        case KEY_SESSION:
+            s->session.present = true;
+            *target = &s->session;
+            return CTX_SESSION;
+        case KEY_WEEKLY:
+            return CTX_WEEKLY;
+        case KEY_BURN_RATE:
+            s->burn_rate_present = true;
+            return CTX_BURN;
+        case KEY_PREDICTION:
+            s->prediction_present = true;
+            return CTX_PREDICTION;
+        }
+        break;
+    case CTX_SESSION:
+        if (is_array && parent->key == KEY_MODEL_DISTRIBUTION) {
+            return CTX_MODEL_LIST;
+        }
+        break;
+    case CTX_WEEKLY: {
+        if (is_array) break;
+        usage_tier_t *tier = NULL;
+        if (parent->key == KEY_ALL_MODELS)  tier = &s->weekly_all;
+        if (parent->key == KEY_SONNET)      tier = &s->weekly_sonnet;
+        if (parent->key == KEY_OPUS)        tier = &s->weekly_opus;
+        if (tier) {
+            tier->present = true;
+            *target = tier;
+            return CTX_TIER;
+        }
+        break;
+    }
+    }
+    return CTX_SKIP;
+}
+
+static void string_target(status_parser_t *p)
+{
+    p->str_dst = NULL;
+    p->str_cap = 0;
+    p->str_clipped = false;
+    if (p->depth == 0 || top(p)->is_array) {
+        return;
+    }
+
+    status_parser_frame_t *f = top(p);
+    char *dst = NULL;
+    size_t cap = 0;
+
+    switch (f->ctx) {
+    case CTX_SESSION:
+    case CTX_TIER:
+        if (f->key == KEY_RESETS_AT) {
+            usage_tier_t *tier = f->target;
+            dst = tier->resets_at;
+            cap = sizeof(tier->resets_at);
+        }
+        break;
+    case CTX_MODEL:
+        if (f->key == KEY_MODEL) {
+            model_dist_t *m = f->target;
+            dst = m->model;
+            cap = sizeof(m->model);
+        }
+        break;
+    case CTX_ROOT:
+        if (f->key == KEY_SERVER_TIME) {
+            dst = p->out->server_time;
+            cap = sizeof(p->out->server_time);
+        } else if (f->key == KEY_PLAN) {
+            dst = p->out->plan;
+            cap = sizeof(p->out->plan);
+        }
+        break;
+    }
+
+    p->str_dst = dst;
+    p->str_cap = (uint8_t)cap;
+}
+
+static bool tier_number(status_parser_t *p, usage_tier_t *tier, uint8_t key)
+{
+    switch (key) {
+    case KEY_UTILISATION_PCT:
+        tier->utilisation = number_as_float(p);
+        return true;
+    case KEY_RESETS_IN_SECONDS:
+        tier->resets_in_seconds = number_as_int(p);
+        return true;
+    }
+    return false;
+}
+
+static void on_number(status_parser_t *p)
+{
+    if (p->depth == 0 || top(p)->is_array) {
+        return;
+    }
+
+    status_parser_frame_t *f = top(p);
+    status_data_t *s = p->out;
+
+    switch (f->ctx) {
+    case CTX_SESSION:
+        if (tier_number(p, f->target, f->key)) break;
+        switch (f->key) {
+        case KEY_COST_USD:          s->session_cost_usd = number_as_float(p); break;
+        case KEY_MESSAGE_COUNT:     s->session_message_count = (int)number_as_int(p); break;
+        case KEY_REMAINING_SECONDS: s->session_remaining_seconds = number_as_int(p); break;
+        case KEY_REMAINING_PCT:     s->session_remaining_pct = number_as_float(p); break;
+        }
+        break;
+    case CTX_TIER:
+        tier_number(p, f->target, f->key);
+        break;
+    case CTX_MODEL:
+        if (f->key == KEY_COST_PCT) {
+            ((model_dist_t *)f->target)->cost_pct = number_as_float(p);
+        }
+        break;
+    case CTX_BURN:
+        if (f->key == KEY_TOKENS_PER_MIN)    s->burn_tokens_per_min = number_as_float(p);
+        if (f->key == KEY_COST_PER_HOUR_USD) s->burn_cost_per_hour = number_as_float(p);
+        break;
+    case CTX_PREDICTION:
+        if (f->key == KEY_SESSION_LIMIT_IN_SECONDS) s->session_limit_in_seconds = number_as_int(p);
+        if (f->key == KEY_WEEKLY_LIMIT_IN_SECONDS)  s->weekly_limit_in_seconds = number_as_int(p);
+        break;
+    case CTX_ROOT:
+        if (f->key == KEY_DATA_AGE_SECONDS) s->data_age_seconds = (int)number_as_int(p);
+        break;
+    }
+}
+
+static void on_bool(status_parser_t *p, bool value)
+{
+    if (p->depth == 0 || top(p)->is_array || top(p)->ctx != CTX_PREDICTION) {
+        return;
+    }
+    uint8_t key = top(p)->key;
+    if (key == KEY_SESSION_WILL_HIT_LIMIT) p->out->session_will_hit_limit = value;
+    if (key == KEY_WEEKLY_WILL_HIT_LIMIT)  p->out->weekly_will_hit_limit = value;
+}
+
+// --- Lexer ---
+
+static void value_done(status_parser_t *p)
+{
+    p->state = p->depth == 0 ? ST_DONE : ST_AFTER_VALUE;
+}
+
+static void open_container(status_parser_t *p, bool is_array, int elem)
+{
+    if (p->depth == STATUS_PARSER_MAX_DEPTH) {
+        p->state = ST_ERROR;
+        return;
+    }
+    void *target;
+    uint8_t ctx = open_context(p, is_array, elem, &target);
+    p->stack[p->depth++] = (status_parser_frame_t){
+        .ctx = ctx,
+        .key = KEY_UNKNOWN,
+        .index = 0,
+        .is_array = is_array,
+        .target = target,
+    };
+    p->state = is_array ? ST_VALUE_OR_END : ST_KEY_OR_END;
+}
+
+static void close_container(status_parser_t *p, bool is_array)
+{
+    if (p->depth == 0 || top(p)->is_array != is_array) {
+        p->state = ST_ERROR;
+        return;
+    }
+    p->depth--;
+    value_done(p);
+}
+
+// A value starts in the current container; returns its array index, or -1
+static int begin_element(status_parser_t *p)
+{
+    if (p->depth == 0 || !top(p)->is_array) {
+        return -1;
+    }
+    status_parser_frame_t *f = top(p);
+    int elem = f->index;
+    if (f->index < UINT8_MAX) f->index++;
+    if (f->ctx == CTX_MODEL_LIST) {
+        if (elem < MAX_MODELS) {
+            p->out->model_count = elem + 1;
+        } else {
+            p->clipped++;
+        }
+    }
+    return elem;
+}
+
+static void begin_value(status_parser_t *p, char c)
+{
+    // The document must be an object
+    if (p->depth == 0 && c != '{') {
+        p->state = ST_ERROR;
+        return;
+    }
+    int elem = begin_element(p);
+
+    switch (c) {
+    case '{':
+        open_container(p, false, elem);
+        break;
+    case '[':
+        open_container(p, true, elem);
+        break;
+    case '"':
+        p->str_is_key = false;
+        p->str_len = 0;
+        string_target(p);
+        p->state = ST_STRING;
+        break;
+    case 't':
+        p->literal = "true";
+        p->literal_pos = 1;
+        p->state = ST_LITERAL;
+        break;
+    case 'f':
+        p->literal = "false";
+        p->literal_pos = 1;
+        p->state = ST_LITERAL;
+        break;
+    case 'n':
+        p->literal = "null";
+        p->literal_pos = 1;
+        p->state = ST_LITERAL;
+        break;
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            p->negative = c == '-';
+            p->has_digits = c != '-';
+            p->mantissa = c == '-' ? 0 : c - '0';
+            p->exp10 = 0;
+            p->exp_value = 0;
+            p->exp_negative = false;
+            p->state = ST_NUMBER_INT;
+        } else {
+            p->state = ST_ERROR;
+        }
+        break;
+    }
+}
+
+static void begin_key(status_parser_t *p)
+{
+    p->str_is_key = true;
+    p->key_len = 0;
+    p->str_dst = NULL;
+    p->state = ST_STRING;
+}
+
+static void string_put(status_parser_t *p, char c)
+{
+    if (p->str_is_key) {
+        // Overlong keys can't match anything; mark them with an impossible length
+        if (p->key_len < STATUS_PARSER_KEY_LEN) {
+            p->key_buf[p->key_len] = c;
+        }
+        if (p->key_len < UINT8_MAX) p->key_len++;
+    } else if (p->str_dst) {
+        if (p->str_len + 1 < p->str_cap) {
+            p->str_dst[p->str_len++] = c;
+        } else {
+            p->str_clipped = true;
+        }
+    }
+}
+
+static void string_put_codepoint(status_parser_t *p, uint16_t cp)
+{
+    if (cp < 0x80) {
+        string_put(p, (char)cp);
+    } else if (cp < 0x800) {
+        string_put(p, (char)(0xC0 | (cp >> 6)));
+        string_put(p, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+        // Surrogate halves aren't worth reassembling for display strings
+        string_put(p, '?');
+    } else {
+        string_put(p, (char)(0xE0 | (cp >> 12)));
+        string_put(p, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        string_put(p, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+static void end_string(status_parser_t *p)
+{
+    if (p->str_is_key) {
+        uint8_t key = p->key_len <= STATUS_PARSER_KEY_LEN
+                          ? lookup_key(p->key_buf, p->key_len) : KEY_UNKNOWN;
+        top(p)->key = key;
+        p->state = ST_COLON;
+        return;
+    }
+    if (p->str_dst) {
+        p->str_dst[p->str_len] = '\0';
+        if (p->str_clipped) p->clipped++;
+    }
+    value_done(p);
+}
+
+static void number_digit(status_parser_t *p, int d, bool frac)
+{
+    p->has_digits = true;
+    if (p->mantissa < MANTISSA_LIMIT) {
+        p->mantissa = p->mantissa * 10 + d;
+        if (frac) p->exp10--;
+    } else if (!frac && p->exp10 < 400) {
+        p->exp10++;
+    }
+}
+
+static void end_number(status_parser_t *p)
+{
+    if (!p->has_digits) {
+        p->state = ST_ERROR;
+        return;
+    }
+    on_number(p);
+    value_done(p);
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Process one character. Returns false if it must be fed again (it
+// terminated a number and belongs to the next token).
+static bool step(status_parser_t *p, char c)
+{
+    switch (p->state) {
+    case ST_VALUE_OR_END:
+        if (is_ws(c)) return true;
+        if (c == ']') {
+            close_container(p, true);
+            return true;
+        }
+        begin_value(p, c);
+        return true;
+
+    case ST_VALUE:
+        if (!is_ws(c)) begin_value(p, c);
+        return true;
+
+    case ST_KEY_OR_END:
+        if (is_ws(c)) return true;
+        if (c == '}') close_container(p, false);
+        else if (c == '"') begin_key(p);
+        else p->state = ST_ERROR;
+        return true;
+
+    case ST_KEY:
+        if (is_ws(c)) return true;
+        if (c == '"') begin_key(p);
+        else p->state = ST_ERROR;
+        return true;
+
+    case ST_COLON:
+        if (is_ws(c)) return true;
+        p->state = c == ':' ? ST_VALUE : ST_ERROR;
+        return true;
+
+    case ST_AFTER_VALUE:
+        if (is_ws(c)) return true;
+        if (c == ',') p->state = top(p)->is_array ? ST_VALUE : ST_KEY;
+        else if (c == '}') close_container(p, false);
+        else if (c == ']') close_container(p, true);
+        else p->state = ST_ERROR;
+        return true;
+
+    case ST_STRING:
+        if (c == '"') end_string(p);
+        else if (c == '\\') p->state = ST_STRING_ESC;
+        else if ((unsigned char)c < 0x20) p->state = ST_ERROR;
+        else string_put(p, c);
+        return true;
+
+    case ST_STRING_ESC:
+        p->state = ST_STRING;
+        switch (c) {
+        case '"': case '\\': case '/': string_put(p, c); break;
+        case 'b': string_put(p, '\b'); break;
+        case 'f': string_put(p, '\f'); break;
+        case 'n': string_put(p, '\n'); break;
+        case 'r': string_put(p, '\r'); break;
+        case 't': string_put(p, '\t'); break;
+        case 'u':
+            p->unicode = 0;
+            p->unicode_digits = 0;
+            p->state = ST_STRING_UNICODE;
+            break;
+        default:
+            p->state = ST_ERROR;
+            break;
+        }
+        return true;
+
+    case ST_STRING_UNICODE: {
+        int h = hex_value(c);
+        if (h < 0) {
+            p->state = ST_ERROR;
+            return true;
+        }
+        p->unicode = (uint16_t)((p->unicode << 4) | h);
+        if (++p->unicode_digits == 4) {
+            string_put_codepoint(p, p->unicode);
+            p->state = ST_STRING;
+        }
+        return true;
+    }
+
+    case ST_NUMBER_INT:
+        if (c >= '0' && c <= '9') {
+            number_digit(p, c - '0', false);
+            return true;
+        }
+        if (c == '.') {
+            p->state = ST_NUMBER_FRAC;
+            return true;
+        }
+        if (c == 'e' || c == 'E') {
+            p->state = ST_NUMBER_EXP_SIGN;
+            return true;
+        }
+        end_number(p);
+        return false;
+
+    case ST_NUMBER_FRAC:
+        if (c >= '0' && c <= '9') {
+            number_digit(p, c - '0', true);
+            return true;
+        }
+        if (c == 'e' || c == 'E') {
+            p->state = ST_NUMBER_EXP_SIGN;
+            return true;
+        }
+        end_number(p);
+        return false;
+
+    case ST_NUMBER_EXP_SIGN:
+        p->state = ST_NUMBER_EXP;
+        if (c == '+' || c == '-') {
+            p->exp_negative = c == '-';
+            return true;
+        }
+        if (c >= '0' && c <= '9') return false;
+        p->state = ST_ERROR;
+        return true;
+
+    case ST_NUMBER_EXP:
+        if (c >= '0' && c <= '9') {
+            if (p->exp_value < 1000) p->exp_value = (int16_t)(p->exp_value * 10 + (c - '0'));
+            return true;
+        }
+        end_number(p);
+        return false;
+
+    case ST_LITERAL:
+        if (c != p->literal[p->literal_pos]) {
+            p->state = ST_ERROR;
+            return true;
+        }
+        if (p->literal[++p->literal_pos] == '\0') {
+            if (p->literal[0] != 'n') {
+                on_bool(p, p->literal[0] == 't');
+            }
+            value_done(p);
+        }
+        return true;
+
+    case ST_DONE:
+        if (!is_ws(c)) p->state = ST_ERROR;
+        return true;
+
+    default:
+        return true;
+    }
+}
+
+// --- CBOR front end ---
+//
+// Items map onto the same field handlers as the JSON lexer: map keys select
+// fields, integers and floats arrive ready-made (no text conversion), and
+// strings are copied straight into their destination. Tags are skipped.
+
+// A scalar or container item starts. Returns its array index (-1 if none)
+// and sets up key handling, or fails for a non-map document.
+static int cbor_begin_item(status_parser_t *p)
+{
+    if (p->depth == 0) {
+        if (p->cbor_major != 5) {
+            p->state = ST_ERROR;
+        }
+        return -1;
+    }
+    status_parser_frame_t *f = top(p);
+    if (!f->is_array && f->key_next) {
+        // Whatever this key turns out to be, it selects no field unless it's
+        // a known text key
+        f->key = KEY_UNKNOWN;
+        return -1;
+    }
+    return begin_element(p);
+}
+
+// An item is complete: count it against its container, closing every
+// container that this completes
+static void cbor_item_done(status_parser_t *p)
+{
+    while (p->depth > 0) {
+        status_parser_frame_t *f = top(p);
+        if (!f->is_array) {
+            f->key_next = !f->key_next;
+        }
+        if (f->left == CBOR_INDEFINITE || --f->left > 0) {
+            p->state = ST_CBOR_HEAD;
+            return;
+        }
+        p->depth--;
+    }
+    p->state = ST_DONE;
+}
+
+static void cbor_end_string(status_parser_t *p)
+{
+    p->cbor_str_indef = false;
+    if (p->str_is_key) {
+        top(p)->key = p->key_len <= STATUS_PARSER_KEY_LEN
+                          ? lookup_key(p->key_buf, p->key_len) : KEY_UNKNOWN;
+    } else if (p->str_dst) {
+        p->str_dst[p->str_len] = '\0';
+        if (p->str_clipped) p->clipped++;
+    }
+    cbor_item_done(p);
+}
+
+static void cbor_number(status_parser_t *p, bool negative, uint64_t magnitude)
+{
+    p->num_is_float = false;
+    p->negative = negative;
+    p->mantissa = magnitude > INT64_MAX ? INT64_MAX : (int64_t)magnitude;
+    p->exp10 = 0;
+    p->exp_value = 0;
+    p->exp_negative = false;
+    on_number(p);
+}
+
+static float half_to_float(uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    if (exp == 0) {
+        float v = (float)mant * 5.9604645e-8f;  // subnormal: mant * 2^-24
+        return sign ? -v : v;
+    }
+    uint32_t bits = sign | (exp == 31 ? 0xffu << 23 : (exp + 112) << 23) | mant << 13;
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static void cbor_float(status_parser_t *p)
+{
+    float v;
+    if (p->cbor_info == 25) {
+        v = half_to_float((uint16_t)p->cbor_arg);
+    } else if (p->cbor_info == 26) {
+        uint32_t bits = (uint32_t)p->cbor_arg;
+        memcpy(&v, &bits, sizeof(v));
+    } else {
+        double d;
+        memcpy(&d, &p->cbor_arg, sizeof(d));
+        v = (float)d;
+    }
+    p->num_is_float = true;
+    p->num_float = v;
+    on_number(p);
+}
+
+static void cbor_begin_string(status_parser_t *p, bool indefinite)
+{
+    status_parser_frame_t *f = p->depth ? top(p) : NULL;
+    p->str_is_key = f && !f->is_array && f->key_next && p->cbor_major == 3;
+    p->str_len = 0;
+    p->key_len = 0;
+    if (p->str_is_key) {
+        p->str_dst = NULL;
+    } else if (p->cbor_major == 3) {
+        string_target(p);
+    } else {
+        p->str_dst = NULL;  // byte strings are never displayed
+    }
+
+    p->cbor_str_major = p->cbor_major;
+    if (indefinite) {
+        p->cbor_str_indef = true;
+        p->state = ST_CBOR_HEAD;
+    } else if (p->cbor_arg == 0) {
+        cbor_end_string(p);
+    } else {
+        p->cbor_str_left = p->cbor_arg > UINT32_MAX ? UINT32_MAX : (uint32_t)p->cbor_arg;
+        p->state = ST_CBOR_STRING;
+    }
+}
+
+static void cbor_begin_container(status_parser_t *p, bool indefinite)
+{
+    bool is_array = p->cbor_major == 4;
+    int elem = cbor_begin_item(p);
+    if (p->state == ST_ERROR) {
+        return;
+    }
+    if (!indefinite && p->cbor_arg > (is_array ? UINT32_MAX - 1 : (UINT32_MAX - 1) / 2)) {
+        p->state = ST_ERROR;
+        return;
+    }
+    open_container(p, is_array, elem);
+    if (p->state == ST_ERROR) {
+        return;
+    }
+    status_parser_frame_t *f = top(p);
+    f->key_next = !is_array;
+    f->left = indefinite ? CBOR_INDEFINITE
+                         : (uint32_t)(is_array ? p->cbor_arg : p->cbor_arg * 2);
+    if (f->left == 0) {
+        p->depth--;
+        cbor_item_done(p);
+    } else {
+        p->state = ST_CBOR_HEAD;
+    }
+}
+
+// The item head (initial byte and argument) is complete
+static void cbor_head_done(status_parser_t *p, bool indefinite)
+{
+    if (p->cbor_str_indef) {
+        // A chunk of an indefinite-length string
+        p->cbor_str_left = p->cbor_arg > UINT32_MAX ? UINT32_MAX : (uint32_t)p->cbor_arg;
+        p->state = p->cbor_str_left ? ST_CBOR_STRING : ST_CBOR_HEAD;
+        return;
+    }
+
+    switch (p->cbor_major) {
+    case 0:
+    case 1:
+        cbor_begin_item(p);
+        if (p->state == ST_ERROR) return;
+        if (p->cbor_major == 0) {
+            cbor_number(p, false, p->cbor_arg);
+        } else {
+            cbor_number(p, true, p->cbor_arg == UINT64_MAX ? UINT64_MAX : p->cbor_arg + 1);
+        }
+        cbor_item_done(p);
+        break;
+    case 2:
+    case 3:
+        cbor_begin_item(p);
+        if (p->state == ST_ERROR) return;
+        cbor_begin_string(p, indefinite);
+        break;
+    case 4:
+    case 5:
+        cbor_begin_container(p, indefinite);
+        break;
+    case 6:
+        // Tag: decode the tagged item as if it were bare
+        p->state = ST_CBOR_HEAD;
+        break;
+    default:
+        cbor_begin_item(p);
+        if (p->state == ST_ERROR) return;
+        if (p->cbor_info == 20 || p->cbor_info == 21) {
+            on_bool(p, p->cbor_info == 21);
+        } else if (p->cbor_info >= 25 && p->cbor_info <= 27) {
+            cbor_float(p);
+        }
+        // null, undefined and other simple values leave the field unset
+        cbor_item_done(p);
+        break;
+    }
+}
+
+static void cbor_break(status_parser_t *p)
+{
+    if (p->cbor_str_indef) {
+        cbor_end_string(p);
+        return;
+    }
+    status_parser_frame_t *f = p->depth ? top(p) : NULL;
+    if (!f || f->left != CBOR_INDEFINITE || (!f->is_array && !f->key_next)) {
+        // Nothing to close, or a map missing the value of its last key
+        p->state = ST_ERROR;
+        return;
+    }
+    p->depth--;
+    cbor_item_done(p);
+}
+
+static void cbor_head(status_parser_t *p, uint8_t b)
+{
+    if (b == 0xff) {
+        cbor_break(p);
+        return;
+    }
+    uint8_t major = b >> 5;
+    uint8_t info = b & 0x1f;
+    if (p->cbor_str_indef && (major != p->cbor_str_major || info == 31)) {
+        // Indefinite strings may only contain definite chunks of their own type
+        p->state = ST_ERROR;
+        return;
+    }
+
+    p->cbor_major = major;
+    p->cbor_info = info;
+    p->cbor_arg = 0;
+    if (info < 24) {
+        p->cbor_arg = info;
+        cbor_head_done(p, false);
+    } else if (info <= 27) {
+        p->cbor_need = (uint8_t)(1u << (info - 24));
+        p->state = ST_CBOR_ARG;
+    } else if (info == 31 && major >= 2 && major <= 5) {
+        cbor_head_done(p, true);
+    } else {
+        p->state = ST_ERROR;
+    }
+}
+
+static void cbor_feed(status_parser_t *p, const uint8_t *data, size_t len)
+{
+    size_t i = 0;
+    while (i < len && p->state != ST_ERROR) {
+        switch (p->state) {
+        case ST_CBOR_HEAD:
+            cbor_head(p, data[i++]);
+            break;
+        case ST_CBOR_ARG:
+            p->cbor_arg = (p->cbor_arg << 8) | data[i++];
+            if (--p->cbor_need == 0) {
+                cbor_head_done(p, false);
+            }
+            break;
+        case ST_CBOR_STRING: {
+            size_t n = len - i < p->cbor_str_left ? len - i : p->cbor_str_left;
+            if (p->str_is_key || p->str_dst) {
+                for (size_t k = 0; k < n; k++) {
+                    string_put(p, (char)data[i + k]);
+                }
+            }
+            i += n;
+            p->cbor_str_left -= (uint32_t)n;
+            if (p->cbor_str_left == 0) {
+                if (p->cbor_str_indef) {
+                    p->state = ST_CBOR_HEAD;
+                } else {
+                    cbor_end_string(p);
+                }
+            }
+            break;
+        }
+        default:
+            // Trailing bytes after the document
+            p->state = ST_ERROR;
+            break;
+        }
+    }
+}
+
+void status_parser_init(status_parser_t *p, status_data_t *out)
+{
+    memset(p, 0, sizeof(*p));
+    memset(out, 0, sizeof(*out));
+    p->out = out;
+    p->state = ST_VALUE;
+}
+
+void status_parser_use_cbor(status_parser_t *p)
+{
+    p->cbor = true;
+    p->state = ST_CBOR_HEAD;
+}
+
+bool status_parser_feed(status_parser_t *p, const char *data, size_t len)
+{
+    if (p->cbor) {
+        cbor_feed(p, (const uint8_t *)data, len);
+        return p->state != ST_ERROR;
+    }
+    size_t i = 0;
+    while (i < len && p->state != ST_ERROR) {
+        if (step(p, data[i])) {
+            i++;
+        }
+    }
+    return p->state != ST_ERROR;
+}
+
+bool status_parser_finish(const status_parser_t *p)
+{
+    return p->state == ST_DONE;
+}
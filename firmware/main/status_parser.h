@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "http_client.h"
+
+// Incremental, DOM-free parser for the CCU /api/status document, in JSON or
+// its CBOR (RFC 8949) encoding.
+//
+// Feed the response body in arbitrary chunks as it arrives; recognised fields
+// are written straight into the target status_data_t and everything else is
+// skipped without being stored. No heap allocation, no response buffer. Both
+// encodings share the same field mapping.
+
+#define STATUS_PARSER_MAX_DEPTH 16
+#define STATUS_PARSER_KEY_LEN   32
+
+typedef struct {
+    uint8_t ctx;        // what this container holds (session, tier, model list, ...)
+    uint8_t key;        // key of the member being parsed (objects only)
+    uint8_t index;      // element index (arrays only, saturates at 255)
+    bool    is_array;
+    bool    key_next;   // CBOR maps: the next item is a key
+    uint32_t left;      // CBOR: items (keys and values) left, or UINT32_MAX if indefinite
+    void   *target;     // usage_tier_t or model_dist_t this container fills
+} status_parser_frame_t;
+
+typedef struct {
+    status_data_t *out;
+
+    uint8_t state;
+    uint8_t depth;
+    status_parser_frame_t stack[STATUS_PARSER_MAX_DEPTH];
+
+    // String being lexed: keys go to key_buf, known values straight to str_dst
+    bool    str_is_key;
+    char   *str_dst;
+    uint8_t str_cap;
+    uint8_t str_len;
+    bool    str_clipped;
+    char    key_buf[STATUS_PARSER_KEY_LEN];
+    uint8_t key_len;
+    uint16_t unicode;
+    uint8_t  unicode_digits;
+
+    // Number being lexed, kept as mantissa * 10^exp10 (no float text conversion),
+    // or a binary float from CBOR
+    bool    num_is_float;
+    float   num_float;
+    int64_t mantissa;
+    int16_t exp10;
+    int16_t exp_value;
+    bool    negative;
+    bool    exp_negative;
+    bool    has_digits;
+
+    // Literal (true/false/null) being lexed
+    const char *literal;
+    uint8_t     literal_pos;
+
+    // CBOR item head being decoded
+    bool     cbor;
+    uint8_t  cbor_major;
+    uint8_t  cbor_info;
+    uint8_t  cbor_need;         // argument bytes still to read
+    uint64_t cbor_arg;
+    bool     cbor_str_indef;    // between the chunks of an indefinite-length string
+    uint8_t  cbor_str_major;
+    uint32_t cbor_str_left;     // bytes of the current string (chunk) still to read
+
+    // Values that didn't fit status_data_t: strings cut to their field size,
+    // models past MAX_MODELS. The document still parses.
+    uint16_t clipped;
+} status_parser_t;
+
+// Reset the parser and zero *out, which receives the parsed fields.
+// The body is expected to be JSON unless status_parser_use_cbor() is called.
+void status_parser_init(status_parser_t *p, status_data_t *out);
+
+// Decode the body as CBOR instead. Call after init, before the first feed.
+void status_parser_use_cbor(status_parser_t *p);
+
+// Consume the next chunk of the body. Returns false once the input is
+// malformed (further calls are ignored).
+bool status_parser_feed(status_parser_t *p, const char *data, size_t len);
+
+// Returns true if a complete, well-formed document has been consumed.
+bool status_parser_finish(const status_parser_t *p);
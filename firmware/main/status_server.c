@@ -0,0 +1,629 @@
+#include "status_server.h"
+#include "config.h"
+
+// Off unless a port is configured (see config.h.example)
+#ifndef STATUS_SERVER_PORT
+#define STATUS_SERVER_PORT 0
+#endif
+#ifndef STATUS_SERVER_TOKEN
+#define STATUS_SERVER_TOKEN ""
+#endif
+
+// Largest status document: four tiers, four models and the strings, escaped
+#define STATUS_JSON_MAX 2048
+
+// /metrics goes out in chunks of up to this much
+#define METRICS_CHUNK 512
+
+// Raw history served by HISTORY_PATH, samples per response and bytes per chunk
+#define HISTORY_PATH  "/api/history"
+#define HISTORY_PAGE  128
+#define HISTORY_CHUNK 1024
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_heap_caps.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "http_client.h"
+#include "http_engine.h"
+#include "history.h"
+#include "wifi.h"
+
+static const char *TAG = "status_server";
+
+// Everything below belongs to the server task, which handles one request at
+// a time.
+static httpd_handle_t s_server;
+
+// Told apart in ETags, so a client's validator from before a reboot (when
+// generations start over) never matches
+static uint32_t s_boot_id;
+
+// Latest published status, copied in only when its generation moves
+static status_data_t s_status;
+static uint32_t s_generation;
+
+// Answers by path and code, for /metrics
+static uint32_t s_status_200;
+static uint32_t s_status_304;
+static uint32_t s_status_503;
+static uint32_t s_metrics_200;
+static uint32_t s_history_200;
+static uint32_t s_history_400;
+static uint32_t s_unauthorized;
+
+// Bounded text output: appends past the end are dropped and flagged
+typedef struct {
+    char *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+} text_t;
+
+static void text_printf(text_t *t, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void text_printf(text_t *t, const char *fmt, ...)
+{
+    if (t->overflow) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(t->buf + t->len, t->cap - t->len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= t->cap - t->len) {
+        t->buf[t->len] = '\0';
+        t->overflow = true;
+        return;
+    }
+    t->len += (size_t)n;
+}
+
+// A JSON string (quotes included); also fit for Prometheus label values
+static void text_string(text_t *t, const char *s)
+{
+    text_printf(t, "\"");
+    for (; *s && !t->overflow; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            text_printf(t, "\\%c", c);
+        } else if (c == '\n') {
+            text_printf(t, "\\n");
+        } else if (c < 0x20) {
+            text_printf(t, "\\u%04x", c);
+        } else {
+            text_printf(t, "%c", c);
+        }
+    }
+    text_printf(t, "\"");
+}
+
+static void text_float(text_t *t, float v)
+{
+    if (isfinite(v)) {
+        text_printf(t, "%.6g", v);
+    } else {
+        text_printf(t, "null");
+    }
+}
+
+static bool authorized(httpd_req_t *req)
+{
+    static const char token[] = STATUS_SERVER_TOKEN;
+    if (!token[0]) {
+        return true;
+    }
+    char value[sizeof(token) + 8];
+    if (httpd_req_get_hdr_value_str(req, "Authorization", value, sizeof(value)) != ESP_OK ||
+        strncmp(value, "Bearer ", 7) != 0 || strcmp(value + 7, token) != 0) {
+        s_unauthorized++;
+        httpd_resp_set_hdr(req, "WWW-Authenticate", "Bearer");
+        httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, NULL);
+        return false;
+    }
+    return true;
+}
+
+// A countdown as of now rather than as of when the status arrived
+static int64_t counted_down(int64_t seconds, int64_t elapsed)
+{
+    if (seconds <= 0) {
+        return seconds;
+    }
+    return seconds > elapsed ? seconds - elapsed : 0;
+}
+
+static void write_tier(text_t *t, const char *key, const usage_tier_t *tier, int64_t elapsed)
+{
+    text_printf(t, "\"%s\":", key);
+    if (!tier->present) {
+        text_printf(t, "null");
+        return;
+    }
+    text_printf(t, "{\"utilisation_pct\":");
+    text_float(t, tier->utilisation);
+    text_printf(t, ",\"resets_at\":");
+    text_string(t, tier->resets_at);
+    text_printf(t, ",\"resets_in_seconds\":%" PRId64 "}", counted_down(tier->resets_in_seconds, elapsed));
+}
+
+// The status as CCU's /api/status would send it now
+static void write_status_json(text_t *t, const status_data_t *s)
+{
+    // Seconds since the status arrived: the countdowns move on by that much
+    int64_t elapsed = 0;
+    time_t now = time(NULL);
+    if (s->received_at >= CLOCK_VALID_AFTER && now > (time_t)s->received_at) {
+        elapsed = now - s->received_at;
+    }
+
+    text_printf(t, "{\"session\":");
+    if (s->session.present) {
+        text_printf(t, "{\"utilisation_pct\":");
+        text_float(t, s->session.utilisation);
+        text_printf(t, ",\"resets_at\":");
+        text_string(t, s->session.resets_at);
+        text_printf(t, ",\"resets_in_seconds\":%" PRId64 ",\"cost_usd\":",
+                    counted_down(s->session.resets_in_seconds, elapsed));
+        text_float(t, s->session_cost_usd);
+        text_printf(t, ",\"message_count\":%d,\"remaining_seconds\":%" PRId64 ",\"remaining_pct\":",
+                    s->session_message_count, counted_down(s->session_remaining_seconds, elapsed));
+        text_float(t, s->session_remaining_pct);
+        text_printf(t, ",\"model_distribution\":[");
+        for (int i = 0; i < s->model_count && i < MAX_MODELS; i++) {
+            text_printf(t, "%s{\"model\":", i ? "," : "");
+            text_string(t, s->models[i].model);
+            text_printf(t, ",\"cost_pct\":");
+            text_float(t, s->models[i].cost_pct);
+            text_printf(t, "}");
+        }
+        text_printf(t, "]}");
+    } else {
+        text_printf(t, "null");
+    }
+
+    text_printf(t, ",\"weekly\":{");
+    write_tier(t, "all_models", &s->weekly_all, elapsed);
+    text_printf(t, ",");
+    write_tier(t, "sonnet", &s->weekly_sonnet, elapsed);
+    text_printf(t, ",");
+    write_tier(t, "opus", &s->weekly_opus, elapsed);
+    text_printf(t, "}");
+
+    text_printf(t, ",\"burn_rate\":");
+    if (s->burn_rate_present) {
+        text_printf(t, "{\"tokens_per_min\":");
+        text_float(t, s->burn_tokens_per_min);
+        text_printf(t, ",\"cost_per_hour_usd\":");
+        text_float(t, s->burn_cost_per_hour);
+        text_printf(t, "}");
+    } else {
+        text_printf(t, "null");
+    }
+
+    text_printf(t, ",\"prediction\":");
+    if (s->prediction_present) {
+        text_printf(t, "{\"session_will_hit_limit\":%s,\"session_limit_in_seconds\":%" PRId64
+                    ",\"weekly_will_hit_limit\":%s,\"weekly_limit_in_seconds\":%" PRId64 "}",
+                    s->session_will_hit_limit ? "true" : "false",
+                    counted_down(s->session_limit_in_seconds, elapsed),
+                    s->weekly_will_hit_limit ? "true" : "false",
+                    counted_down(s->weekly_limit_in_seconds, elapsed));
+    } else {
+        text_printf(t, "null");
+    }
+
+    text_printf(t, ",\"server_time\":");
+    text_string(t, s->server_time);
+    text_printf(t, ",\"data_age_seconds\":%" PRId64 ",\"plan\":", http_client_status_age_s(s));
+    text_string(t, s->plan);
+    text_printf(t, "}");
+}
+
+// If-None-Match holds etag (alone or in a list, weak or strong, or "*")
+static bool etag_matches(httpd_req_t *req, const char *etag)
+{
+    char value[128];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", value, sizeof(value)) != ESP_OK) {
+        return false;
+    }
+    if (strcmp(value, "*") == 0) {
+        return true;
+    }
+    // Weak comparison: only the quoted part counts
+    const char *opaque = etag + 2;
+    size_t len = strlen(opaque);
+    for (const char *p = strstr(value, opaque); p; p = strstr(p + 1, opaque)) {
+        char end = p[len];
+        if (end == '\0' || end == ',' || end == ' ') {
+            return true;
+        }
+    }
+    return false;
+}
+
+static esp_err_t status_get(httpd_req_t *req)
+{
+    if (!authorized(req)) {
+        return ESP_OK;
+    }
+    http_client_read_status(&s_status, &s_generation);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    if (!s_status.valid) {
+        s_status_503++;
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "5");
+        httpd_resp_set_type(req, "application/json");
+        return httpd_resp_send(req, "{\"error\":\"no status yet\"}", HTTPD_RESP_USE_STRLEN);
+    }
+
+    // Weak: the body is rendered per request and its ages tick on, but for
+    // a given generation it carries the same status
+    static char etag[32];
+    snprintf(etag, sizeof(etag), "W/\"%08" PRIx32 "-%" PRIu32 "\"", s_boot_id, s_generation);
+    httpd_resp_set_hdr(req, "ETag", etag);
+    if (etag_matches(req, etag)) {
+        s_status_304++;
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    static char json[STATUS_JSON_MAX];
+    text_t t = { .buf = json, .cap = sizeof(json) };
+    write_status_json(&t, &s_status);
+    if (t.overflow) {
+        ESP_LOGE(TAG, "status JSON over %d bytes", STATUS_JSON_MAX);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_OK;
+    }
+    s_status_200++;
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, (ssize_t)t.len);
+}
+
+// An unsigned query parameter; false if present but not a number
+static bool query_u32(const char *query, const char *key, uint32_t *out)
+{
+    char value[16];
+    if (!query || httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return true;                // absent: keep the default
+    }
+    char *end;
+    unsigned long v = strtoul(value, &end, 10);
+    if (end == value || *end || v > UINT32_MAX) {
+        return false;
+    }
+    *out = (uint32_t)v;
+    return true;
+}
+
+// Sends a chunk whenever the next row might not fit
+static esp_err_t history_flush(httpd_req_t *req, text_t *t, bool force)
+{
+    esp_err_t err = ESP_OK;
+    if (t->len > 0 && (force || t->cap - t->len < 160)) {
+        err = httpd_resp_send_chunk(req, t->buf, (ssize_t)t->len);
+        t->len = 0;
+    }
+    return err;
+}
+
+// Raw samples from the long-horizon store (history.h) with from <= time <= to
+// (epoch seconds; defaults: all of it), oldest first, HISTORY_PAGE at a time.
+// "next" is the from of the following page, or null after the last.
+static esp_err_t history_get(httpd_req_t *req)
+{
+    if (!authorized(req)) {
+        return ESP_OK;
+    }
+    static char query[64];
+    bool has_query = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK;
+    uint32_t from = 0;
+    uint32_t to = UINT32_MAX;
+    if (!query_u32(has_query ? query : NULL, "from", &from) ||
+        !query_u32(has_query ? query : NULL, "to", &to) || from > to) {
+        s_history_400++;
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "from and to are epoch seconds, from <= to");
+        return ESP_OK;
+    }
+
+    static history_sample_t page[HISTORY_PAGE];
+    bool more;
+    size_t n = history_query(from, to, page, HISTORY_PAGE, &more);
+
+    s_history_200++;
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    static char buf[HISTORY_CHUNK];
+    text_t t = { .buf = buf, .cap = sizeof(buf) };
+    text_printf(&t, "{\"columns\":[\"time\",\"session\",\"weekly_all\",\"weekly_sonnet\","
+                    "\"burn_cost_per_hour\",\"session_cost_usd\"],\"samples\":[");
+    esp_err_t err = ESP_OK;
+    for (size_t i = 0; i < n && err == ESP_OK; i++) {
+        const history_sample_t *s = &page[i];
+        text_printf(&t, "%s[%" PRIu32 ",", i ? "," : "", s->time);
+        text_float(&t, s->session);
+        text_printf(&t, ",");
+        text_float(&t, s->weekly_all);
+        text_printf(&t, ",");
+        text_float(&t, s->weekly_sonnet);
+        text_printf(&t, ",");
+        text_float(&t, s->burn_cost_per_hour);
+        text_printf(&t, ",");
+        text_float(&t, s->session_cost_usd);
+        text_printf(&t, "]");
+        err = history_flush(req, &t, false);
+    }
+    // The next page starts the second after this one ends
+    if (more && n > 0) {
+        text_printf(&t, "],\"next\":%" PRIu32 "}", page[n - 1].time + 1);
+    } else {
+        text_printf(&t, "],\"next\":null}");
+    }
+    if (err == ESP_OK) {
+        err = history_flush(req, &t, true);
+    }
+    if (err == ESP_OK) {
+        err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return err;
+}
+
+// /metrics writer: lines collect in a small buffer that is sent as a chunk
+// whenever the next line won't fit
+typedef struct {
+    httpd_req_t *req;
+    char buf[METRICS_CHUNK];
+    size_t len;
+    esp_err_t err;
+} metrics_t;
+
+static void metrics_flush(metrics_t *m)
+{
+    if (m->len > 0 && m->err == ESP_OK) {
+        m->err = httpd_resp_send_chunk(m->req, m->buf, (ssize_t)m->len);
+    }
+    m->len = 0;
+}
+
+static void metric_line(metrics_t *m, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void metric_line(metrics_t *m, const char *fmt, ...)
+{
+    char line[192];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= sizeof(line) - 1) {
+        return;
+    }
+    line[n++] = '\n';
+    if (m->len + (size_t)n > sizeof(m->buf)) {
+        metrics_flush(m);
+    }
+    memcpy(m->buf + m->len, line, (size_t)n);
+    m->len += (size_t)n;
+}
+
+// HELP and TYPE for the samples that follow
+static void metric_head(metrics_t *m, const char *name, const char *type, const char *help)
+{
+    metric_line(m, "# HELP espclaude_%s %s", name, help);
+    metric_line(m, "# TYPE espclaude_%s %s", name, type);
+}
+
+static void write_metrics(metrics_t *m)
+{
+    metric_head(m, "uptime_seconds", "gauge", "Seconds since boot.");
+    metric_line(m, "espclaude_uptime_seconds %" PRId64, esp_timer_get_time() / 1000000);
+
+    // The published status
+    http_client_read_status(&s_status, &s_generation);
+    const status_data_t *s = &s_status;
+    metric_head(m, "status_generation", "counter", "Statuses published since boot.");
+    metric_line(m, "espclaude_status_generation %" PRIu32, s_generation);
+    metric_head(m, "status_valid", "gauge", "1 once there is a status to serve.");
+    metric_line(m, "espclaude_status_valid %d", s->valid ? 1 : 0);
+    metric_head(m, "status_cached", "gauge", "1 while the status is the one saved before the last reboot.");
+    metric_line(m, "espclaude_status_cached %d", http_client_status_is_cached() ? 1 : 0);
+    if (s->valid) {
+        metric_head(m, "status_age_seconds", "gauge", "Age of the numbers in the status.");
+        metric_line(m, "espclaude_status_age_seconds %" PRId64, http_client_status_age_s(s));
+
+        metric_head(m, "utilisation_percent", "gauge", "Usage of each limit tier.");
+        const struct { const char *tier; const usage_tier_t *t; } tiers[] = {
+            { "session", &s->session },
+            { "weekly_all", &s->weekly_all },
+            { "weekly_sonnet", &s->weekly_sonnet },
+            { "weekly_opus", &s->weekly_opus },
+        };
+        for (size_t i = 0; i < sizeof(tiers) / sizeof(tiers[0]); i++) {
+            if (tiers[i].t->present) {
+                metric_line(m, "espclaude_utilisation_percent{tier=\"%s\"} %.6g",
+                            tiers[i].tier, tiers[i].t->utilisation);
+            }
+        }
+        metric_head(m, "session_cost_usd", "gauge", "Cost of the current session.");
+        metric_line(m, "espclaude_session_cost_usd %.6g", s->session_cost_usd);
+        metric_head(m, "session_messages", "gauge", "Messages in the current session.");
+        metric_line(m, "espclaude_session_messages %d", s->session_message_count);
+        if (s->burn_rate_present) {
+            metric_head(m, "burn_cost_per_hour_usd", "gauge", "Current spend rate.");
+            metric_line(m, "espclaude_burn_cost_per_hour_usd %.6g", s->burn_cost_per_hour);
+            metric_head(m, "burn_tokens_per_minute", "gauge", "Current token rate.");
+            metric_line(m, "espclaude_burn_tokens_per_minute %.6g", s->burn_tokens_per_min);
+        }
+    }
+
+    // Each CCU instance
+    size_t count = http_client_endpoint_count();
+    char labels[MAX_ENDPOINTS][48];
+    uint32_t last_success[MAX_ENDPOINTS];
+    bool up[MAX_ENDPOINTS];
+    static http_endpoint_t ep;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t generation = 0;
+        http_client_read_endpoint(i, &ep, &generation);
+        text_t t = { .buf = labels[i], .cap = sizeof(labels[i]) };
+        text_string(&t, ep.name);
+        last_success[i] = ep.last_success;
+        up[i] = ep.last_success && !ep.failing;
+    }
+    metric_head(m, "server_up", "gauge", "1 if the server's last poll succeeded.");
+    for (size_t i = 0; i < count; i++) {
+        metric_line(m, "espclaude_server_up{server=%s} %d", labels[i], up[i] ? 1 : 0);
+    }
+    metric_head(m, "server_last_success_timestamp_seconds", "gauge",
+                "When the server last answered (0 = never).");
+    for (size_t i = 0; i < count; i++) {
+        metric_line(m, "espclaude_server_last_success_timestamp_seconds{server=%s} %" PRIu32,
+                    labels[i], last_success[i]);
+    }
+
+    // Upstream requests, all servers together
+    http_conn_stats_t conn;
+    http_client_get_conn_stats(&conn);
+    metric_head(m, "upstream_requests_total", "counter", "Requests to CCU (polls and streams).");
+    metric_line(m, "espclaude_upstream_requests_total %" PRIu32, conn.requests);
+    metric_head(m, "upstream_failures_total", "counter", "Requests to CCU that failed or timed out.");
+    metric_line(m, "espclaude_upstream_failures_total %" PRIu32, conn.failures);
+    metric_head(m, "upstream_retries_total", "counter", "Stale kept-alive connections replaced.");
+    metric_line(m, "espclaude_upstream_retries_total %" PRIu32, conn.retries);
+    metric_head(m, "upstream_connects_total", "counter", "New connections to CCU.");
+    metric_line(m, "espclaude_upstream_connects_total %" PRIu32, conn.connects);
+    metric_head(m, "upstream_reused_total", "counter", "Requests on a kept-alive connection.");
+    metric_line(m, "espclaude_upstream_reused_total %" PRIu32, conn.reused);
+    metric_head(m, "upstream_dns_lookups_total", "counter", "Server address resolutions.");
+    metric_line(m, "espclaude_upstream_dns_lookups_total %" PRIu32, conn.dns_lookups);
+    metric_head(m, "upstream_tls_handshakes_total", "counter", "TLS handshakes, full or resumed.");
+    metric_line(m, "espclaude_upstream_tls_handshakes_total{kind=\"full\"} %" PRIu32, conn.tls_full);
+    metric_line(m, "espclaude_upstream_tls_handshakes_total{kind=\"resumed\"} %" PRIu32, conn.tls_resumed);
+    metric_head(m, "upstream_request_duration_seconds", "summary",
+                "Latency of successful requests to CCU (streams until their headers).");
+    metric_line(m, "espclaude_upstream_request_duration_seconds_sum %.3f", conn.total_ms / 1000.0);
+    metric_line(m, "espclaude_upstream_request_duration_seconds_count %" PRIu32, conn.completed);
+    metric_head(m, "upstream_last_request_duration_seconds", "gauge",
+                "Latency of the last successful request (the slowest server's).");
+    metric_line(m, "espclaude_upstream_last_request_duration_seconds %.3f", conn.last_ms / 1000.0);
+
+    status_body_stats_t body;
+    http_client_get_body_stats(&body);
+    metric_head(m, "upstream_body_bytes_total", "counter", "Status body bytes, as received and decoded.");
+    metric_line(m, "espclaude_upstream_body_bytes_total{stage=\"wire\"} %" PRIu64, (uint64_t)body.bytes.wire_bytes);
+    metric_line(m, "espclaude_upstream_body_bytes_total{stage=\"decoded\"} %" PRIu64, (uint64_t)body.bytes.decoded_bytes);
+    metric_head(m, "upstream_body_errors_total", "counter", "Status bodies cut short, and values clipped to fit.");
+    metric_line(m, "espclaude_upstream_body_errors_total{kind=\"truncated\"} %" PRIu32, body.truncated);
+    metric_line(m, "espclaude_upstream_body_errors_total{kind=\"clipped\"} %" PRIu32, body.clipped);
+    metric_head(m, "streaming", "gauge", "1 while statuses are pushed over the event stream.");
+    metric_line(m, "espclaude_streaming %d", http_client_is_streaming() ? 1 : 0);
+
+    history_store_stats_t history;
+    history_get_store_stats(&history);
+    metric_head(m, "history_samples", "gauge", "Samples in the long-horizon history store.");
+    metric_line(m, "espclaude_history_samples %" PRIu32, history.samples);
+    metric_head(m, "history_bytes", "gauge", "Bytes the long-horizon history store uses.");
+    metric_line(m, "espclaude_history_bytes %" PRIu32, history.bytes);
+
+    http_refresh_t refresh;
+    http_client_get_refresh(&refresh);
+    metric_head(m, "refreshes_total", "counter", "On-demand refreshes finished.");
+    metric_line(m, "espclaude_refreshes_total %" PRIu32, refresh.completed);
+
+    // This server
+    metric_head(m, "served_total", "counter", "Requests answered here, by path and code.");
+    metric_line(m, "espclaude_served_total{path=\"status\",code=\"200\"} %" PRIu32, s_status_200);
+    metric_line(m, "espclaude_served_total{path=\"status\",code=\"304\"} %" PRIu32, s_status_304);
+    metric_line(m, "espclaude_served_total{path=\"status\",code=\"503\"} %" PRIu32, s_status_503);
+    metric_line(m, "espclaude_served_total{path=\"metrics\",code=\"200\"} %" PRIu32, s_metrics_200);
+    metric_line(m, "espclaude_served_total{path=\"history\",code=\"200\"} %" PRIu32, s_history_200);
+    metric_line(m, "espclaude_served_total{path=\"history\",code=\"400\"} %" PRIu32, s_history_400);
+    metric_line(m, "espclaude_served_total{path=\"any\",code=\"401\"} %" PRIu32, s_unauthorized);
+
+    // The device
+    metric_head(m, "heap_free_bytes", "gauge", "Free heap.");
+    metric_line(m, "espclaude_heap_free_bytes %" PRIu32, esp_get_free_heap_size());
+    metric_head(m, "heap_min_free_bytes", "gauge", "Lowest free heap since boot.");
+    metric_line(m, "espclaude_heap_min_free_bytes %" PRIu32, esp_get_minimum_free_heap_size());
+    metric_head(m, "heap_largest_free_block_bytes", "gauge", "Largest internal allocation possible.");
+    metric_line(m, "espclaude_heap_largest_free_block_bytes %zu",
+                heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    metric_head(m, "psram_free_bytes", "gauge", "Free PSRAM.");
+    metric_line(m, "espclaude_psram_free_bytes %zu", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    metric_head(m, "tasks", "gauge", "FreeRTOS tasks.");
+    metric_line(m, "espclaude_tasks %u", (unsigned)uxTaskGetNumberOfTasks());
+    metric_head(m, "task_stack_free_bytes", "gauge", "Least stack a task has had left.");
+    TaskHandle_t engine = http_engine_task();
+    if (engine) {
+        metric_line(m, "espclaude_task_stack_free_bytes{task=\"http_engine\"} %u",
+                    (unsigned)uxTaskGetStackHighWaterMark(engine));
+    }
+    metric_line(m, "espclaude_task_stack_free_bytes{task=\"httpd\"} %u",
+                (unsigned)uxTaskGetStackHighWaterMark(NULL));
+    metric_head(m, "wifi_connected", "gauge", "1 while WiFi has an IP address.");
+    metric_line(m, "espclaude_wifi_connected %d", wifi_is_connected() ? 1 : 0);
+    metric_head(m, "wifi_rssi_dbm", "gauge", "WiFi signal strength.");
+    metric_line(m, "espclaude_wifi_rssi_dbm %d", wifi_get_rssi());
+}
+
+static esp_err_t metrics_get(httpd_req_t *req)
+{
+    if (!authorized(req)) {
+        return ESP_OK;
+    }
+    s_metrics_200++;
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+    static metrics_t m;
+    m.req = req;
+    m.len = 0;
+    m.err = ESP_OK;
+    write_metrics(&m);
+    metrics_flush(&m);
+    if (m.err == ESP_OK) {
+        m.err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return m.err;
+}
+
+esp_err_t status_server_start(void)
+{
+    if (STATUS_SERVER_PORT == 0) {
+        return ESP_OK;
+    }
+    s_boot_id = esp_random();
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = STATUS_SERVER_PORT;
+    config.stack_size = 6144;
+    // Below the HTTP engine: polling CCU comes first
+    config.task_priority = 4;
+    config.lru_purge_enable = true;
+    esp_err_t err = httpd_start(&s_server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "start on port %d: %s", STATUS_SERVER_PORT, esp_err_to_name(err));
+        return err;
+    }
+
+    const httpd_uri_t status_uri = { .uri = API_STATUS_PATH, .method = HTTP_GET, .handler = status_get };
+    const httpd_uri_t metrics_uri = { .uri = "/metrics", .method = HTTP_GET, .handler = metrics_get };
+    const httpd_uri_t history_uri = { .uri = HISTORY_PATH, .method = HTTP_GET, .handler = history_get };
+    httpd_register_uri_handler(s_server, &status_uri);
+    httpd_register_uri_handler(s_server, &metrics_uri);
+    httpd_register_uri_handler(s_server, &history_uri);
+    ESP_LOGI(TAG, "serving %s, %s and /metrics on port %d%s", API_STATUS_PATH, HISTORY_PATH,
+             STATUS_SERVER_PORT,
+             STATUS_SERVER_TOKEN[0] ? " (token required)" : "");
+    return ESP_OK;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "esp_err.h"
+
+// LAN read-through cache of the CCU status, so other consumers (a second
+// display, Grafana) read this device instead of each polling CCU.
+//
+// With STATUS_SERVER_PORT set (see config.h.example), an HTTP server answers:
+//
+//   GET API_STATUS_PATH  the published status (http_client.h) as a CCU
+//                        /api/status document, with countdowns and
+//                        data_age_seconds brought up to date; a weak ETag
+//                        per status generation, so If-None-Match polls get
+//                        304 until a new status arrives. 503 before the first.
+//   GET /api/history     raw samples from the long-horizon history store
+//                        (history.h), ?from=&to= in epoch seconds, oldest
+//                        first and at most 128 per answer; "next" is the
+//                        from of the following page (null after the last).
+//   GET /metrics         Prometheus text: upstream poll latency and errors,
+//                        status age and usage, heap, tasks and WiFi.
+//
+// Every answer comes from what the HTTP engine task already published and
+// recorded: however many clients there are, CCU sees no extra requests. With
+// STATUS_SERVER_TOKEN set, every path wants "Authorization: Bearer <token>"
+// (which is what another espclaude sends with API_TOKEN).
+
+// Start the server; does nothing when STATUS_SERVER_PORT is 0 (the default).
+esp_err_t status_server_start(void);
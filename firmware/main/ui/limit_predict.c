@@ -0,0 +1,156 @@
+#include "limit_predict.h"
+#include "esp_timer.h"
+#include <math.h>
+#include <string.h>
+
+// How fast old samples fade: the session tier follows the last half hour or
+// so, the weekly tiers the last several hours
+#define SESSION_TAU_S 1800.0
+#define WEEKLY_TAU_S  21600.0
+
+// A fit needs this many samples over at least this long before it says anything
+#define FIT_MIN_SAMPLES 3
+#define FIT_MIN_SPAN_S  120.0
+
+// Slower than this (1% a week) counts as flat
+#define FIT_MIN_SLOPE (1.0 / (7.0 * 86400.0))
+
+typedef enum {
+    FIT_SESSION,
+    FIT_WEEKLY_ALL,
+    FIT_WEEKLY_SONNET,
+    FIT_WEEKLY_OPUS,
+    FIT_TIERS,
+} fit_tier_t;
+
+typedef struct {
+    double   w, t, u, tt, tu;   // decayed sums of 1, t, u, t*t, t*u
+    int64_t  origin_us;         // esp_timer time of t = 0 (the first sample)
+    double   last_t;            // newest sample, seconds since origin
+    float    last_u;
+    int64_t  resets_at_us;      // esp_timer time the tier resets (0 = unknown)
+    char     resets_at[32];
+    uint32_t n;                 // samples since the fit started
+} tier_fit_t;
+
+static tier_fit_t s_fits[FIT_TIERS];
+
+static const usage_tier_t *status_tier(const status_data_t *status, fit_tier_t t)
+{
+    switch (t) {
+    case FIT_SESSION:       return &status->session;
+    case FIT_WEEKLY_ALL:    return &status->weekly_all;
+    case FIT_WEEKLY_SONNET: return &status->weekly_sonnet;
+    case FIT_WEEKLY_OPUS:   return &status->weekly_opus;
+    default:                return NULL;
+    }
+}
+
+static void fit_add(tier_fit_t *f, const usage_tier_t *tier, int64_t at_us, double tau_s)
+{
+    if (!tier->present) {
+        f->n = 0;
+        return;
+    }
+    // A reset starts a new line
+    if (f->n > 0 && (tier->utilisation < f->last_u - 1.0f ||
+                     strcmp(tier->resets_at, f->resets_at) != 0)) {
+        f->n = 0;
+    }
+    if (f->n == 0) {
+        memset(f, 0, sizeof(*f));
+        f->origin_us = at_us;
+    }
+
+    double t = (double)(at_us - f->origin_us) / 1e6;
+    if (f->n > 0 && t - f->last_t < 1.0) {
+        // The same server data again
+        return;
+    }
+    double decay = f->n > 0 ? exp(-(t - f->last_t) / tau_s) : 1.0;
+    double u = tier->utilisation;
+    f->w  = f->w * decay + 1.0;
+    f->t  = f->t * decay + t;
+    f->u  = f->u * decay + u;
+    f->tt = f->tt * decay + t * t;
+    f->tu = f->tu * decay + t * u;
+    f->n++;
+
+    f->last_t = t;
+    f->last_u = tier->utilisation;
+    f->resets_at_us = tier->resets_in_seconds > 0 ? at_us + tier->resets_in_seconds * 1000000 : 0;
+    memcpy(f->resets_at, tier->resets_at, sizeof(f->resets_at));
+}
+
+// Seconds from now until the tier reaches 100%, -1 if it isn't heading there
+// (or the fit can't tell yet). *known says whether the fit could tell.
+static int64_t fit_time_to_limit(const tier_fit_t *f, int64_t now_us, bool *known)
+{
+    *known = false;
+    if (f->n < FIT_MIN_SAMPLES || f->last_t < FIT_MIN_SPAN_S) {
+        return -1;
+    }
+    double denom = f->w * f->tt - f->t * f->t;
+    if (denom <= 0.0) {
+        return -1;
+    }
+    *known = true;
+    if (f->last_u >= 100.0f) {
+        return 0;
+    }
+    double slope = (f->w * f->tu - f->t * f->u) / denom;   // percent per second
+    if (slope < FIT_MIN_SLOPE) {
+        return -1;
+    }
+    double since_s = (double)(now_us - f->origin_us) / 1e6 - f->last_t;
+    double secs = (100.0 - f->last_u) / slope - since_s;
+    return secs > 0.0 ? (int64_t)secs : 0;
+}
+
+// True if the tier reaches 100% before it resets; *secs until then
+static bool fit_will_hit(const tier_fit_t *f, int64_t now_us, bool *known, int64_t *secs)
+{
+    *secs = fit_time_to_limit(f, now_us, known);
+    if (*secs < 0) {
+        return false;
+    }
+    return f->resets_at_us == 0 || now_us + *secs * 1000000 < f->resets_at_us;
+}
+
+void limit_predict_add(const status_data_t *status)
+{
+    if (!status->valid) {
+        return;
+    }
+    int64_t at_us = esp_timer_get_time() - http_client_status_age_s(status) * 1000000;
+    for (int t = 0; t < FIT_TIERS; t++) {
+        fit_add(&s_fits[t], status_tier(status, t), at_us,
+                t == FIT_SESSION ? SESSION_TAU_S : WEEKLY_TAU_S);
+    }
+}
+
+bool limit_predict_get(limit_prediction_t *out)
+{
+    int64_t now_us = esp_timer_get_time();
+    bool any_known = false;
+    bool known;
+    int64_t secs;
+
+    memset(out, 0, sizeof(*out));
+    out->session_will_hit_limit = fit_will_hit(&s_fits[FIT_SESSION], now_us, &known, &secs);
+    any_known |= known;
+    if (out->session_will_hit_limit) {
+        out->session_limit_in_seconds = secs;
+    }
+
+    // Weekly is at risk if any weekly tier hits, soonest first
+    for (int t = FIT_WEEKLY_ALL; t < FIT_TIERS; t++) {
+        bool hit = fit_will_hit(&s_fits[t], now_us, &known, &secs);
+        any_known |= known;
+        if (hit && (!out->weekly_will_hit_limit || secs < out->weekly_limit_in_seconds)) {
+            out->weekly_will_hit_limit = true;
+            out->weekly_limit_in_seconds = secs;
+        }
+    }
+    return any_known;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "http_client.h"
+
+// On-device limit prediction, for when the server sends no prediction object
+// and to cross-check the one it does send.
+//
+// Each tier keeps a least-squares line through its recent utilisation
+// samples, older ones fading out exponentially, updated in O(1) per sample
+// from five running sums. Its slope gives the time to 100%, which is a hit
+// if it comes before the tier resets. A tier's fit starts over when it
+// resets (utilisation drops or resets_at moves).
+//
+// UI task only.
+
+// Same meaning as the status fields of the same names
+typedef struct {
+    bool    session_will_hit_limit;
+    int64_t session_limit_in_seconds;
+    bool    weekly_will_hit_limit;
+    int64_t weekly_limit_in_seconds;
+} limit_prediction_t;
+
+// Add the tiers of a newly published status as samples.
+void limit_predict_add(const status_data_t *status);
+
+// Prediction from the samples so far, as of now. False until some tier has
+// enough of them to go on.
+bool limit_predict_get(limit_prediction_t *out);
@@ -1,17 +1,28 @@
 #include "screen_dashboard.h"
+#include "status_binding.h"
+#include "usage_estimate.h"
+#include "limit_predict.h"
 #include "ui.h"
 #include "theme.h"
 #include "config.h"
+#include "esp_timer.h"
+#include "esp_log.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 
+static const char *TAG = "dashboard";
+
 // Per-tier UI widgets
 typedef struct {
     lv_obj_t *label_name;
     lv_obj_t *label_pct;
     lv_obj_t *label_countdown;
     lv_obj_t *bar;
+    bool      present;
+    float     utilisation;      // confirmed by the server
+    bool      estimated;        // showing an estimate (usage_estimate.h)
+    int64_t   shown_minutes;    // countdown currently displayed (-1 = none)
 } tier_widgets_t;
 
 static tier_widgets_t s_session;
@@ -19,6 +30,13 @@ static tier_widgets_t s_weekly_all;
 static tier_widgets_t s_weekly_sonnet;
 static lv_obj_t *s_prediction_label;
 static lv_obj_t *s_burn_label;
+static bool s_prediction_disagrees;     // local prediction differs from the server's
+
+// The server's last prediction, counted down locally from when it came like
+// the reset countdowns; without one the local prediction is redone each tick
+static bool               s_prediction_from_server;
+static limit_prediction_t s_server_prediction;
+static int64_t            s_server_prediction_base_s;
 
 // Model distribution widgets
 static lv_obj_t *s_dashboard_parent;
@@ -29,12 +47,24 @@ static lv_obj_t *s_legend_swatches[MAX_MODELS];
 static lv_obj_t *s_legend_labels[MAX_MODELS];
 static int s_legend_y_offset;
 
-// Cached countdowns: base values from server, decremented locally each second
+// Cached countdowns: base values from server, decremented locally each second.
+// Counted on the monotonic clock: the first status usually arrives before
+// SNTP has set the wall clock.
 static int64_t s_session_remaining = 0;
 static int64_t s_weekly_all_remaining = 0;
 static int64_t s_weekly_sonnet_remaining = 0;
-static time_t  s_last_fetch_time = 0;
-static char    s_last_resets_at[32] = "";
+static int64_t s_countdown_base_s = 0;     // esp_timer seconds the values hold at
+static bool    s_countdown_valid = false;
+
+// A cached status arrives before SNTP: its age is unknown until the wall
+// clock is set, and the base is moved back then
+static uint32_t s_countdown_received_at = 0;
+static bool    s_countdown_aged = false;
+
+static int64_t monotonic_s(void)
+{
+    return esp_timer_get_time() / 1000000;
+}
 
 static void create_tier_row(lv_obj_t *parent, tier_widgets_t *tw, const char *name, int y_offset)
 {
@@ -73,10 +103,42 @@ static void create_tier_row(lv_obj_t *parent, tier_widgets_t *tw, const char *na
     lv_obj_set_style_bg_color(tw->bar, THEME_GREEN, LV_PART_INDICATOR);
     lv_obj_set_style_bg_opa(tw->bar, LV_OPA_COVER, LV_PART_INDICATOR);
     lv_obj_set_style_radius(tw->bar, 4, LV_PART_INDICATOR);
+
+    tw->shown_minutes = -1;
+}
+
+// Estimates are marked with a "~", a dimmer percentage and a translucent bar
+static void show_utilisation(tier_widgets_t *tw, float utilisation, bool estimated)
+{
+    // Update percentage
+    char buf[16];
+    snprintf(buf, sizeof(buf), estimated ? "~%.0f%%" : "%.0f%%", utilisation);
+    label_set_text_if_changed(tw->label_pct, buf);
+    if (estimated != tw->estimated) {
+        tw->estimated = estimated;
+        lv_obj_set_style_text_color(tw->label_pct,
+                                    estimated ? THEME_TEXT_SECONDARY : THEME_TEXT_PRIMARY, 0);
+        lv_obj_set_style_bg_opa(tw->bar, estimated ? LV_OPA_60 : LV_OPA_COVER,
+                                LV_PART_INDICATOR);
+    }
+
+    // Update bar value and colour
+    int val = (int)utilisation;
+    if (val > 100) val = 100;
+    if (val < 0) val = 0;
+    bar_set_value_if_changed(tw->bar, val, true);
+
+    // Only update bar colour if it actually changed
+    lv_color_t new_colour = theme_usage_colour(utilisation);
+    lv_color_t cur_colour = lv_obj_get_style_bg_color(tw->bar, LV_PART_INDICATOR);
+    if (cur_colour.red != new_colour.red || cur_colour.green != new_colour.green || cur_colour.blue != new_colour.blue) {
+        lv_obj_set_style_bg_color(tw->bar, new_colour, LV_PART_INDICATOR);
+    }
 }
 
-static void update_tier(tier_widgets_t *tw, const usage_tier_t *tier, int64_t remaining)
+static void update_tier(tier_widgets_t *tw, const usage_tier_t *tier)
 {
+    tw->present = tier->present;
     if (!tier->present) {
         lv_obj_add_flag(tw->label_name, LV_OBJ_FLAG_HIDDEN);
         lv_obj_add_flag(tw->label_pct, LV_OBJ_FLAG_HIDDEN);
@@ -90,25 +152,38 @@ static void update_tier(tier_widgets_t *tw, const usage_tier_t *tier, int64_t re
     lv_obj_clear_flag(tw->label_countdown, LV_OBJ_FLAG_HIDDEN);
     lv_obj_clear_flag(tw->bar, LV_OBJ_FLAG_HIDDEN);
 
-    // Update percentage
-    char buf[16];
-    snprintf(buf, sizeof(buf), "%.0f%%", tier->utilisation);
-    label_set_text_if_changed(tw->label_pct, buf);
+    tw->utilisation = tier->utilisation;
+    show_utilisation(tw, tier->utilisation, false);
+}
 
-    // Update bar value and colour
-    int val = (int)tier->utilisation;
-    if (val > 100) val = 100;
-    if (val < 0) val = 0;
-    bar_set_value_if_changed(tw->bar, val, true);
+// Between polls, move the tier on to its estimate once that reads differently
+// from the confirmed value; a new status puts the confirmed one back
+static void tick_estimate(tier_widgets_t *tw, estimate_tier_t tier)
+{
+    if (!tw->present) {
+        return;
+    }
+    float estimate;
+    if (usage_estimate_tier(tier, &estimate) && (int)(estimate + 0.5f) != (int)(tw->utilisation + 0.5f)) {
+        show_utilisation(tw, estimate, true);
+    } else if (tw->estimated) {
+        show_utilisation(tw, tw->utilisation, false);
+    }
+}
 
-    // Only update bar colour if it actually changed
-    lv_color_t new_colour = theme_usage_colour(tier->utilisation);
-    lv_color_t cur_colour = lv_obj_get_style_bg_color(tw->bar, LV_PART_INDICATOR);
-    if (cur_colour.red != new_colour.red || cur_colour.green != new_colour.green || cur_colour.blue != new_colour.blue) {
-        lv_obj_set_style_bg_color(tw->bar, new_colour, LV_PART_INDICATOR);
+// Countdowns only show whole minutes, so most ticks stop at the comparison
+static void tick_countdown(tier_widgets_t *tw, int64_t remaining)
+{
+    if (!tw->present) {
+        return;
     }
+    int64_t minutes = remaining > 0 ? remaining / 60 : -2;
+    if (minutes == tw->shown_minutes) {
+        return;
+    }
+    tw->shown_minutes = minutes;
 
-    // Update countdown
+    char buf[16];
     if (remaining > 0) {
         int days = (int)(remaining / 86400);
         int hrs  = (int)((remaining % 86400) / 3600);
@@ -335,43 +410,55 @@ void screen_dashboard_init(lv_obj_t *parent)
 
 }
 
-void screen_dashboard_update(const status_data_t *status)
+static void update_session(const status_data_t *status)
 {
-    if (!status || !status->valid) {
-        return;
-    }
-
-    // Calculate locally decremented countdowns
-    time_t now = time(NULL);
-    int64_t elapsed = 0;
-    if (s_last_fetch_time > 0 && now > s_last_fetch_time) {
-        elapsed = now - s_last_fetch_time;
-    }
+    update_tier(&s_session, &status->session);
+}
 
-    // Detect new data from server by comparing the session resets_at string.
-    if (strcmp(status->session.resets_at, s_last_resets_at) != 0) {
-        strncpy(s_last_resets_at, status->session.resets_at, sizeof(s_last_resets_at) - 1);
-        s_session_remaining = status->session.resets_in_seconds;
-        s_weekly_all_remaining = status->weekly_all.resets_in_seconds;
-        s_weekly_sonnet_remaining = status->weekly_sonnet.resets_in_seconds;
-        s_last_fetch_time = now;
-        elapsed = 0;
-    }
+static void update_weekly_all(const status_data_t *status)
+{
+    update_tier(&s_weekly_all, &status->weekly_all);
+}
 
-    int64_t sess_rem = s_session_remaining - elapsed;
-    int64_t wa_rem = s_weekly_all_remaining - elapsed;
-    int64_t ws_rem = s_weekly_sonnet_remaining - elapsed;
-    if (sess_rem < 0) sess_rem = 0;
-    if (wa_rem < 0) wa_rem = 0;
-    if (ws_rem < 0) ws_rem = 0;
+static void update_weekly_sonnet(const status_data_t *status)
+{
+    update_tier(&s_weekly_sonnet, &status->weekly_sonnet);
+}
 
-    update_tier(&s_session,       &status->session,        sess_rem);
-    update_tier(&s_weekly_all,    &status->weekly_all,     wa_rem);
-    update_tier(&s_weekly_sonnet, &status->weekly_sonnet,  ws_rem);
+// Date the countdown base to when the status arrived, if the wall clock can
+// tell that yet. True once done (or when there is nothing to correct).
+static bool age_countdown_base(void)
+{
+    if (s_countdown_received_at < CLOCK_VALID_AFTER) {
+        // Arrived before SNTP in this boot: as old as its base already
+        return true;
+    }
+    time_t now = time(NULL);
+    if (now < CLOCK_VALID_AFTER) {
+        return false;
+    }
+    int64_t age = now > (time_t)s_countdown_received_at ? now - s_countdown_received_at : 0;
+    s_countdown_base_s = monotonic_s() - age;
+    return true;
+}
 
-    // Model distribution
-    update_model_dist(status);
+// New reset times from the server: restart the local countdowns from them.
+// A status that arrived a while ago (a cached one) has aged by then; the wall
+// clock says how much, once it is set (screen_dashboard_tick() catches up).
+static void update_countdown_base(const status_data_t *status)
+{
+    s_session_remaining = status->session.resets_in_seconds;
+    s_weekly_all_remaining = status->weekly_all.resets_in_seconds;
+    s_weekly_sonnet_remaining = status->weekly_sonnet.resets_in_seconds;
+
+    s_countdown_base_s = monotonic_s();
+    s_countdown_received_at = status->received_at;
+    s_countdown_aged = age_countdown_base();
+    s_countdown_valid = true;
+}
 
+static void update_burn(const status_data_t *status)
+{
     // Burn rate (left side of combined line)
     if (status->burn_rate_present) {
         char buf[48];
@@ -379,35 +466,93 @@ void screen_dashboard_update(const status_data_t *status)
                  status->burn_tokens_per_min, status->burn_cost_per_hour);
         label_set_text_if_changed(s_burn_label, buf);
     }
+}
 
-    // Prediction (right side of same line)
-    if (status->prediction_present) {
-        char buf[32];
-        if (status->session_will_hit_limit) {
-            int64_t secs = status->session_limit_in_seconds;
-            if (secs > 0) {
-                int hrs = (int)(secs / 3600);
-                int mins = (int)((secs % 3600) / 60);
-                if (hrs > 0) {
-                    snprintf(buf, sizeof(buf), "Limit %dh %dm", hrs, mins);
-                } else {
-                    snprintf(buf, sizeof(buf), "Limit %dm", mins);
-                }
+// Prediction (right side of same line). Local ones are marked with a "~".
+static void show_prediction(bool session_will_hit, int64_t secs, bool weekly_will_hit, bool local)
+{
+    const char *mark = local ? "~" : "";
+    char buf[32];
+    lv_color_t colour;
+    if (session_will_hit) {
+        if (secs > 0) {
+            int hrs = (int)(secs / 3600);
+            int mins = (int)((secs % 3600) / 60);
+            if (hrs > 0) {
+                snprintf(buf, sizeof(buf), "%sLimit %dh %dm", mark, hrs, mins);
             } else {
-                snprintf(buf, sizeof(buf), "Limit hit!");
+                snprintf(buf, sizeof(buf), "%sLimit %dm", mark, mins);
             }
-            lv_obj_set_style_text_color(s_prediction_label, THEME_RED, 0);
-        } else if (status->weekly_will_hit_limit) {
-            snprintf(buf, sizeof(buf), "Weekly at risk");
-            lv_obj_set_style_text_color(s_prediction_label, THEME_ORANGE, 0);
         } else {
-            snprintf(buf, sizeof(buf), "Usage OK");
-            lv_obj_set_style_text_color(s_prediction_label, THEME_GREEN, 0);
+            snprintf(buf, sizeof(buf), "Limit hit!");
         }
-        label_set_text_if_changed(s_prediction_label, buf);
+        colour = THEME_RED;
+    } else if (weekly_will_hit) {
+        snprintf(buf, sizeof(buf), "%sWeekly at risk", mark);
+        colour = THEME_ORANGE;
+    } else {
+        snprintf(buf, sizeof(buf), "%sUsage OK", mark);
+        colour = THEME_GREEN;
     }
+    // Redone every second: the colour follows the text, so same text, no redraw
+    const char *current = lv_label_get_text(s_prediction_label);
+    if (current && strcmp(current, buf) == 0) {
+        return;
+    }
+    lv_obj_set_style_text_color(s_prediction_label, colour, 0);
+    lv_label_set_text(s_prediction_label, buf);
+}
 
+// The time to the limit as of now: the server's less what has passed since it
+// came, or the local fit's redone
+static void tick_prediction(void)
+{
+    if (s_prediction_from_server) {
+        int64_t secs = s_server_prediction.session_limit_in_seconds -
+                       (monotonic_s() - s_server_prediction_base_s);
+        show_prediction(s_server_prediction.session_will_hit_limit, secs > 0 ? secs : 0,
+                        s_server_prediction.weekly_will_hit_limit, false);
+        return;
+    }
+    limit_prediction_t local;
+    if (limit_predict_get(&local)) {
+        show_prediction(local.session_will_hit_limit, local.session_limit_in_seconds,
+                        local.weekly_will_hit_limit, true);
+    }
+}
 
+// The server's prediction when it sends one, checked against the local one;
+// otherwise the local one, once it has enough samples
+static void update_prediction(const status_data_t *status)
+{
+    limit_prediction_t local;
+    bool have_local = limit_predict_get(&local);
+
+    s_prediction_from_server = status->prediction_present;
+    if (status->prediction_present) {
+        s_server_prediction.session_will_hit_limit = status->session_will_hit_limit;
+        s_server_prediction.session_limit_in_seconds = status->session_limit_in_seconds;
+        s_server_prediction.weekly_will_hit_limit = status->weekly_will_hit_limit;
+        s_server_prediction_base_s = monotonic_s();
+        bool disagree = have_local &&
+                        (local.session_will_hit_limit != status->session_will_hit_limit ||
+                         local.weekly_will_hit_limit != status->weekly_will_hit_limit);
+        if (disagree != s_prediction_disagrees) {
+            s_prediction_disagrees = disagree;
+            if (disagree) {
+                ESP_LOGI(TAG, "local prediction differs: session %s, weekly %s (server: %s, %s)",
+                         local.session_will_hit_limit ? "hits" : "ok",
+                         local.weekly_will_hit_limit ? "at risk" : "ok",
+                         status->session_will_hit_limit ? "hits" : "ok",
+                         status->weekly_will_hit_limit ? "at risk" : "ok");
+            }
+        }
+    }
+    tick_prediction();
+}
+
+static void update_alert(const status_data_t *status)
+{
     // Alert background: red when any tier exceeds 80% utilisation
     bool alert = false;
     if (status->session.present && status->session.utilisation >= 80.0f)
@@ -425,3 +570,53 @@ void screen_dashboard_update(const status_data_t *status)
         lv_obj_set_style_bg_color(s_dashboard_parent, target_bg, 0);
     }
 }
+
+static const status_binding_t s_bindings[] = {
+    { STATUS_FIELD_SESSION,        update_session },
+    { STATUS_FIELD_WEEKLY_ALL,     update_weekly_all },
+    { STATUS_FIELD_WEEKLY_SONNET,  update_weekly_sonnet },
+    { STATUS_FIELD_RESETS,         update_countdown_base },
+    { STATUS_FIELD_MODELS,         update_model_dist },
+    { STATUS_FIELD_BURN,           update_burn },
+    { STATUS_FIELD_PREDICTION | STATUS_FIELD_TIERS, update_prediction },
+    { STATUS_FIELD_TIERS,          update_alert },
+};
+
+void screen_dashboard_update(const status_data_t *status, uint32_t changed)
+{
+    if (!status || !status->valid) {
+        return;
+    }
+    status_bindings_apply(s_bindings, sizeof(s_bindings) / sizeof(s_bindings[0]),
+                          status, changed);
+    screen_dashboard_tick();
+}
+
+void screen_dashboard_tick(void)
+{
+    tick_estimate(&s_session,       ESTIMATE_SESSION);
+    tick_estimate(&s_weekly_all,    ESTIMATE_WEEKLY_ALL);
+    tick_estimate(&s_weekly_sonnet, ESTIMATE_WEEKLY_SONNET);
+    tick_prediction();
+
+    if (!s_countdown_valid) {
+        return;
+    }
+    if (!s_countdown_aged) {
+        s_countdown_aged = age_countdown_base();
+    }
+
+    // Calculate locally decremented countdowns
+    int64_t elapsed = monotonic_s() - s_countdown_base_s;
+
+    int64_t sess_rem = s_session_remaining - elapsed;
+    int64_t wa_rem = s_weekly_all_remaining - elapsed;
+    int64_t ws_rem = s_weekly_sonnet_remaining - elapsed;
+    if (sess_rem < 0) sess_rem = 0;
+    if (wa_rem < 0) wa_rem = 0;
+    if (ws_rem < 0) ws_rem = 0;
+
+    tick_countdown(&s_session,       sess_rem);
+    tick_countdown(&s_weekly_all,    wa_rem);
+    tick_countdown(&s_weekly_sonnet, ws_rem);
+}
@@ -6,5 +6,8 @@
 // Initialise the dashboard screen widgets inside the given parent tab.
 void screen_dashboard_init(lv_obj_t *parent);
 
-// Update the dashboard with new status data.
-void screen_dashboard_update(const status_data_t *status);
+// Update the dashboard widgets bound to the changed STATUS_FIELD_* bits.
+void screen_dashboard_update(const status_data_t *status, uint32_t changed);
+
+// Advance the reset countdowns. Cheap; call every second.
+void screen_dashboard_tick(void);
@@ -1,10 +1,13 @@
 #include "screen_instances.h"
+#include "status_binding.h"
+#include "usage_estimate.h"
 #include "ui.h"
 #include "theme.h"
 #include <stdio.h>
 
 // Session details screen (repurposed from instance list)
-// Shows: cost, messages, model distribution, remaining time
+// Shows: cost, messages, model distribution, remaining time, and with several
+// servers (SERVER_URLS) one line per server
 
 static lv_obj_t *s_cost_label;
 static lv_obj_t *s_messages_label;
@@ -13,6 +16,15 @@ static lv_obj_t *s_models_label;
 static lv_obj_t *s_plan_label;
 static lv_obj_t *s_no_data_label;
 
+// Per-server breakdown, only created with more than one server
+static lv_obj_t *s_server_rows[MAX_ENDPOINTS];
+static http_endpoint_t s_servers[MAX_ENDPOINTS];
+static uint32_t s_server_generations[MAX_ENDPOINTS];
+static bool s_server_answering[MAX_ENDPOINTS];  // row shown undimmed
+
+static float s_cost_usd;            // confirmed session cost
+static bool  s_cost_estimated;      // s_cost_label shows an estimate
+
 static lv_obj_t *create_row(lv_obj_t *parent, const char *heading, int y)
 {
     lv_obj_t *hdr = lv_label_create(parent);
@@ -49,25 +61,56 @@ void screen_instances_init(lv_obj_t *parent)
     // Allow model label to wrap (long text)
     lv_obj_set_width(s_models_label, 180);
     lv_label_set_long_mode(s_models_label, LV_LABEL_LONG_WRAP);
-}
 
-void screen_instances_update(const status_data_t *status)
-{
-    if (!status || !status->valid) {
-        return;
+    size_t servers = http_client_endpoint_count();
+    if (servers > 1) {
+        lv_obj_t *hdr = lv_label_create(parent);
+        lv_label_set_text(hdr, "Servers:");
+        lv_obj_set_style_text_color(hdr, THEME_TEXT_SECONDARY, 0);
+        lv_obj_set_style_text_font(hdr, &lv_font_montserrat_14, 0);
+        lv_obj_set_pos(hdr, 8, 130);
+
+        for (size_t i = 0; i < servers; i++) {
+            s_server_rows[i] = lv_label_create(parent);
+            lv_label_set_text(s_server_rows[i], "");
+            lv_obj_set_style_text_color(s_server_rows[i], THEME_TEXT_DIM, 0);
+            lv_obj_set_style_text_font(s_server_rows[i], &lv_font_montserrat_14, 0);
+            lv_obj_set_width(s_server_rows[i], 296);
+            lv_label_set_long_mode(s_server_rows[i], LV_LABEL_LONG_CLIP);
+            lv_obj_set_pos(s_server_rows[i], 8, 148 + 18 * (int)i);
+        }
     }
+}
 
+static void update_plan(const status_data_t *status)
+{
     lv_obj_add_flag(s_no_data_label, LV_OBJ_FLAG_HIDDEN);
 
-    // Plan
     if (status->plan[0]) {
         label_set_text_if_changed(s_plan_label, status->plan);
     }
+}
 
+// Estimates are marked with a "~" and a dimmer colour
+static void show_cost(float usd, bool estimated)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), estimated ? "~$%.2f" : "$%.2f", usd);
+    label_set_text_if_changed(s_cost_label, buf);
+    if (estimated != s_cost_estimated) {
+        s_cost_estimated = estimated;
+        lv_obj_set_style_text_color(s_cost_label,
+                                    estimated ? THEME_TEXT_SECONDARY : THEME_TEXT_PRIMARY, 0);
+    }
+}
+
+static void update_session_info(const status_data_t *status)
+{
     // Session cost
+    s_cost_usd = status->session_cost_usd;
+    show_cost(s_cost_usd, false);
+
     char buf[64];
-    snprintf(buf, sizeof(buf), "$%.2f", status->session_cost_usd);
-    label_set_text_if_changed(s_cost_label, buf);
 
     // Messages
     snprintf(buf, sizeof(buf), "%d", status->session_message_count);
@@ -83,10 +126,12 @@ void screen_instances_update(const status_data_t *status)
         snprintf(buf, sizeof(buf), "Expired");
     }
     label_set_text_if_changed(s_remaining_label, buf);
+}
 
-    // Model distribution
+static void update_models(const status_data_t *status)
+{
     if (status->model_count > 0) {
-        char models_buf[128] = "";
+        char models_buf[192] = "";
         int offset = 0;
         for (int i = 0; i < status->model_count && i < MAX_MODELS; i++) {
             if (i > 0) {
@@ -98,3 +143,57 @@ void screen_instances_update(const status_data_t *status)
         label_set_text_if_changed(s_models_label, models_buf);
     }
 }
+
+static const status_binding_t s_bindings[] = {
+    { STATUS_FIELD_VALID | STATUS_FIELD_PLAN, update_plan },
+    { STATUS_FIELD_SESSION_INFO,              update_session_info },
+    { STATUS_FIELD_MODELS,                    update_models },
+};
+
+void screen_instances_update(const status_data_t *status, uint32_t changed)
+{
+    if (!status || !status->valid) {
+        return;
+    }
+    status_bindings_apply(s_bindings, sizeof(s_bindings) / sizeof(s_bindings[0]),
+                          status, changed);
+}
+
+// "host  42% / 63%  $12.34": session and weekly utilisation and session cost,
+// dimmed while the server isn't answering
+static void update_server_row(size_t i)
+{
+    http_endpoint_t *srv = &s_servers[i];
+    http_client_read_endpoint(i, srv, &s_server_generations[i]);
+
+    char buf[64];
+    if (srv->status.valid) {
+        snprintf(buf, sizeof(buf), "%.16s  %.0f%% / %.0f%%  $%.2f", srv->name,
+                 srv->status.session.utilisation, srv->status.weekly_all.utilisation,
+                 srv->status.session_cost_usd);
+    } else {
+        snprintf(buf, sizeof(buf), "%.16s  --", srv->name);
+    }
+    label_set_text_if_changed(s_server_rows[i], buf);
+
+    bool answering = srv->status.valid && !srv->failing;
+    if (answering != s_server_answering[i]) {
+        s_server_answering[i] = answering;
+        lv_obj_set_style_text_color(s_server_rows[i],
+                                    answering ? THEME_TEXT_PRIMARY : THEME_TEXT_DIM, 0);
+    }
+}
+
+void screen_instances_tick(void)
+{
+    for (size_t i = 0; i < MAX_ENDPOINTS && s_server_rows[i]; i++) {
+        update_server_row(i);
+    }
+
+    float usd;
+    if (usage_estimate_session_cost(&usd) && (int)(usd * 100.0f + 0.5f) != (int)(s_cost_usd * 100.0f + 0.5f)) {
+        show_cost(usd, true);
+    } else if (s_cost_estimated) {
+        show_cost(s_cost_usd, false);
+    }
+}
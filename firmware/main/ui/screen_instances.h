@@ -6,5 +6,9 @@
 // Initialise the instances screen widgets.
 void screen_instances_init(lv_obj_t *parent);
 
-// Update the instances list with new status data.
-void screen_instances_update(const status_data_t *status);
+// Update the widgets bound to the changed STATUS_FIELD_* bits.
+void screen_instances_update(const status_data_t *status, uint32_t changed);
+
+// Move the session cost on to its estimate between polls. Cheap; call every
+// second.
+void screen_instances_tick(void);
@@ -2,6 +2,9 @@
 #include "ui.h"
 #include "theme.h"
 #include "wifi.h"
+#include "http_client.h"
+#include "boot_timeline.h"
+#include "esp_timer.h"
 #include "config.h"
 #include <stdio.h>
 
@@ -12,6 +15,17 @@ static lv_obj_t *s_server_url;
 static lv_obj_t *s_poll_interval;
 static lv_obj_t *s_sleep_timeout;
 static lv_obj_t *s_sleep_remaining;
+static lv_obj_t *s_conn_stats;
+static lv_obj_t *s_tls_stats;
+static lv_obj_t *s_rx_stats;
+static lv_obj_t *s_body_stats;
+static lv_obj_t *s_boot_net;
+static lv_obj_t *s_boot_data;
+
+// Values start here and end at the screen edge; anything longer is cut with
+// "..." rather than running off it
+#define VALUE_X     120
+#define VALUE_WIDTH (LCD_WIDTH - VALUE_X - 12)
 
 static lv_obj_t *create_setting_row(lv_obj_t *parent, const char *label, int y)
 {
@@ -25,7 +39,9 @@ static lv_obj_t *create_setting_row(lv_obj_t *parent, const char *label, int y)
     lv_label_set_text(val, "--");
     lv_obj_set_style_text_color(val, THEME_TEXT_PRIMARY, 0);
     lv_obj_set_style_text_font(val, &lv_font_montserrat_14, 0);
-    lv_obj_set_pos(val, 120, y);
+    lv_obj_set_size(val, VALUE_WIDTH, 18);
+    lv_label_set_long_mode(val, LV_LABEL_LONG_DOT);
+    lv_obj_set_pos(val, VALUE_X, y);
 
     return val;
 }
@@ -42,13 +58,23 @@ void screen_settings_init(lv_obj_t *parent)
 
     s_sleep_timeout   = create_setting_row(parent, "Sleep:", 132);
     s_sleep_remaining = create_setting_row(parent, "Sleep in:", 156);
+    s_conn_stats      = create_setting_row(parent, "Conn:", 180);
+    s_tls_stats       = create_setting_row(parent, "TLS:", 204);
+    s_rx_stats        = create_setting_row(parent, "Rx:", 228);
+    s_body_stats      = create_setting_row(parent, "Body:", 252);
+    s_boot_net        = create_setting_row(parent, "Disp/WiFi/IP:", 276);
+    s_boot_data       = create_setting_row(parent, "Data/Draw/NTP:", 300);
 
     // Static values
-    lv_label_set_text(s_server_url, SERVER_URL);
-
     char buf[16];
-    snprintf(buf, sizeof(buf), "%ds", POLL_INTERVAL_MS / 1000);
-    lv_label_set_text(s_poll_interval, buf);
+
+    size_t servers = http_client_endpoint_count();
+    if (servers > 1) {
+        snprintf(buf, sizeof(buf), "%u servers", (unsigned)servers);
+        lv_label_set_text(s_server_url, buf);
+    } else {
+        lv_label_set_text(s_server_url, SERVER_URL);
+    }
 
     int sleep_hrs = SLEEP_AFTER_MS / 3600000;
     int sleep_mins = (SLEEP_AFTER_MS % 3600000) / 60000;
@@ -62,6 +88,25 @@ void screen_settings_init(lv_obj_t *parent)
     lv_label_set_text(s_sleep_timeout, buf);
 }
 
+// Seconds to a tenth, the phases in the order the row's label names them
+static void format_phases(char *buf, size_t len, const boot_phase_t *phases, size_t count)
+{
+    size_t off = 0;
+    buf[0] = '\0';
+    for (size_t i = 0; i < count && off < len; i++) {
+        uint32_t ms = boot_timeline_ms(phases[i]);
+        if (ms) {
+            off += snprintf(buf + off, len - off, "%s%u.%u", i ? "  " : "",
+                            (unsigned)(ms / 1000), (unsigned)(ms % 1000 / 100));
+        } else {
+            off += snprintf(buf + off, len - off, "%s-", i ? "  " : "");
+        }
+    }
+    if (off < len) {
+        snprintf(buf + off, len - off, " s");
+    }
+}
+
 void screen_settings_update(void)
 {
     static bool s_last_connected = false;
@@ -90,10 +135,75 @@ void screen_settings_update(void)
 
     s_last_connected = connected;
 
-    // Sleep countdown
-    if (ui_is_sleeping()) {
+    // Connection reuse: requests on a kept-alive socket vs new connections
+    http_conn_stats_t conn;
+    http_client_get_conn_stats(&conn);
+    char conn_buf[40];
+    snprintf(conn_buf, sizeof(conn_buf), "%u reused / %u new",
+             (unsigned)conn.reused, (unsigned)conn.connects);
+    label_set_text_if_changed(s_conn_stats, conn_buf);
+
+    // Received status bytes vs decoded size (differs with compression)
+    status_body_stats_t body;
+    http_client_get_body_stats(&body);
+    if (body.bytes.decoded_bytes > 0) {
+        snprintf(conn_buf, sizeof(conn_buf), "%u%% of %u KB",
+                 (unsigned)((uint64_t)body.bytes.wire_bytes * 100 / body.bytes.decoded_bytes),
+                 (unsigned)(body.bytes.decoded_bytes / 1024));
+        label_set_text_if_changed(s_rx_stats, conn_buf);
+
+        // Largest status document, and any that arrived cut short or didn't fit
+        snprintf(conn_buf, sizeof(conn_buf), "%u B max, %u cut, %u clip",
+                 (unsigned)body.bytes.peak_decoded, (unsigned)body.truncated,
+                 (unsigned)body.clipped);
+        label_set_text_if_changed(s_body_stats, conn_buf);
+    }
+
+    if (http_client_is_streaming()) {
+        label_set_text_if_changed(s_poll_interval, "push (event stream)");
+    } else {
+        // Scheduler state and a countdown to the next request
+        poll_scheduler_t sched;
+        http_client_get_poll_schedule(&sched);
+        int64_t until_us = sched.next_at_us - esp_timer_get_time();
+        unsigned until_s = until_us > 0 ? (unsigned)((until_us + 999999) / 1000000) : 0;
+        if (sched.cadence_ms) {
+            // Aligned to the server's own refreshes
+            snprintf(conn_buf, sizeof(conn_buf), "%s, %us (srv %us)",
+                     poll_scheduler_state_name(sched.state), until_s,
+                     (unsigned)(sched.cadence_ms + 500) / 1000);
+        } else {
+            snprintf(conn_buf, sizeof(conn_buf), "%s, next in %us",
+                     poll_scheduler_state_name(sched.state), until_s);
+        }
+        label_set_text_if_changed(s_poll_interval, conn_buf);
+    }
+
+    // TLS handshakes: resumed ones skip the expensive key exchange
+    if (conn.tls_full + conn.tls_resumed > 0) {
+        snprintf(conn_buf, sizeof(conn_buf), "%u resumed / %u full",
+                 (unsigned)conn.tls_resumed, (unsigned)conn.tls_full);
+        label_set_text_if_changed(s_tls_stats, conn_buf);
+    }
+
+    // Boot timeline, seconds since power-on ("-" for phases not reached yet)
+    static const boot_phase_t net_phases[] = {BOOT_DISPLAY_UP, BOOT_WIFI_ASSOCIATED, BOOT_IP_ACQUIRED};
+    static const boot_phase_t data_phases[] = {BOOT_FIRST_RESPONSE, BOOT_FIRST_PAINT, BOOT_TIME_SYNCED};
+    format_phases(conn_buf, sizeof(conn_buf), net_phases, 3);
+    label_set_text_if_changed(s_boot_net, conn_buf);
+    format_phases(conn_buf, sizeof(conn_buf), data_phases, 3);
+    label_set_text_if_changed(s_boot_data, conn_buf);
+
+    // Sleep countdown (colour only changes with the sleep state)
+    static int s_last_sleeping = -1;
+    bool sleeping = ui_is_sleeping();
+    if (sleeping != s_last_sleeping) {
+        lv_obj_set_style_text_color(s_sleep_remaining,
+                                    sleeping ? THEME_TEXT_DIM : THEME_TEXT_PRIMARY, 0);
+        s_last_sleeping = sleeping;
+    }
+    if (sleeping) {
         label_set_text_if_changed(s_sleep_remaining, "Sleeping");
-        lv_obj_set_style_text_color(s_sleep_remaining, THEME_TEXT_DIM, 0);
     } else {
         uint32_t remain_ms = ui_sleep_remaining_ms();
         uint32_t remain_s = remain_ms / 1000;
@@ -106,6 +216,5 @@ void screen_settings_update(void)
             snprintf(buf, sizeof(buf), "%dm", mins);
         }
         label_set_text_if_changed(s_sleep_remaining, buf);
-        lv_obj_set_style_text_color(s_sleep_remaining, THEME_TEXT_PRIMARY, 0);
     }
 }
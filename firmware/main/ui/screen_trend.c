@@ -0,0 +1,167 @@
+#include "screen_trend.h"
+#include "ui.h"
+#include "theme.h"
+#include "history.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Utilisation trend: session and weekly usage at one of three zoom levels
+// (tap the chart to cycle), one chart point per rollup bucket. Each redraw
+// reads only the buckets drawn, so the week view costs the same as the
+// 5 hour one however many polls it spans.
+
+#define TREND_POINTS    296     // chart width in px, and the most points a zoom draws
+#define READ_CHUNK      8
+
+typedef struct {
+    history_res_t res;
+    uint16_t      points;
+    const char   *span;
+} trend_zoom_t;
+
+static const trend_zoom_t s_zooms[] = {
+    {HISTORY_RES_MINUTE, TREND_POINTS, "last 5h"},
+    {HISTORY_RES_HOUR,   7 * 24,       "last 7d"},
+    {HISTORY_RES_DAY,    90,           "last 90d"},
+};
+#define ZOOM_COUNT (sizeof(s_zooms) / sizeof(s_zooms[0]))
+
+static lv_obj_t *s_chart;
+static lv_chart_series_t *s_ser_session;
+static lv_chart_series_t *s_ser_weekly;
+static lv_obj_t *s_session_label;
+static lv_obj_t *s_weekly_label;
+static lv_obj_t *s_span_label;
+
+// Point values, oldest first; the chart draws straight from these arrays.
+// The last point is the bucket still being filled.
+static int32_t s_session_pts[TREND_POINTS];
+static int32_t s_weekly_pts[TREND_POINTS];
+
+static size_t s_zoom;
+static uint32_t s_drawn_generation;     // rollup generation last drawn
+static uint32_t s_drawn_bucket;         // time / period of the last point drawn (0 = redraw)
+
+static lv_obj_t *create_legend(lv_obj_t *parent, lv_color_t colour, int x)
+{
+    lv_obj_t *lbl = lv_label_create(parent);
+    lv_label_set_text(lbl, "");
+    lv_obj_set_style_text_color(lbl, colour, 0);
+    lv_obj_set_style_text_font(lbl, &lv_font_montserrat_14, 0);
+    lv_obj_set_pos(lbl, x, 4);
+    return lbl;
+}
+
+static void apply_zoom(void)
+{
+    const trend_zoom_t *z = &s_zooms[s_zoom];
+    lv_chart_set_point_count(s_chart, z->points);
+    lv_label_set_text(s_span_label, z->span);
+    s_drawn_bucket = 0;
+}
+
+static void chart_clicked_cb(lv_event_t *e)
+{
+    (void)e;
+    s_zoom = (s_zoom + 1) % ZOOM_COUNT;
+    apply_zoom();
+    screen_trend_update();
+}
+
+void screen_trend_init(lv_obj_t *parent)
+{
+    lv_obj_set_style_pad_all(parent, 0, 0);
+
+    s_session_label = create_legend(parent, THEME_ACCENT, 8);
+    s_weekly_label  = create_legend(parent, THEME_YELLOW, 130);
+
+    s_span_label = lv_label_create(parent);
+    lv_obj_set_style_text_color(s_span_label, THEME_TEXT_SECONDARY, 0);
+    lv_obj_set_style_text_font(s_span_label, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_align(s_span_label, LV_TEXT_ALIGN_RIGHT, 0);
+    lv_obj_set_width(s_span_label, 80);
+    lv_obj_set_pos(s_span_label, 224, 4);
+
+    for (int i = 0; i < TREND_POINTS; i++) {
+        s_session_pts[i] = LV_CHART_POINT_NONE;
+        s_weekly_pts[i] = LV_CHART_POINT_NONE;
+    }
+
+    s_chart = lv_chart_create(parent);
+    lv_obj_set_size(s_chart, TREND_POINTS + 8, 150);
+    lv_obj_set_pos(s_chart, 4, 26);
+    lv_chart_set_type(s_chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_range(s_chart, LV_CHART_AXIS_PRIMARY_Y, 0, 100);
+    lv_chart_set_div_line_count(s_chart, 5, 0);
+    lv_obj_set_style_bg_color(s_chart, THEME_PANEL_COLOUR, 0);
+    lv_obj_set_style_border_color(s_chart, THEME_BAR_BG, 0);
+    lv_obj_set_style_pad_all(s_chart, 4, 0);
+    // Lines only: no point markers at this density
+    lv_obj_set_style_size(s_chart, 0, 0, LV_PART_INDICATOR);
+    lv_obj_add_flag(s_chart, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(s_chart, chart_clicked_cb, LV_EVENT_CLICKED, NULL);
+
+    s_ser_session = lv_chart_add_series(s_chart, THEME_ACCENT, LV_CHART_AXIS_PRIMARY_Y);
+    s_ser_weekly  = lv_chart_add_series(s_chart, THEME_YELLOW, LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_ext_y_array(s_chart, s_ser_session, s_session_pts);
+    lv_chart_set_ext_y_array(s_chart, s_ser_weekly, s_weekly_pts);
+
+    apply_zoom();
+}
+
+// Each point shows the highest utilisation seen in its bucket
+static int32_t chart_value(const history_bucket_t *b, const history_agg_t *agg)
+{
+    if (b->count == 0) return LV_CHART_POINT_NONE;
+    if (agg->max < 0.0f) return 0;
+    if (agg->max > 100.0f) return 100;
+    return (int32_t)(agg->max + 0.5f);
+}
+
+static void redraw(uint32_t newest_bucket)
+{
+    const trend_zoom_t *z = &s_zooms[s_zoom];
+    uint32_t period = history_rollup_period(z->res);
+    uint32_t from = (newest_bucket - (z->points - 1)) * period;
+
+    history_bucket_t chunk[READ_CHUNK];
+    history_bucket_t latest = {0};
+    for (size_t i = 0; i < z->points; i += READ_CHUNK) {
+        size_t n = z->points - i < READ_CHUNK ? z->points - i : READ_CHUNK;
+        history_read_rollup(z->res, from + i * period, chunk, n);
+        for (size_t j = 0; j < n; j++) {
+            s_session_pts[i + j] = chart_value(&chunk[j], &chunk[j].session);
+            s_weekly_pts[i + j] = chart_value(&chunk[j], &chunk[j].weekly_all);
+            if (chunk[j].count) {
+                latest = chunk[j];
+            }
+        }
+    }
+
+    if (latest.count) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), "Session %.0f%%", latest.session.last);
+        label_set_text_if_changed(s_session_label, buf);
+        snprintf(buf, sizeof(buf), "Weekly %.0f%%", latest.weekly_all.last);
+        label_set_text_if_changed(s_weekly_label, buf);
+    }
+    lv_chart_refresh(s_chart);
+}
+
+void screen_trend_update(void)
+{
+    // Redraw when a status was folded in or the window moved on a bucket
+    uint32_t generation = history_rollup_generation();
+    time_t now = time(NULL);
+    if (generation == 0 || now <= 0) {
+        return;
+    }
+    uint32_t bucket = (uint32_t)now / history_rollup_period(s_zooms[s_zoom].res);
+    if (generation == s_drawn_generation && bucket == s_drawn_bucket) {
+        return;
+    }
+    redraw(bucket);
+    s_drawn_generation = generation;
+    s_drawn_bucket = bucket;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "lvgl.h"
+
+// Initialise the trend chart screen inside the given parent tab.
+void screen_trend_init(lv_obj_t *parent);
+
+// Redraw the chart from the rollups if a status was recorded or the window
+// moved. Cheap otherwise; call every second.
+void screen_trend_update(void);
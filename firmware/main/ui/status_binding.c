@@ -0,0 +1,95 @@
+#include "status_binding.h"
+
+#include <string.h>
+
+static bool tier_changed(const usage_tier_t *a, const usage_tier_t *b)
+{
+    return a->present != b->present || a->utilisation != b->utilisation;
+}
+
+// resets_in_seconds moves on every poll; only a new reset time re-bases the
+// locally ticking countdowns
+static bool resets_changed(const status_data_t *a, const status_data_t *b)
+{
+    return strcmp(a->session.resets_at, b->session.resets_at) != 0 ||
+           strcmp(a->weekly_all.resets_at, b->weekly_all.resets_at) != 0 ||
+           strcmp(a->weekly_sonnet.resets_at, b->weekly_sonnet.resets_at) != 0 ||
+           strcmp(a->weekly_opus.resets_at, b->weekly_opus.resets_at) != 0;
+}
+
+static bool models_changed(const status_data_t *a, const status_data_t *b)
+{
+    if (a->model_count != b->model_count) {
+        return true;
+    }
+    for (int i = 0; i < a->model_count && i < MAX_MODELS; i++) {
+        if (a->models[i].cost_pct != b->models[i].cost_pct ||
+            strcmp(a->models[i].model, b->models[i].model) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t status_diff(const status_data_t *prev, const status_data_t *next)
+{
+    if (prev->valid != next->valid) {
+        return STATUS_FIELD_ALL;
+    }
+
+    uint32_t changed = 0;
+    if (tier_changed(&prev->session, &next->session)) {
+        changed |= STATUS_FIELD_SESSION;
+    }
+    if (tier_changed(&prev->weekly_all, &next->weekly_all)) {
+        changed |= STATUS_FIELD_WEEKLY_ALL;
+    }
+    if (tier_changed(&prev->weekly_sonnet, &next->weekly_sonnet)) {
+        changed |= STATUS_FIELD_WEEKLY_SONNET;
+    }
+    if (tier_changed(&prev->weekly_opus, &next->weekly_opus)) {
+        changed |= STATUS_FIELD_WEEKLY_OPUS;
+    }
+    if (resets_changed(prev, next)) {
+        changed |= STATUS_FIELD_RESETS;
+    }
+    if (prev->session_cost_usd != next->session_cost_usd ||
+        prev->session_message_count != next->session_message_count ||
+        prev->session_remaining_seconds != next->session_remaining_seconds ||
+        prev->session_remaining_pct != next->session_remaining_pct) {
+        changed |= STATUS_FIELD_SESSION_INFO;
+    }
+    if (models_changed(prev, next)) {
+        changed |= STATUS_FIELD_MODELS;
+    }
+    if (prev->burn_rate_present != next->burn_rate_present ||
+        prev->burn_tokens_per_min != next->burn_tokens_per_min ||
+        prev->burn_cost_per_hour != next->burn_cost_per_hour) {
+        changed |= STATUS_FIELD_BURN;
+    }
+    if (prev->prediction_present != next->prediction_present ||
+        prev->session_will_hit_limit != next->session_will_hit_limit ||
+        prev->session_limit_in_seconds != next->session_limit_in_seconds ||
+        prev->weekly_will_hit_limit != next->weekly_will_hit_limit ||
+        prev->weekly_limit_in_seconds != next->weekly_limit_in_seconds) {
+        changed |= STATUS_FIELD_PREDICTION;
+    }
+    if (strcmp(prev->plan, next->plan) != 0) {
+        changed |= STATUS_FIELD_PLAN;
+    }
+    if (strcmp(prev->server_time, next->server_time) != 0 ||
+        prev->data_age_seconds != next->data_age_seconds) {
+        changed |= STATUS_FIELD_META;
+    }
+    return changed;
+}
+
+void status_bindings_apply(const status_binding_t *bindings, size_t count,
+                           const status_data_t *status, uint32_t changed)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (bindings[i].fields & changed) {
+            bindings[i].update(status);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "http_client.h"
+
+// Field-level change detection between two status snapshots, and a tiny
+// binding table that routes each change to the widgets that show it.
+//
+// A screen declares which status fields each of its update functions reads;
+// status_bindings_apply() then calls only those whose fields changed, so a
+// poll that returns the same numbers touches no widget at all.
+
+// Status fields, as groups the UI renders together
+#define STATUS_FIELD_VALID          (1u << 0)   // valid flag (first data)
+#define STATUS_FIELD_SESSION        (1u << 1)   // session tier: present, utilisation
+#define STATUS_FIELD_WEEKLY_ALL     (1u << 2)
+#define STATUS_FIELD_WEEKLY_SONNET  (1u << 3)
+#define STATUS_FIELD_WEEKLY_OPUS    (1u << 4)
+#define STATUS_FIELD_RESETS         (1u << 5)   // any tier's resets_at (countdown base)
+#define STATUS_FIELD_SESSION_INFO   (1u << 6)   // cost, messages, remaining time
+#define STATUS_FIELD_MODELS         (1u << 7)
+#define STATUS_FIELD_BURN           (1u << 8)
+#define STATUS_FIELD_PREDICTION     (1u << 9)
+#define STATUS_FIELD_PLAN           (1u << 10)
+#define STATUS_FIELD_META           (1u << 11)  // server_time, data_age_seconds
+#define STATUS_FIELD_ALL            0xffffffffu
+
+#define STATUS_FIELD_TIERS (STATUS_FIELD_SESSION | STATUS_FIELD_WEEKLY_ALL | \
+                            STATUS_FIELD_WEEKLY_SONNET | STATUS_FIELD_WEEKLY_OPUS)
+
+// Returns the STATUS_FIELD_* bits that differ between prev and next.
+// Everything counts as changed when the valid flag flips.
+uint32_t status_diff(const status_data_t *prev, const status_data_t *next);
+
+typedef struct {
+    uint32_t fields;                              // STATUS_FIELD_* this update reads
+    void (*update)(const status_data_t *status);
+} status_binding_t;
+
+// Call each binding whose fields intersect changed, in table order.
+void status_bindings_apply(const status_binding_t *bindings, size_t count,
+                           const status_data_t *status, uint32_t changed);
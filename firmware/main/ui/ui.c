@@ -3,7 +3,12 @@
 #include "screen_dashboard.h"
 #include "screen_instances.h"
 #include "screen_settings.h"
+#include "screen_trend.h"
+#include "status_binding.h"
+#include "usage_estimate.h"
+#include "limit_predict.h"
 #include "http_client.h"
+#include "boot_timeline.h"
 #include "config.h"
 #include "bsp/esp-bsp.h"
 #include "esp_log.h"
@@ -11,12 +16,24 @@
 
 static const char *TAG = "ui";
 
+// How long the banner shows a refresh's round trip
+#define REFRESH_RESULT_MS 3000
+
 static lv_obj_t *s_tabview = NULL;
 static lv_obj_t *s_status_banner = NULL;
 static lv_obj_t *s_status_banner_label = NULL;
 static uint32_t s_last_activity_tick = 0;
 static bool s_sleeping = false;
 
+// UI's own copy of the status, refreshed only when a new generation is out.
+// s_incoming receives it so it can be diffed against what is on screen.
+static status_data_t s_status;
+static status_data_t s_incoming;
+static uint32_t s_status_generation;
+
+static uint32_t s_refresh_seen;         // refreshes whose result has been shown
+static uint32_t s_refresh_shown_tick;
+
 static void enter_sleep(void)
 {
     if (s_sleeping) return;
@@ -42,6 +59,47 @@ static void screen_touch_cb(lv_event_t *e)
     ui_notify_activity();
 }
 
+static bool show_refresh_banner(void);
+
+// Long-press on the Dashboard: fetch now instead of at the next poll.
+// Presses while one is running just wait for it.
+static void dashboard_long_press_cb(lv_event_t *e)
+{
+    (void)e;
+    if (!http_client_refresh()) {
+        ESP_LOGD(TAG, "refresh already running");
+    }
+    show_refresh_banner();
+}
+
+// A refresh in progress, then its round trip for a few seconds, in the
+// status banner. False when there is none to show.
+static bool show_refresh_banner(void)
+{
+    http_refresh_t refresh;
+    http_client_get_refresh(&refresh);
+    if (!refresh.in_progress && refresh.completed != s_refresh_seen) {
+        s_refresh_seen = refresh.completed;
+        s_refresh_shown_tick = lv_tick_get();
+    }
+
+    char buf[48];
+    if (refresh.in_progress) {
+        snprintf(buf, sizeof(buf), "Refreshing...");
+    } else if (refresh.completed > 0 && lv_tick_elaps(s_refresh_shown_tick) < REFRESH_RESULT_MS) {
+        snprintf(buf, sizeof(buf), refresh.ok ? "Refreshed in %u ms" : "Refresh failed after %u ms",
+                 (unsigned)refresh.rtt_ms);
+    } else {
+        return false;
+    }
+    lv_obj_set_style_bg_color(s_status_banner, THEME_PANEL_COLOUR, 0);
+    lv_obj_set_style_text_color(s_status_banner_label,
+                                refresh.in_progress || refresh.ok ? THEME_ACCENT : THEME_YELLOW, 0);
+    label_set_text_if_changed(s_status_banner_label, buf);
+    lv_obj_clear_flag(s_status_banner, LV_OBJ_FLAG_HIDDEN);
+    return true;
+}
+
 void ui_init(void)
 {
     theme_init();
@@ -70,6 +128,7 @@ void ui_init(void)
     // Create tabs
     lv_obj_t *tab_dash = lv_tabview_add_tab(s_tabview, "Dashboard");
     lv_obj_t *tab_inst = lv_tabview_add_tab(s_tabview, "Sessions");
+    lv_obj_t *tab_trend = lv_tabview_add_tab(s_tabview, "Trend");
     lv_obj_t *tab_sett = lv_tabview_add_tab(s_tabview, "Settings");
 
     // Style tab buttons: themed text and indicator
@@ -87,12 +146,15 @@ void ui_init(void)
     // Set tab content backgrounds
     lv_obj_set_style_bg_color(tab_dash, THEME_BG_COLOUR, 0);
     lv_obj_set_style_bg_color(tab_inst, THEME_BG_COLOUR, 0);
+    lv_obj_set_style_bg_color(tab_trend, THEME_BG_COLOUR, 0);
     lv_obj_set_style_bg_color(tab_sett, THEME_BG_COLOUR, 0);
 
     // Initialise screen contents
     screen_dashboard_init(tab_dash);
     screen_instances_init(tab_inst);
+    screen_trend_init(tab_trend);
     screen_settings_init(tab_sett);
+    lv_obj_add_event_cb(tab_dash, dashboard_long_press_cb, LV_EVENT_LONG_PRESSED, NULL);
 
     // Status banner (info on startup, warning when data goes stale)
     s_status_banner = lv_obj_create(scr);
@@ -115,6 +177,10 @@ void ui_init(void)
     // Sleep timer: register touch handler on the active screen
     s_last_activity_tick = lv_tick_get();
     lv_obj_add_event_cb(scr, screen_touch_cb, LV_EVENT_PRESSED, NULL);
+
+    // Paint whatever is already published (the cached status after a
+    // reboot) in the first frame rather than a second later
+    ui_update();
 }
 
 void ui_update(void)
@@ -130,14 +196,52 @@ void ui_update(void)
         return;
     }
 
-    const status_data_t *status = http_client_get_status();
-    screen_dashboard_update(status);
-    screen_instances_update(status);
+    // Widgets are only touched for the fields that changed; in between, the
+    // dashboard countdowns and the between-poll estimates are the only
+    // per-second work
+    if (http_client_read_status(&s_incoming, &s_status_generation)) {
+        uint32_t changed = status_diff(&s_status, &s_incoming);
+        s_status = s_incoming;
+        usage_estimate_confirm(&s_status);
+        limit_predict_add(&s_status);
+        if (changed) {
+            screen_dashboard_update(&s_status, changed);
+            screen_instances_update(&s_status, changed);
+        }
+        if (!http_client_status_is_cached()) {
+            boot_timeline_mark(BOOT_FIRST_PAINT);
+        }
+    }
+    screen_dashboard_tick();
+    screen_instances_tick();
+    screen_trend_update();
     screen_settings_update();
 
-    // Status banner: info while fetching, warning when stale, hidden otherwise
+    // Status banner: refresh progress, info while fetching, warning when
+    // stale, hidden otherwise
+    if (show_refresh_banner()) {
+        return;
+    }
     time_t last = http_client_last_success_time();
-    if (last == 0) {
+    if (last == 0 && http_client_status_is_cached()) {
+        // Numbers from before the reboot -- say so until fresh ones arrive
+        char buf[48];
+        time_t now = time(NULL);
+        if (s_status.received_at && now > (time_t)s_status.received_at) {
+            int mins = (int)((now - s_status.received_at) / 60);
+            if (mins >= 120) {
+                snprintf(buf, sizeof(buf), "Cached data, %dh old - updating...", mins / 60);
+            } else {
+                snprintf(buf, sizeof(buf), "Cached data, %dm old - updating...", mins);
+            }
+        } else {
+            snprintf(buf, sizeof(buf), "Cached data - updating...");
+        }
+        lv_obj_set_style_bg_color(s_status_banner, THEME_PANEL_COLOUR, 0);
+        lv_obj_set_style_text_color(s_status_banner_label, THEME_YELLOW, 0);
+        label_set_text_if_changed(s_status_banner_label, buf);
+        lv_obj_clear_flag(s_status_banner, LV_OBJ_FLAG_HIDDEN);
+    } else if (last == 0) {
         // Never received data -- show info-style banner
         lv_obj_set_style_bg_color(s_status_banner, THEME_PANEL_COLOUR, 0);
         lv_obj_set_style_text_color(s_status_banner_label, THEME_ACCENT, 0);
@@ -23,6 +23,7 @@ static inline void bar_set_value_if_changed(lv_obj_t *bar, int32_t value, bool a
 typedef enum {
     SCREEN_DASHBOARD = 0,
     SCREEN_INSTANCES,
+    SCREEN_TREND,
     SCREEN_SETTINGS,
     SCREEN_COUNT
 } screen_id_t;
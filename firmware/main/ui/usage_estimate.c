@@ -0,0 +1,117 @@
+#include "usage_estimate.h"
+#include "config.h"
+#include "esp_timer.h"
+
+#ifndef ESTIMATE_HORIZON_S
+#define ESTIMATE_HORIZON_S 300
+#endif
+
+// Session spend between two statuses needed to learn from them; less than
+// this and rounding in the server's numbers swamps the ratio
+#define LEARN_MIN_USD 0.05f
+
+typedef struct {
+    bool  present;
+    float utilisation;          // confirmed
+    float learn_utilisation;    // at the last learning point
+    float pct_per_usd;          // learned; 0 = unknown
+} tier_estimate_t;
+
+static tier_estimate_t s_tiers[ESTIMATE_TIERS];
+static float   s_cost_usd;              // confirmed session cost
+static float   s_learn_cost_usd;        // session cost at the last learning point
+static float   s_burn_usd_per_s;
+static int64_t s_base_us;               // esp_timer time the confirmed values hold at
+static bool    s_valid;
+
+static const usage_tier_t *status_tier(const status_data_t *status, estimate_tier_t t)
+{
+    switch (t) {
+    case ESTIMATE_SESSION:       return &status->session;
+    case ESTIMATE_WEEKLY_ALL:    return &status->weekly_all;
+    case ESTIMATE_WEEKLY_SONNET: return &status->weekly_sonnet;
+    default:                     return NULL;
+    }
+}
+
+// Fold the change since the last learning point into each tier's ratio once
+// enough has been spent. A session reset (cost going down) or a tier reset
+// starts over from here.
+static void learn(const status_data_t *status)
+{
+    float spent = status->session_cost_usd - s_learn_cost_usd;
+    bool restart = !s_valid || spent < 0.0f;
+    if (!restart && spent < LEARN_MIN_USD) {
+        return;
+    }
+
+    for (int t = 0; t < ESTIMATE_TIERS; t++) {
+        tier_estimate_t *te = &s_tiers[t];
+        const usage_tier_t *tier = status_tier(status, t);
+        float moved = tier->utilisation - te->learn_utilisation;
+        if (!restart && tier->present && te->present && moved >= 0.0f) {
+            float ratio = moved / spent;
+            te->pct_per_usd = te->pct_per_usd > 0.0f
+                                  ? (te->pct_per_usd * 3.0f + ratio) / 4.0f
+                                  : ratio;
+        }
+        te->learn_utilisation = tier->utilisation;
+    }
+    s_learn_cost_usd = status->session_cost_usd;
+}
+
+void usage_estimate_confirm(const status_data_t *status)
+{
+    if (!status->valid) {
+        s_valid = false;
+        return;
+    }
+    learn(status);
+
+    for (int t = 0; t < ESTIMATE_TIERS; t++) {
+        const usage_tier_t *tier = status_tier(status, t);
+        s_tiers[t].present = tier->present;
+        s_tiers[t].utilisation = tier->utilisation;
+    }
+    s_cost_usd = status->session_cost_usd;
+    s_burn_usd_per_s = status->burn_rate_present ? status->burn_cost_per_hour / 3600.0f : 0.0f;
+    s_base_us = esp_timer_get_time() - http_client_status_age_s(status) * 1000000;
+    s_valid = true;
+}
+
+// Seconds of spend to extrapolate over, 0 when there is nothing to estimate
+static float elapsed_s(void)
+{
+    if (!s_valid || s_burn_usd_per_s <= 0.0f) {
+        return 0.0f;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - s_base_us;
+    if (elapsed_us <= 0) {
+        return 0.0f;
+    }
+    if (elapsed_us > (int64_t)ESTIMATE_HORIZON_S * 1000000) {
+        elapsed_us = (int64_t)ESTIMATE_HORIZON_S * 1000000;
+    }
+    return (float)elapsed_us / 1e6f;
+}
+
+bool usage_estimate_tier(estimate_tier_t tier, float *utilisation)
+{
+    const tier_estimate_t *te = &s_tiers[tier];
+    float elapsed = elapsed_s();
+    if (elapsed <= 0.0f || !te->present || te->pct_per_usd <= 0.0f) {
+        return false;
+    }
+    *utilisation = te->utilisation + te->pct_per_usd * s_burn_usd_per_s * elapsed;
+    return true;
+}
+
+bool usage_estimate_session_cost(float *usd)
+{
+    float elapsed = elapsed_s();
+    if (elapsed <= 0.0f) {
+        return false;
+    }
+    *usd = s_cost_usd + s_burn_usd_per_s * elapsed;
+    return true;
+}
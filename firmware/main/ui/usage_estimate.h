@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdbool.h>
+#include "http_client.h"
+
+// Between polls, extrapolates tier utilisation and the session cost forward
+// from the last confirmed status at its burn rate, so the dashboard keeps
+// moving while the next response is on its way.
+//
+// The burn rate is in dollars, the tiers in percent, so each tier learns how
+// many percent a dollar of session spend is worth from the changes between
+// confirmed statuses. A tier estimates nothing until it has seen one such
+// change, and nothing moves while the burn rate is zero. Estimates run at
+// most ESTIMATE_HORIZON_S past the data they start from.
+//
+// UI task only.
+
+typedef enum {
+    ESTIMATE_SESSION,
+    ESTIMATE_WEEKLY_ALL,
+    ESTIMATE_WEEKLY_SONNET,
+    ESTIMATE_TIERS,
+} estimate_tier_t;
+
+// Take a newly published status as the confirmed values to start from.
+void usage_estimate_confirm(const status_data_t *status);
+
+// Estimated utilisation of the tier now. False when there is no estimate
+// (the confirmed value stands).
+bool usage_estimate_tier(estimate_tier_t tier, float *utilisation);
+
+// Estimated session cost now, false when there is no estimate.
+bool usage_estimate_session_cost(float *usd);
@@ -1,33 +1,31 @@
 #include "wifi.h"
 #include "config.h"
 
+#include <stdatomic.h>
 #include <string.h>
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "boot_timeline.h"
+#include "http_client.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/event_groups.h"
+#include "freertos/task.h"
 
 static const char *TAG = "wifi";
 
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT      BIT1
-
-// Timeout for initial connection attempt (seconds)
-#define WIFI_CONNECT_TIMEOUT_S 15
-
-static EventGroupHandle_t s_wifi_event_group;
 static char s_ip_str[16] = "";
-static bool s_connected = false;
+static atomic_bool s_connected;
 
 static void event_handler(void *arg, esp_event_base_t event_base,
                           int32_t event_id, void *event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
         esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        boot_timeline_mark(BOOT_WIFI_ASSOCIATED);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        s_connected = false;
+        atomic_store(&s_connected, false);
         s_ip_str[0] = '\0';
         ESP_LOGW(TAG, "disconnected, reconnecting...");
         // Always reconnect -- no retry limit. The WiFi driver rate-limits
@@ -38,15 +36,15 @@ static void event_handler(void *arg, esp_event_base_t event_base,
         ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
         snprintf(s_ip_str, sizeof(s_ip_str), IPSTR, IP2STR(&event->ip_info.ip));
         ESP_LOGI(TAG, "connected, ip=%s", s_ip_str);
-        s_connected = true;
-        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        atomic_store(&s_connected, true);
+        boot_timeline_mark(BOOT_IP_ACQUIRED);
+        // The first request goes out now, not on a timer that checks back
+        http_client_network_up();
     }
 }
 
 esp_err_t wifi_init_sta(void)
 {
-    s_wifi_event_group = xEventGroupCreate();
-
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     esp_netif_create_default_wifi_sta();
@@ -76,25 +74,12 @@ esp_err_t wifi_init_sta(void)
     ESP_ERROR_CHECK(esp_wifi_start());
 
     ESP_LOGI(TAG, "connecting to %s...", WIFI_SSID);
-
-    // Wait up to WIFI_CONNECT_TIMEOUT_S for initial connection.
-    // If it times out, WiFi keeps retrying in the background via the event handler.
-    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
-        WIFI_CONNECTED_BIT, pdFALSE, pdFALSE,
-        pdMS_TO_TICKS(WIFI_CONNECT_TIMEOUT_S * 1000));
-
-    if (bits & WIFI_CONNECTED_BIT) {
-        return ESP_OK;
-    }
-
-    ESP_LOGW(TAG, "initial connection timed out after %ds, will keep retrying in background",
-             WIFI_CONNECT_TIMEOUT_S);
-    return ESP_ERR_TIMEOUT;
+    return ESP_OK;
 }
 
 bool wifi_is_connected(void)
 {
-    return s_connected;
+    return atomic_load(&s_connected);
 }
 
 const char *wifi_get_ip(void)
@@ -104,7 +89,7 @@ const char *wifi_get_ip(void)
 
 int8_t wifi_get_rssi(void)
 {
-    if (!s_connected) {
+    if (!atomic_load(&s_connected)) {
         return 0;
     }
     wifi_ap_record_t ap_info;
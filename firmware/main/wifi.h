@@ -4,8 +4,9 @@
 #include <stdint.h>
 #include "esp_err.h"
 
-// Initialise WiFi in STA mode and connect to the configured AP.
-// Blocks until connected or max retries exceeded.
+// Initialise WiFi in STA mode and start connecting to the configured AP.
+// Returns straight away; the connection comes up (and is kept up) in the
+// background.
 esp_err_t wifi_init_sta(void);
 
 // Returns true if WiFi is connected.